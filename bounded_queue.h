@@ -0,0 +1,164 @@
+#ifndef __BOUNDED_QUEUE_H__
+#define __BOUNDED_QUEUE_H__
+
+#include "power_of_two.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+/**
+ * @brief Fixed capacity lock-free queue for many producers and consumers.
+ *
+ * @details Each cell carries a sequence number that tells producers and
+ *          consumers whether it's free for the current lap of the ring. A push
+ *          or pop is a single compare-and-swap on the shared position plus a
+ *          release store on the cell, so the DDS receive threads never wait on
+ *          a lock to hand off a sample.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+
+    /**
+     * @brief Constructor for the bounded queue.
+     * @param[in] capacity The requested capacity, rounded up to a power of
+     *            two of at least 2.
+     */
+    explicit BoundedQueue(const size_t capacity) :
+                          m_capacity(roundUpPowerOfTwo(capacity, 2)),
+                          m_mask(m_capacity - 1),
+                          m_cells(new Cell[m_capacity]),
+                          m_pushPosition(0),
+                          m_popPosition(0)
+    {
+        for (size_t i = 0; i < m_capacity; i++)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Add an item to the back of the queue.
+     * @param[in] item The item to add. Only moved from on success.
+     * @return False if the queue is full.
+     */
+    bool push(T& item)
+    {
+        size_t position = m_pushPosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = m_cells[position & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0)
+            {
+                if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.item = std::move(item);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove the item at the front of the queue.
+     * @param[out] item The removed item.
+     * @return False if the queue is empty.
+     */
+    bool pop(T& item)
+    {
+        size_t position = m_popPosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = m_cells[position & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (diff == 0)
+            {
+                if (m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    item = std::move(cell.item);
+                    cell.item = T();
+                    cell.sequence.store(position + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_popPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Get the approximate number of queued items.
+     * @return The item count at some recent point in time.
+     */
+    size_t size() const
+    {
+        const size_t pushed = m_pushPosition.load(std::memory_order_relaxed);
+        const size_t popped = m_popPosition.load(std::memory_order_relaxed);
+        return pushed > popped ? pushed - popped : 0;
+    }
+
+    /**
+     * @brief Get the maximum number of queued items.
+     * @return The queue capacity.
+     */
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+
+    /// A slot in the ring.
+    struct Cell
+    {
+        /// The lap state of this cell.
+        std::atomic<size_t> sequence;
+
+        /// The queued item.
+        T item;
+    };
+
+    /// The number of cells in the ring.
+    const size_t m_capacity;
+
+    /// Maps a position onto a cell index.
+    const size_t m_mask;
+
+    /// The ring of cells.
+    std::unique_ptr<Cell[]> m_cells;
+
+    /// The next position to push to. Kept apart from the pop position.
+    alignas(64) std::atomic<size_t> m_pushPosition;
+
+    /// The next position to pop from.
+    alignas(64) std::atomic<size_t> m_popPosition;
+
+}; // End class BoundedQueue
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,100 @@
+#include "change_notifier.h"
+#include "config_reader.h"
+#include "topic_history.h"
+
+#include <algorithm>
+
+
+//------------------------------------------------------------------------------
+ChangeNotifier::ChangeNotifier(const int maxRate) :
+                               m_interval(1000 / std::max(maxRate, 1)),
+                               m_scheduled(false)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(flush()));
+    m_clock.start();
+}
+
+
+//------------------------------------------------------------------------------
+ChangeNotifier::~ChangeNotifier()
+{
+    m_timer.stop();
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ChangeNotifier> ChangeNotifier::createFromEnvironment()
+{
+    int maxRate = DEFAULT_RATE;
+
+    // The interval is in whole milliseconds, so 1 kHz is the most it can do
+    uint64_t rate = 0;
+    if (ConfigReader::readNumber("DDS_MONITOR_NOTIFY_RATE", rate) && rate > 0)
+    {
+        maxRate = static_cast<int>(std::min<uint64_t>(rate, 1000));
+    }
+
+    return std::make_shared<ChangeNotifier>(maxRate);
+}
+
+
+//------------------------------------------------------------------------------
+void ChangeNotifier::post(const std::shared_ptr<TopicHistory>& history)
+{
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_pending.push_back(history);
+        schedule = !m_scheduled;
+        m_scheduled = true;
+    }
+
+    // The timer belongs to the GUI thread, so start it from there
+    if (schedule)
+    {
+        QMetaObject::invokeMethod(this, "schedule", Qt::QueuedConnection);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void ChangeNotifier::schedule()
+{
+    // Report right away unless the last report was too recent
+    const qint64 wait = m_interval - m_clock.elapsed();
+    m_timer.start(static_cast<int>(std::max<qint64>(wait, 0)));
+}
+
+
+//------------------------------------------------------------------------------
+void ChangeNotifier::flush()
+{
+    std::vector<std::weak_ptr<TopicHistory>> pending;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        pending.swap(m_pending);
+        m_scheduled = false;
+    }
+
+    m_clock.restart();
+
+    for (const std::weak_ptr<TopicHistory>& entry : pending)
+    {
+        const std::shared_ptr<TopicHistory> history = entry.lock();
+        if (!history)
+        {
+            continue;
+        }
+
+        // Changes made from here on are posted again, so none are missed
+        history->acknowledge();
+        emit topicChanged(history->name());
+    }
+
+} // End ChangeNotifier::flush
+
+
+/**
+ * @}
+ */
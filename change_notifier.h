@@ -0,0 +1,107 @@
+#ifndef __CHANGE_NOTIFIER_H__
+#define __CHANGE_NOTIFIER_H__
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TopicHistory;
+
+
+/**
+ * @brief Tells the GUI which topic histories changed.
+ *
+ * @details A history posts itself on the first change after it was last
+ *          reported, so a busy topic posts at most once per notification.
+ *          The posts are collected and reported together on the GUI thread,
+ *          no more often than the maximum rate. Nothing runs while no topic
+ *          changes, so pages that wait for topicChanged() instead of polling
+ *          cost nothing for idle topics.
+ */
+class ChangeNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Constructor for the change notifier.
+     * @remarks Must be created on the GUI thread.
+     * @param[in] maxRate The maximum notification rate in Hz.
+     */
+    explicit ChangeNotifier(const int maxRate);
+
+    /**
+     * @brief Destructor for the change notifier.
+     */
+    ~ChangeNotifier();
+
+    /**
+     * @brief Create the change notifier from the environment settings.
+     * @details $DDS_MONITOR_NOTIFY_RATE sets the maximum rate in Hz.
+     * @return The new notifier.
+     */
+    static std::shared_ptr<ChangeNotifier> createFromEnvironment();
+
+    /**
+     * @brief Queue a changed history to be reported.
+     * @remarks Thread safe. Called by TopicHistory.
+     * @param[in] history The changed history.
+     */
+    void post(const std::shared_ptr<TopicHistory>& history);
+
+    /// The default maximum notification rate in Hz.
+    static const int DEFAULT_RATE = 60;
+
+signals:
+
+    /**
+     * @brief Report that the samples of a topic changed.
+     * @param[out] topicName The name of the topic.
+     */
+    void topicChanged(const QString& topicName);
+
+private slots:
+
+    /**
+     * @brief Start the timer for the next report.
+     */
+    void schedule();
+
+    /**
+     * @brief Report the changed histories.
+     */
+    void flush();
+
+private:
+
+    /// The minimum time between reports in ms.
+    const int m_interval;
+
+    /// Fires the next report.
+    QTimer m_timer;
+
+    /// Measures the time since the last report.
+    QElapsedTimer m_clock;
+
+    /// The histories that changed since the last report.
+    std::vector<std::weak_ptr<TopicHistory>> m_pending;
+
+    /// True while a report is scheduled.
+    bool m_scheduled;
+
+    /// Protects m_pending and m_scheduled.
+    std::mutex m_mutex;
+
+}; // End class ChangeNotifier
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,86 @@
+#include "config_reader.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+
+//------------------------------------------------------------------------------
+bool ConfigReader::readNumber(const char* name, uint64_t& value)
+{
+    const char* text = getenv(name);
+    if (!text || !*text)
+    {
+        return false;
+    }
+
+    // strtoull quietly wraps negative numbers around
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long number = strtoull(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0' || strchr(text, '-'))
+    {
+        reportInvalid(name, text);
+        return false;
+    }
+
+    value = number;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+bool ConfigReader::readDecimal(const char* name, double& value)
+{
+    const char* text = getenv(name);
+    if (!text || !*text)
+    {
+        return false;
+    }
+
+    char* end = nullptr;
+    errno = 0;
+    const double number = strtod(text, &end);
+    if (errno != 0 || end == text || *end != '\0' ||
+        !std::isfinite(number) || number < 0)
+    {
+        reportInvalid(name, text);
+        return false;
+    }
+
+    value = number;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+bool ConfigReader::readText(const char* name, std::string& value)
+{
+    const char* text = getenv(name);
+    if (!text || !*text)
+    {
+        return false;
+    }
+
+    value = text;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+void ConfigReader::reportInvalid(const char* name, const std::string& value)
+{
+    std::cerr << "Invalid '"
+              << name
+              << "' value '"
+              << value
+              << "'. Using the default."
+              << std::endl;
+}
+
+
+/**
+ * @}
+ */
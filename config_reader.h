@@ -0,0 +1,57 @@
+#ifndef __CONFIG_READER_H__
+#define __CONFIG_READER_H__
+
+#include <cstdint>
+#include <string>
+
+
+/**
+ * @brief Reads the DDS_MONITOR_* settings from the environment.
+ *
+ * @details Every setting is optional. A variable that isn't set, or is set
+ *          to an empty string, leaves the default alone. A malformed value
+ *          is reported on std::cerr and also leaves the default alone, so a
+ *          typo can't silently change a limit.
+ */
+class ConfigReader
+{
+public:
+
+    /**
+     * @brief Read a whole number.
+     * @param[in] name The name of the environment variable.
+     * @param[out] value Store the number here. Left alone if it's not set.
+     * @return True if the variable held a valid number; false otherwise.
+     */
+    static bool readNumber(const char* name, uint64_t& value);
+
+    /**
+     * @brief Read a decimal number that isn't negative.
+     * @param[in] name The name of the environment variable.
+     * @param[out] value Store the number here. Left alone if it's not set.
+     * @return True if the variable held a valid number; false otherwise.
+     */
+    static bool readDecimal(const char* name, double& value);
+
+    /**
+     * @brief Read a text value.
+     * @param[in] name The name of the environment variable.
+     * @param[out] value Store the text here. Left alone if it's not set.
+     * @return True if the variable was set and not empty; false otherwise.
+     */
+    static bool readText(const char* name, std::string& value);
+
+    /**
+     * @brief Report a value that was read but can't be used.
+     * @param[in] name The name of the environment variable.
+     * @param[in] value The rejected value.
+     */
+    static void reportInvalid(const char* name, const std::string& value);
+
+}; // End class ConfigReader
+
+#endif
+
+/**
+ * @}
+ */
@@ -2,15 +2,25 @@
 #include <dds/DCPS/Service_Participant.h>
 #include <tao/AnyTypeCode/Any.h>
 
+#include <QDateTime>
+
+#include "change_notifier.h"
 #include "dds_manager.h"
 #include "dds_data.h"
+#include "history_budget.h"
 #include "qos_dictionary.h"
 #include "open_dynamic_data.h"
+#include "sample_pipeline.h"
+#include "sample_pool.h"
+#include "spill_store.h"
 
 
 std::unique_ptr<DDSManager> CommonData::m_ddsManager;
-QMap<QString, QList<std::shared_ptr<OpenDynamicData> > > CommonData::m_samples;
-QMap<QString, QStringList> CommonData::m_sampleTimes;
+std::unique_ptr<SamplePipeline> CommonData::m_samplePipeline;
+std::shared_ptr<HistoryBudget> CommonData::m_historyBudget;
+std::shared_ptr<SpillWriter> CommonData::m_spillWriter;
+std::shared_ptr<ChangeNotifier> CommonData::m_changeNotifier;
+QMap<QString, std::shared_ptr<TopicHistory>> CommonData::m_histories;
 QMap<QString, std::shared_ptr<TopicInfo>> CommonData::m_topicInfo;
 QMutex CommonData::m_sampleMutex;
 QMutex CommonData::m_topicMutex;
@@ -27,15 +37,32 @@ void CommonData::cleanup()
     //    delete topicIter.value();
     //    topicIter.value() = nullptr;
     //}
+
+    // Stop the workers before the samples and pools they use go away
+    m_samplePipeline.reset();
+
     m_sampleMutex.lock();
-    m_samples.clear();
-    m_sampleTimes.clear();
+    for (const std::shared_ptr<TopicHistory>& history : m_histories)
+    {
+        history->setNotifier(nullptr);
+        history->clear();
+        history->setSamplePool(nullptr);
+        history->setSpillStore(nullptr);
+    }
+    m_histories.clear();
     m_sampleMutex.unlock();
 
+    // Pages may still hold a history, but the spill stores are gone, so the
+    // writer can remove the spill directory once its queue is drained
+    m_spillWriter.reset();
+    m_changeNotifier.reset();
+
     m_topicMutex.lock();
     m_topicInfo.clear();
     m_topicMutex.unlock();
 
+    SampleLayout::clearCache();
+
     // Deleting m_ddsManager causes the shared memory transport to crash when
     // closing the DDS service, so attempt leave the domain ourself.
     //delete CommonData::m_ddsManager;
@@ -104,254 +131,318 @@ bool CommonData::createPubSub(const QString& topicName, const QString& /*filter*
 } // End CommonData::createPubSub
 
 
+//------------------------------------------------------------------------------
+MemberPath CommonData::resolveMember(const QString& topicName,
+                                     const QString& memberName)
+{
+    const std::shared_ptr<TopicInfo> topicInfo = getTopicInfo(topicName);
+    if (!topicInfo || !topicInfo->typeCode)
+    {
+        return MemberPath();
+    }
+
+    return MemberPath(topicInfo->typeCode, memberName.toUtf8().data());
+}
+
+
+//------------------------------------------------------------------------------
+std::vector<MemberPath> CommonData::resolveMembers(const QString& topicName,
+                                                   const QStringList& memberNames)
+{
+    std::vector<MemberPath> memberPaths(memberNames.size());
+
+    const std::shared_ptr<TopicInfo> topicInfo = getTopicInfo(topicName);
+    if (!topicInfo || !topicInfo->typeCode)
+    {
+        return memberPaths;
+    }
+
+    for (int i = 0; i < memberNames.size(); i++)
+    {
+        memberPaths[i] = MemberPath(topicInfo->typeCode,
+                                    memberNames.at(i).toUtf8().data());
+    }
+
+    return memberPaths;
+}
+
+
 //------------------------------------------------------------------------------
 QVariant CommonData::readValue(const QString& topicName,
                                const QString& memberName,
                                const unsigned int& index)
 {
-    QVariant value;
-    m_sampleMutex.lock();
+    return readValue(topicName, resolveMember(topicName, memberName), index);
+}
 
 
-    // Make sure the index is valid
-    QList<std::shared_ptr<OpenDynamicData>>& sampleList = m_samples[topicName];
-    if ((int)index >= sampleList.count())
+//------------------------------------------------------------------------------
+QVariant CommonData::readValue(const QString& topicName,
+                               const MemberPath& memberPath,
+                               const unsigned int& index)
+{
+    if (!memberPath.isValid())
     {
-        value = "NULL";
-        m_sampleMutex.unlock();
-        return value;
+        return "NULL";
     }
 
-    const std::shared_ptr<OpenDynamicData> targetSample = sampleList.at(index);
-    if (!targetSample)
-    {
-        value = "NULL";
-        m_sampleMutex.unlock();
-        return value;
-    }
+    // The sample is kept alive by targetSample while it's read
+    const std::shared_ptr<OpenDynamicData> targetSample =
+        getHistory(topicName)->getSample(index);
 
-    // Find the target member within this sample
-    const std::shared_ptr<OpenDynamicData> targetMember =
-        targetSample->getMember(memberName.toUtf8().data());
+    return readValue(targetSample, memberPath);
 
-    if (!targetMember)
+} // End CommonData::readValue
+
+
+//------------------------------------------------------------------------------
+QVariant CommonData::readValue(const std::shared_ptr<OpenDynamicData>& targetSample,
+                               const MemberPath& memberPath)
+{
+    QVariant value = "NULL";
+    if (!targetSample || !memberPath.isValid())
     {
-        value = "NULL";
-        m_sampleMutex.unlock();
         return value;
     }
 
 
     // Store the value into a QVariant
     // The tmpValue may seem redundant, but it's very helpful for debug
-    CORBA::TCKind type = targetMember->getKind();
+    CORBA::TCKind type = memberPath.getKind();
     switch (type)
     {
     case CORBA::tk_long:
     {
-        int32_t tmpValue = targetMember->getValue<int32_t>();
-        value = tmpValue;
+        int32_t tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_short:
     {
-        int16_t tmpValue = targetMember->getValue<int16_t>();
-        value = tmpValue;
+        int16_t tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_ushort:
     {
-        uint16_t tmpValue = targetMember->getValue<uint16_t>();
-        value = tmpValue;
+        uint16_t tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_ulong:
+    case CORBA::tk_boolean:
+    case CORBA::tk_enum:
     {
-        uint32_t tmpValue = targetMember->getValue<uint32_t>();
-        value = tmpValue;
+        uint32_t tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_float:
     {
-        float tmpValue = targetMember->getValue<float>();
-        value = tmpValue;
+        float tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_double:
     {
-        double tmpValue = targetMember->getValue<double>();
-        value = tmpValue;
-        break;
-    }
-    case CORBA::tk_boolean:
-    {
-        uint32_t tmpValue = targetMember->getValue<uint32_t>();
-        value = tmpValue;
+        double tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_char:
+    case CORBA::tk_wchar: // FIXME?
     {
-        char tmpValue = targetMember->getValue<char>();
-        value = tmpValue;
-        break;
-    }
-    case CORBA::tk_wchar:
-    {
-        char tmpValue = targetMember->getValue<char>(); // FIXME?
-        value = tmpValue;
+        char tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_octet:
     {
-        uint8_t tmpValue = targetMember->getValue<uint8_t>();
-        value = tmpValue;
+        uint8_t tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_longlong:
     {
-        qint64 tmpValue = targetMember->getValue<qint64>();
-        value = tmpValue;
+        qint64 tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_ulonglong:
     {
-        quint64 tmpValue = targetMember->getValue<quint64>();
-        value = tmpValue;
+        quint64 tmpValue = 0;
+        if (targetSample->getValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     case CORBA::tk_string:
     {
-        const char* tmpValue = targetMember->getStringValue();
-        value = tmpValue;
-        break;
-    }
-    case CORBA::tk_enum:
-    {
-        const uint32_t tmpValue = targetMember->getValue<uint32_t>();
-        value = tmpValue;
+        const char* tmpValue = nullptr;
+        if (targetSample->getStringValue(memberPath, tmpValue))
+        {
+            value = tmpValue;
+        }
         break;
     }
     default:
-        value = "NULL";
         break;
 
-    } // End targetMember type switch
+    } // End member type switch
 
-
-    m_sampleMutex.unlock();
     return value;
 
 } // End CommonData::readValue
 
 
 //------------------------------------------------------------------------------
-void CommonData::flushSamples(const QString& topicName)
+std::shared_ptr<TopicHistory> CommonData::getHistory(const QString& topicName)
 {
     m_sampleMutex.lock();
-    
-    //Confirm this still does the same thing -MM
-    //auto sampleList = m_samples[topicName];
+    std::shared_ptr<TopicHistory>& history = m_histories[topicName];
+    if (!history)
+    {
+        if (m_historyBudget)
+        {
+            history = std::make_shared<TopicHistory>(
+                topicName,
+                m_historyBudget->defaultMaxSamples(),
+                m_historyBudget->defaultMaxAge(),
+                m_historyBudget);
+            m_historyBudget->addHistory(history);
+        }
+        else
+        {
+            history = std::make_shared<TopicHistory>(topicName, MAX_SAMPLES, 0, nullptr);
+        }
+        history->setNotifier(m_changeNotifier);
+    }
+    const std::shared_ptr<TopicHistory> handle = history;
+    m_sampleMutex.unlock();
 
-    //for (int i = 0; i < sampleList.size(); i++)
-    //{
-    //   delete sampleList[i];
-    //   sampleList[i] = nullptr;
-    //}
+    return handle;
+}
 
-    m_samples[topicName].clear();
-    m_sampleTimes[topicName].clear();
-    m_sampleMutex.unlock();
+
+//------------------------------------------------------------------------------
+void CommonData::flushSamples(const QString& topicName)
+{
+    getHistory(topicName)->clear();
 }
 
 
 //------------------------------------------------------------------------------
-void CommonData::storeSample(const QString& topicName,
-                             const QString& sampleName,
-                             const std::shared_ptr<OpenDynamicData> sample)
+uint64_t CommonData::storeSample(const QString& topicName,
+                                 const int64_t& sourceTime,
+                                 const int64_t& receiveTime,
+                                 const std::shared_ptr<OpenDynamicData> sample)
 {
-    m_sampleMutex.lock();
+    return getHistory(topicName)->store(sourceTime, receiveTime, sample);
+}
 
-    // Create the initial sample list if this is the first sample
-    if (!m_samples.contains(topicName))
-    {
-       m_samples[topicName];
-    }
 
-    QList<std::shared_ptr<OpenDynamicData>>& sampleList = m_samples[topicName];
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> CommonData::copySample(const QString& topicName,
+                                        const unsigned int& index)
+{
+    // Don't copy the sample, just point to the shared pointer
+    return getHistory(topicName)->getSample(index);
+}
+
 
-    // Store a pointer to the new sample
-    m_samples[topicName].push_front(sample);
-    m_sampleTimes[topicName].push_front(sampleName);
+//------------------------------------------------------------------------------
+QStringList CommonData::getSampleList(const QString& topicName)
+{
+    const QList<SampleInfo> infoList = getSampleInfo(topicName);
 
-    // Cleanup
-    while (sampleList.size() > MAX_SAMPLES)
+    QStringList sampleNames;
+    sampleNames.reserve(infoList.size());
+    for (const SampleInfo& info : infoList)
     {
-       //delete sampleList.back();
-       //sampleList.back() = nullptr;
-       sampleList.pop_back();
-       m_sampleTimes[topicName].pop_back();
+        sampleNames.append(formatTime(info.sourceTime));
     }
 
-    m_sampleMutex.unlock();
-
-} // End CommonData::storeSample
+    return sampleNames;
+}
 
 
 //------------------------------------------------------------------------------
-std::shared_ptr<OpenDynamicData> CommonData::copySample(const QString& topicName,
-                                        const unsigned int& index)
+QList<SampleInfo> CommonData::getSampleInfo(const QString& topicName)
 {
-    std::shared_ptr<OpenDynamicData> newSample;
+    return getHistory(topicName)->getSampleInfo();
+}
 
-    m_sampleMutex.lock();
-    if (m_samples.contains(topicName) &&
-       m_samples.value(topicName).size() > (int)index)
-    {
-        // Don't copy the sample, just point to the shared pointer
-        newSample = m_samples.value(topicName).at(index);
-    }
-    m_sampleMutex.unlock();
 
-    return newSample;
+//------------------------------------------------------------------------------
+QList<SampleRecord> CommonData::getSamplesSince(const QString& topicName,
+                                                const uint64_t& sequence)
+{
+    return getHistory(topicName)->getSamplesSince(sequence);
 }
 
 
 //------------------------------------------------------------------------------
-QStringList CommonData::getSampleList(const QString& topicName)
+uint64_t CommonData::getLatestSequence(const QString& topicName)
 {
-    QStringList sampleNames;
+    return getHistory(topicName)->latestSequence();
+}
 
-    m_sampleMutex.lock();
-    if (m_sampleTimes.contains(topicName))
-    {
-        sampleNames = m_sampleTimes.value(topicName);
-    }
-    m_sampleMutex.unlock();
 
-    return sampleNames;
+//------------------------------------------------------------------------------
+QString CommonData::formatTime(const int64_t& time)
+{
+    const QDateTime dataTime = QDateTime::fromMSecsSinceEpoch(time / 1000000);
+    return dataTime.toString("HH:mm:ss.zzz");
 }
 
 
 //------------------------------------------------------------------------------
 void CommonData::clearSamples(const QString& topicName)
 {
-    m_sampleMutex.lock();
-    if (m_samples.contains(topicName))
-    {
-        m_samples[topicName].clear();
-        //QList<const OpenDynamicData*>& samples = m_samples[topicName];
-        //while (!samples.empty())
-        //{
-        //    delete samples.back();
-        //    samples.pop_back();
-        //}
+    getHistory(topicName)->clear();
+}
 
-        while (!m_sampleTimes[topicName].empty())
-        {
-            m_sampleTimes[topicName].pop_back();
-        }
-    }
-    m_sampleMutex.unlock();
+
+//------------------------------------------------------------------------------
+void CommonData::setSamplePool(const QString& topicName,
+                               std::shared_ptr<SamplePool> pool)
+{
+    getHistory(topicName)->setSamplePool(pool);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<SamplePool> CommonData::getSamplePool(const QString& topicName)
+{
+    return getHistory(topicName)->getSamplePool();
 }
 
 
@@ -2,6 +2,8 @@
 #define __DDS_DATA_MONITOR_H__
 
 #include "first_define.h"
+#include "member_path.h"
+#include "topic_history.h"
 
 #include <cstdint>
 
@@ -22,8 +24,13 @@
 #include <string>
 
 
+class ChangeNotifier;
 class DDSManager;
+class HistoryBudget;
 class OpenDynamicData;
+class SamplePipeline;
+class SamplePool;
+class SpillWriter;
 class TopicSampleTableModel;
 
 const std::string DATA_READER_NAME = "DDSMon";
@@ -202,12 +209,24 @@ class CommonData
 {
 public:
 
-    /// The maximum number of samples to store in the history.
+    /// The number of samples to store in the history if there's no budget.
     static const int MAX_SAMPLES = 500;
 
     /// The shared DDS manager object.
     static std::unique_ptr<DDSManager> m_ddsManager;
 
+    /// Filters and stores received samples off the DDS receive threads.
+    static std::unique_ptr<SamplePipeline> m_samplePipeline;
+
+    /// The memory budget and default depth of the topic histories.
+    static std::shared_ptr<HistoryBudget> m_historyBudget;
+
+    /// Writes samples evicted from the histories to disk, if enabled.
+    static std::shared_ptr<SpillWriter> m_spillWriter;
+
+    /// Reports changed topic histories to the pages.
+    static std::shared_ptr<ChangeNotifier> m_changeNotifier;
+
     /// Delete all data objects before closing.
    static void cleanup();
 
@@ -245,6 +264,54 @@ public:
                               const QString& memberName,
                               const unsigned int& index = 0);
 
+    /**
+     * @brief Read the value of a DDS sample by a resolved member path.
+     * @param[in] topicName The name of the topic.
+     * @param[in] memberPath The member path from resolveMember().
+     * @param[in] index The sample index. 0 is the newest.
+     * @return A QVariant containing the sample value.
+     */
+    static QVariant readValue(const QString& topicName,
+                              const MemberPath& memberPath,
+                              const unsigned int& index = 0);
+
+    /**
+     * @brief Read the value of a member of a given sample.
+     * @param[in] sample The data sample.
+     * @param[in] memberPath The member path from resolveMember().
+     * @return A QVariant containing the sample value.
+     */
+    static QVariant readValue(const std::shared_ptr<OpenDynamicData>& sample,
+                              const MemberPath& memberPath);
+
+    /**
+     * @brief Resolve a member name of a topic for repeated reads.
+     * @param[in] topicName The name of the topic.
+     * @param[in] memberName The full name of the topic member.
+     * @return The member path. Invalid if the topic or member is unknown.
+     */
+    static MemberPath resolveMember(const QString& topicName,
+                                    const QString& memberName);
+
+    /**
+     * @brief Resolve several member names of a topic for repeated reads.
+     * @param[in] topicName The name of the topic.
+     * @param[in] memberNames The full names of the topic members.
+     * @return The member paths, in order. Unknown members are invalid.
+     */
+    static std::vector<MemberPath> resolveMembers(const QString& topicName,
+                                                  const QStringList& memberNames);
+
+    /**
+     * @brief Get the sample history of a given topic.
+     * @details The history is created if it doesn't exist yet. Every call
+     *          takes the lock of the history map, but the handle stays valid,
+     *          so pages fetch it once and keep it.
+     * @param[in] topicName The name of the topic.
+     * @return The sample history.
+     */
+    static std::shared_ptr<TopicHistory> getHistory(const QString& topicName);
+
     /**
      * @brief Delete all data samples for a specified topic.
      * @param[in] topicName The name of the topic.
@@ -254,12 +321,15 @@ public:
     /**
      * @brief Store a new data sample for a specified topic
      * @param[in] topicName The name of the topic.
-     * @param[in] sampleName The name (timestamp) of the data sample.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receiveTime The receive timestamp in nanoseconds.
      * @param[in] sample The data sample of the topic.
+     * @return The sequence number assigned to the sample.
      */
-    static void storeSample(const QString& topicName,
-                            const QString& sampleName,
-                            const std::shared_ptr<OpenDynamicData> sample);
+    static uint64_t storeSample(const QString& topicName,
+                                const int64_t& sourceTime,
+                                const int64_t& receiveTime,
+                                const std::shared_ptr<OpenDynamicData> sample);
 
     /**
      * @brief Get a copy of a sample for a specified topic.
@@ -278,27 +348,65 @@ public:
      */
     static QStringList getSampleList(const QString& topicName);
 
+    /**
+     * @brief Get the bookkeeping of the stored samples of a given topic.
+     * @param[in] topicName The name of the topic.
+     * @return The sample info list. The newest is on the front.
+     */
+    static QList<SampleInfo> getSampleInfo(const QString& topicName);
+
+    /**
+     * @brief Get the stored samples received after a given sequence number.
+     * @param[in] topicName The name of the topic.
+     * @param[in] sequence Only get samples with a higher sequence number.
+     * @return The samples, oldest first.
+     */
+    static QList<SampleRecord> getSamplesSince(const QString& topicName,
+                                               const uint64_t& sequence);
+
+    /**
+     * @brief Get the sequence number of the newest sample of a given topic.
+     * @param[in] topicName The name of the topic.
+     * @return The sequence number or 0 if no sample was received yet.
+     */
+    static uint64_t getLatestSequence(const QString& topicName);
+
+    /**
+     * @brief Format a timestamp for display.
+     * @param[in] time The timestamp in nanoseconds since the epoch.
+     * @return The local time as "HH:mm:ss.zzz".
+     */
+    static QString formatTime(const int64_t& time);
+
     /**
      * @brief Clear the sample history for a given topic.
      * @param[in] topicName The name of the topic.
      */
     static void clearSamples(const QString& topicName);
 
-private:
+    /**
+     * @brief Set the pool that receives samples evicted from the history.
+     * @param[in] topicName The name of the topic.
+     * @param[in] pool The sample pool for this topic.
+     */
+    static void setSamplePool(const QString& topicName,
+                              std::shared_ptr<SamplePool> pool);
 
     /**
-     * @brief Stores the data samples from DDS.
-     * @details The key is the topic name and the value is the data sample. The
-     *          first sample is always the latest and the last sample is last.
+     * @brief Get the sample pool for a given topic.
+     * @param[in] topicName The name of the topic.
+     * @return The sample pool or nullptr if the topic isn't monitored.
      */
-    static QMap<QString, QList<std::shared_ptr<OpenDynamicData> > > m_samples;
+    static std::shared_ptr<SamplePool> getSamplePool(const QString& topicName);
+
+private:
 
     /**
-     * @brief Stores the data sample times.
-     * @details The key is the topic name and the value is the data time. The
-     *          first sample is always the latest and the last sample is last.
+     * @brief Stores the sample history of each topic.
+     * @details The key is the topic name. A history is created on first use
+     *          and lives until cleanup(), so callers may keep the handle.
      */
-    static QMap<QString, QStringList> m_sampleTimes;
+    static QMap<QString, std::shared_ptr<TopicHistory>> m_histories;
 
     /**
      * @brief Stores information about the topics on the bus.
@@ -307,7 +415,7 @@ private:
      */
     static QMap<QString, std::shared_ptr<TopicInfo>> m_topicInfo;
 
-    /// Mutex for protecting access to m_samples.
+    /// Mutex for protecting access to m_histories. Not held while reading samples.
     static QMutex m_sampleMutex;
 
     /// Mutex for protecting access to m_topicInfo.
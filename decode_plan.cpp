@@ -0,0 +1,660 @@
+#include "decode_plan.h"
+#include "open_dynamic_data.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+//------------------------------------------------------------------------------
+DecodePlan::DecodePlan(const CORBA::TypeCode* typeCode,
+                       const OpenDDS::DCPS::Encoding::Kind encodingKind,
+                       const OpenDDS::DCPS::Extensibility extensibility) :
+                       m_payloadPosition(0),
+                       m_fixedPosition(true),
+                       m_maxDepth(0),
+                       m_encodingKind(encodingKind),
+                       m_extensibility(extensibility),
+                       m_rootDelimited(false),
+                       m_valid(false)
+{
+    if (!typeCode)
+    {
+        std::cerr << "Bad typecode received in DecodePlan()" << std::endl;
+        return;
+    }
+
+    // Per xtypes spec, section 7.4.3.5.3 rule (30), only appendable and
+    // mutable types carry a delimiter header in XCDR2.
+    m_rootDelimited = (m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1) &&
+                      (m_extensibility != OpenDDS::DCPS::Extensibility::FINAL);
+
+    m_layout = SampleLayout::get(typeCode);
+    m_valid = true;
+    m_payloadPosition = m_rootDelimited ? sizeof(uint32_t) : 0;
+    compileStruct(m_layout->root(), 0, 0);
+
+} // End DecodePlan::DecodePlan
+
+
+//------------------------------------------------------------------------------
+DecodePlan::~DecodePlan()
+{}
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::isValid() const
+{
+    return m_valid;
+}
+
+
+//------------------------------------------------------------------------------
+uint8_t DecodePlan::alignmentOf(const CORBA::TCKind kind) const
+{
+    uint8_t alignment = 1;
+    switch (kind)
+    {
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+    case CORBA::tk_wchar:
+        alignment = 2;
+        break;
+    case CORBA::tk_long:
+    case CORBA::tk_ulong:
+    case CORBA::tk_enum:
+    case CORBA::tk_float:
+    case CORBA::tk_string:
+    case CORBA::tk_sequence:
+        alignment = 4;
+        break;
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+    case CORBA::tk_double:
+        alignment = 8;
+        break;
+    default:
+        break;
+    }
+
+    // XCDR2 never aligns to more than 4 bytes
+    if (m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1 && alignment > 4)
+    {
+        alignment = 4;
+    }
+
+    return alignment;
+}
+
+
+//------------------------------------------------------------------------------
+size_t DecodePlan::minimumWireSize(const SampleLayout::Node& node) const
+{
+    const bool xcdr2 = (m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1);
+    const size_t delimiter = xcdr2 ? sizeof(ACE_CDR::ULong) : 0;
+
+    switch (node.kind)
+    {
+    case CORBA::tk_wchar:
+        // The wire size depends on the negotiated code set
+        return 1;
+
+    case CORBA::tk_string:
+        return sizeof(ACE_CDR::ULong);
+
+    case CORBA::tk_struct:
+    {
+        size_t size = delimiter;
+        for (const SampleLayout::Node& member : node.members)
+        {
+            size += minimumWireSize(member);
+        }
+        return size;
+    }
+
+    case CORBA::tk_array:
+        return (node.containsComplexTypes ? delimiter : 0) +
+               node.length * minimumWireSize(node.members[0]);
+
+    case CORBA::tk_sequence:
+        return (node.containsComplexTypes ? delimiter : 0) + sizeof(ACE_CDR::ULong);
+
+    default:
+        return SampleLayout::primitiveSize(node.kind);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::fitsPayload(const OpenDDS::DCPS::Serializer& stream,
+                             const size_t length,
+                             const size_t wireSize)
+{
+    // Even an element with no payload bytes of its own is counted as one
+    return length <= stream.length() / std::max<size_t>(wireSize, 1);
+}
+
+
+//------------------------------------------------------------------------------
+void DecodePlan::compileStruct(const SampleLayout::Node& node,
+                               const size_t depth,
+                               const size_t base)
+{
+    // Members with invalid type codes were already left out of the layout
+    for (const SampleLayout::Node& member : node.members)
+    {
+        compileMember(member, depth, base);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void DecodePlan::trackFixed(const CORBA::TCKind kind,
+                            const size_t count,
+                            const size_t storageOffset,
+                            const size_t stride)
+{
+    if (!m_fixedPosition)
+    {
+        return;
+    }
+
+    // The wire size of wchar depends on the negotiated code set
+    const size_t size = SampleLayout::primitiveSize(kind);
+    if (kind == CORBA::tk_wchar || size == 0)
+    {
+        m_fixedPosition = false;
+        return;
+    }
+
+    const size_t alignment = alignmentOf(kind);
+    m_payloadPosition = (m_payloadPosition + alignment - 1) / alignment * alignment;
+
+    if (storageOffset != NO_BASE)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            m_fixedOffsets[storageOffset + i * stride] = m_payloadPosition + i * size;
+        }
+    }
+
+    m_payloadPosition += size * count;
+}
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::getFixedOffset(const size_t storageOffset, size_t& payloadOffset) const
+{
+    const auto iter = m_fixedOffsets.find(storageOffset);
+    if (iter == m_fixedOffsets.end())
+    {
+        return false;
+    }
+
+    payloadOffset = iter->second;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+void DecodePlan::compileMember(const SampleLayout::Node& node,
+                               const size_t depth,
+                               const size_t base)
+{
+    const size_t storageOffset = (base == NO_BASE) ? NO_BASE : base + node.offset;
+
+    Op op;
+    op.code = OP_UNSUPPORTED;
+    op.kind = node.kind;
+    op.delimited = false;
+    op.offset = node.offset;
+    op.stride = node.stride;
+    op.count = 0;
+    op.wireSize = 0;
+    op.end = 0;
+    op.name = node.name.empty() ? "[]" : node.name;
+
+    if (depth + 1 > m_maxDepth)
+    {
+        m_maxDepth = depth + 1;
+    }
+
+    switch (op.kind)
+    {
+    case CORBA::tk_long:
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+    case CORBA::tk_enum:
+    case CORBA::tk_ulong:
+    case CORBA::tk_float:
+    case CORBA::tk_double:
+    case CORBA::tk_char:
+    case CORBA::tk_wchar:
+    case CORBA::tk_octet:
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+    case CORBA::tk_boolean:
+        op.code = OP_PRIMITIVE;
+        m_ops.push_back(op);
+        trackFixed(op.kind, 1, storageOffset, 0);
+        return;
+
+    case CORBA::tk_string:
+        op.code = OP_STRING;
+        m_ops.push_back(op);
+        m_fixedPosition = false;
+        return;
+
+    case CORBA::tk_struct:
+    {
+        // Nested structs are treated as final, but always carry a delimiter
+        // header in XCDR2. This matches OpenDynamicData::operator<<.
+        op.code = OP_STRUCT;
+        op.delimited = (m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1);
+        const size_t structIndex = m_ops.size();
+        m_ops.push_back(op);
+
+        if (op.delimited)
+        {
+            trackFixed(CORBA::tk_ulong, 1, NO_BASE, 0);
+        }
+
+        compileStruct(node, depth + 1, storageOffset);
+
+        Op endOp = op;
+        endOp.code = OP_END;
+        endOp.delimited = false;
+        m_ops.push_back(endOp);
+        m_ops[structIndex].end = m_ops.size() - 1;
+        return;
+    }
+
+    case CORBA::tk_array:
+    case CORBA::tk_sequence:
+    {
+        const SampleLayout::Node& element = node.members[0];
+        const bool isArray = (op.kind == CORBA::tk_array);
+        op.count = isArray ? node.length : 0;
+        op.wireSize = minimumWireSize(element);
+
+        // Primitive elements are read in bulk without a loop body
+        if (OpenDynamicData::isPrimitiveKind(element.kind))
+        {
+            op.code = isArray ? OP_PRIMITIVE_ARRAY : OP_PRIMITIVE_SEQUENCE;
+            op.kind = element.kind;
+            m_ops.push_back(op);
+
+            if (isArray)
+            {
+                trackFixed(element.kind, op.count, storageOffset, node.stride);
+            }
+            else
+            {
+                m_fixedPosition = false;
+            }
+            return;
+        }
+
+        // XCDR2 adds a delimiter header before arrays and sequences of
+        // complex types
+        op.code = isArray ? OP_ARRAY : OP_SEQUENCE;
+        op.delimited = (m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1);
+        const size_t loopIndex = m_ops.size();
+        m_ops.push_back(op);
+
+        // Complex elements are not indexed
+        m_fixedPosition = false;
+
+        // The element body is relative to the start of each element
+        compileMember(element, depth + 1, NO_BASE);
+
+        Op endOp = op;
+        endOp.code = OP_END;
+        endOp.delimited = false;
+        m_ops.push_back(endOp);
+        m_ops[loopIndex].end = m_ops.size() - 1;
+        return;
+    }
+
+    case CORBA::tk_wstring: // TODO?
+    case CORBA::tk_union: // TODO?
+    default:
+        // Keep the op so the failure is reported with the member name
+        m_ops.push_back(op);
+        m_fixedPosition = false;
+        return;
+    }
+
+} // End DecodePlan::compileMember
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::readPrimitive(OpenDDS::DCPS::Serializer& stream,
+                               const CORBA::TCKind kind,
+                               char* dest)
+{
+    return readPrimitiveArray(stream, kind, dest, 1);
+}
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::readPrimitiveArray(OpenDDS::DCPS::Serializer& stream,
+                                    const CORBA::TCKind kind,
+                                    char* dest,
+                                    const size_t count)
+{
+    // The layout keeps every value at its natural alignment, so the storage
+    // can be handed to the Serializer as a typed array.
+    const ACE_CDR::ULong length = static_cast<ACE_CDR::ULong>(count);
+    switch (kind)
+    {
+    case CORBA::tk_long:
+        return stream.read_long_array(reinterpret_cast<ACE_CDR::Long*>(dest), length);
+    case CORBA::tk_short:
+        return stream.read_short_array(reinterpret_cast<ACE_CDR::Short*>(dest), length);
+    case CORBA::tk_ushort:
+        return stream.read_ushort_array(reinterpret_cast<ACE_CDR::UShort*>(dest), length);
+    case CORBA::tk_enum:
+    case CORBA::tk_ulong:
+        return stream.read_ulong_array(reinterpret_cast<ACE_CDR::ULong*>(dest), length);
+    case CORBA::tk_float:
+        return stream.read_float_array(reinterpret_cast<ACE_CDR::Float*>(dest), length);
+    case CORBA::tk_double:
+        return stream.read_double_array(reinterpret_cast<ACE_CDR::Double*>(dest), length);
+    case CORBA::tk_char:
+        return stream.read_char_array(reinterpret_cast<ACE_CDR::Char*>(dest), length);
+    case CORBA::tk_wchar:
+        return stream.read_wchar_array(reinterpret_cast<ACE_CDR::WChar*>(dest), length);
+    case CORBA::tk_octet:
+        return stream.read_octet_array(reinterpret_cast<ACE_CDR::Octet*>(dest), length);
+    case CORBA::tk_longlong:
+        return stream.read_longlong_array(reinterpret_cast<ACE_CDR::LongLong*>(dest), length);
+    case CORBA::tk_ulonglong:
+        return stream.read_ulonglong_array(reinterpret_cast<ACE_CDR::ULongLong*>(dest), length);
+    case CORBA::tk_boolean:
+    {
+        const bool pass = stream.read_octet_array(reinterpret_cast<ACE_CDR::Octet*>(dest), length);
+
+        // Boolean values are often int on the wire (Example: true == 42)
+        // Force them to [0|1]
+        for (size_t i = 0; i < count; i++)
+        {
+            const ACE_CDR::Boolean value = (dest[i * sizeof(ACE_CDR::Boolean)] != 0);
+            memcpy(dest + i * sizeof(ACE_CDR::Boolean), &value, sizeof(value));
+        }
+        return pass;
+    }
+    default:
+        return false;
+    }
+
+} // End DecodePlan::readPrimitiveArray
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::readString(OpenDDS::DCPS::Serializer& stream, std::string& value)
+{
+    // The CDR length includes the NUL terminator
+    ACE_CDR::ULong length = 0;
+    if (!(stream >> length))
+    {
+        return false;
+    }
+
+    if (length == 0)
+    {
+        value.clear();
+        return true;
+    }
+
+    // The length comes straight off the wire, like a sequence length
+    if (!fitsPayload(stream, length, 1))
+    {
+        std::cerr << "DecodePlan::readString: "
+                  << "String length " << length
+                  << " is longer than the payload"
+                  << std::endl;
+        return false;
+    }
+
+    // Reuse the capacity of the arena string instead of a temporary copy
+    value.resize(length - 1);
+    if (length > 1 && !stream.read_char_array(&value[0], length - 1))
+    {
+        return false;
+    }
+
+    return stream.skip(1);
+
+} // End DecodePlan::readString
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::execute(OpenDDS::DCPS::Serializer& stream,
+                         OpenDynamicData& sample) const
+{
+    if (!sample.m_storage || sample.m_layout != &sample.m_storage->layout()->root())
+    {
+        std::cerr << "DecodePlan::execute: "
+                  << "Sample is not a top level sample"
+                  << std::endl;
+        return false;
+    }
+
+    return execute(stream, *sample.m_storage);
+}
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::execute(OpenDDS::DCPS::Serializer& stream,
+                         SampleStorage& storage) const
+{
+    /// Stores the state of an open struct or loop body.
+    struct Frame
+    {
+        uint32_t block;             ///< The block to return to at the end.
+        size_t base;                ///< The struct offset to return to.
+        uint32_t elementBlock;      ///< The block holding the loop elements.
+        size_t elementBase;         ///< The offset of the first element.
+        size_t stride;              ///< The distance between elements.
+        size_t bodyStart;           ///< First op of the loop body.
+        size_t element;             ///< The element being decoded.
+        size_t count;               ///< The number of elements, 0 for structs.
+    };
+
+    if (!m_valid)
+    {
+        return false;
+    }
+
+    if (storage.layout() != m_layout)
+    {
+        std::cerr << "DecodePlan::execute: "
+                  << "Sample does not match the plan"
+                  << std::endl;
+        return false;
+    }
+
+    bool pass = true;
+    uint32_t delimHeader = 0;
+
+    if (m_rootDelimited && !(stream >> delimHeader))
+    {
+        std::cerr << "DecodePlan::execute: "
+                  << "Could not read stream delimiter"
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<Frame> frames;
+    frames.reserve(m_maxDepth);
+
+    uint32_t block = 0;
+    size_t base = 0;
+    const size_t opCount = m_ops.size();
+    size_t pc = 0;
+
+    while (pc < opCount)
+    {
+        // Protection for inconsistent topics or junk data
+        if (!pass || !stream.good_bit())
+        {
+            break;
+        }
+
+        const Op& op = m_ops[pc];
+        const size_t offset = base + op.offset;
+
+        switch (op.code)
+        {
+        case OP_PRIMITIVE:
+            pass &= readPrimitive(stream, op.kind, storage.data(block) + offset);
+            ++pc;
+            break;
+
+        case OP_STRING:
+            pass &= readString(stream, storage.stringSlot(block, offset));
+            ++pc;
+            break;
+
+        case OP_PRIMITIVE_SEQUENCE:
+        {
+            CORBA::ULong length = 0;
+            pass &= (stream >> length);
+            if (!pass)
+            {
+                break;
+            }
+
+            if (!fitsPayload(stream, length, op.wireSize))
+            {
+                std::cerr << "DecodePlan::execute: "
+                          << "Sequence length " << length
+                          << " is longer than the payload"
+                          << std::endl;
+                pass = false;
+                break;
+            }
+
+            const uint32_t elements = storage.resizeSequence(block, offset, length, op.stride);
+            if (length > 0)
+            {
+                pass &= readPrimitiveArray(stream, op.kind, storage.data(elements), length);
+            }
+            ++pc;
+            break;
+        }
+
+        case OP_PRIMITIVE_ARRAY:
+            pass &= readPrimitiveArray(stream, op.kind, storage.data(block) + offset, op.count);
+            ++pc;
+            break;
+
+        case OP_STRUCT:
+            if (op.delimited && !(stream >> delimHeader))
+            {
+                pass = false;
+                break;
+            }
+            frames.push_back({ block, base, 0, 0, 0, pc + 1, 0, 0 });
+            base = offset;
+            ++pc;
+            break;
+
+        case OP_ARRAY:
+        case OP_SEQUENCE:
+        {
+            if (op.delimited && !(stream >> delimHeader))
+            {
+                pass = false;
+                break;
+            }
+
+            uint32_t elementBlock = block;
+            size_t elementBase = offset;
+            size_t count = op.count;
+
+            if (op.code == OP_SEQUENCE)
+            {
+                CORBA::ULong length = 0;
+                pass &= (stream >> length);
+                if (!pass)
+                {
+                    break;
+                }
+
+                if (!fitsPayload(stream, length, op.wireSize))
+                {
+                    std::cerr << "DecodePlan::execute: "
+                              << "Sequence length " << length
+                              << " is longer than the payload"
+                              << std::endl;
+                    pass = false;
+                    break;
+                }
+
+                elementBlock = storage.resizeSequence(block, offset, length, op.stride);
+                elementBase = 0;
+                count = length;
+            }
+
+            // Skip the body of empty sequences
+            if (count == 0)
+            {
+                pc = op.end + 1;
+                break;
+            }
+
+            frames.push_back({ block, base, elementBlock, elementBase, op.stride, pc + 1, 0, count });
+            block = elementBlock;
+            base = elementBase;
+            ++pc;
+            break;
+        }
+
+        case OP_END:
+        {
+            Frame& frame = frames.back();
+            if (++frame.element < frame.count)
+            {
+                // Decode the next element with the same body
+                block = frame.elementBlock;
+                base = frame.elementBase + frame.element * frame.stride;
+                pc = frame.bodyStart;
+                break;
+            }
+
+            block = frame.block;
+            base = frame.base;
+            frames.pop_back();
+            ++pc;
+            break;
+        }
+
+        case OP_UNSUPPORTED:
+        default:
+            std::cerr << "DecodePlan::execute: "
+                      << "Unsupported type (" << op.kind << ")"
+                      << std::endl;
+            pass = false;
+            break;
+        }
+
+        if (!pass)
+        {
+            std::cerr << "Failed to deserialize '"
+                      << op.name
+                      << "'"
+                      << std::endl;
+        }
+
+    } // End op loop
+
+    return pass;
+
+} // End DecodePlan::execute
+
+
+/**
+ * @}
+ */
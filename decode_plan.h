@@ -0,0 +1,269 @@
+#ifndef __DECODE_PLAN_H__
+#define __DECODE_PLAN_H__
+
+#include <dds/DCPS/Serializer.h>
+#include <dds/DCPS/TypeSupportImpl.h>
+#include <tao/AnyTypeCode/TypeCode.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sample_layout.h"
+
+class OpenDynamicData;
+
+
+/**
+ * @brief Flat decode program for a single DDS topic type.
+ *
+ * @details The type code of a topic is compiled once into a linear list of
+ *          operations. Each operation already knows the member kind, whether
+ *          an XCDR2 delimiter header precedes it and the byte offset in the
+ *          SampleStorage that receives the value. The Serializer aligns each
+ *          value itself. Decoding a sample is then a single loop over this list
+ *          that writes straight into the flat sample buffer. Primitive arrays
+ *          and sequences are copied in bulk.
+ *
+ *          While compiling, the plan also records the CDR position of every
+ *          top level primitive that precedes the first variable length member.
+ *          Those members can be read from a payload without decoding it.
+ *
+ * @remarks The sample passed to execute() must have been created from the
+ *          same type code, encoding and extensibility as the plan.
+ */
+class DecodePlan
+{
+public:
+
+    /**
+     * @brief Compile the decode plan for a topic type.
+     * @param[in] typeCode The type definition pointer for the topic.
+     * @param[in] encodingKind The encoding kind for this type. XCDR1 or XCDR2
+     * @param[in] extensibility The extensibility of the topic type.
+     */
+    DecodePlan(const CORBA::TypeCode* typeCode,
+               const OpenDDS::DCPS::Encoding::Kind encodingKind,
+               const OpenDDS::DCPS::Extensibility extensibility);
+
+    /**
+     * @brief Destructor for the decode plan.
+     */
+    ~DecodePlan();
+
+    /**
+     * @brief Get whether the type code could be compiled into a plan.
+     * @return True if the plan is usable; false otherwise.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Populate a sample from a serialized topic payload.
+     * @remarks This includes the top level delimiter header, if any.
+     * @param[in] stream Read the member values from this Serializer object.
+     * @param[out] sample Store the member values into this sample.
+     * @return True if the operation was successful; false otherwise.
+     */
+    bool execute(OpenDDS::DCPS::Serializer& stream, OpenDynamicData& sample) const;
+
+    /**
+     * @brief Populate sample storage from a serialized topic payload.
+     * @remarks This includes the top level delimiter header, if any.
+     * @param[in] stream Read the member values from this Serializer object.
+     * @param[out] storage Store the member values here.
+     * @return True if the operation was successful; false otherwise.
+     */
+    bool execute(OpenDDS::DCPS::Serializer& stream, SampleStorage& storage) const;
+
+    /**
+     * @brief Get the payload position of a fixed position member.
+     * @param[in] storageOffset The offset of the member within block 0.
+     * @param[out] payloadOffset The offset of the member within the payload.
+     * @return True if the member always sits at the same payload position.
+     */
+    bool getFixedOffset(const size_t storageOffset, size_t& payloadOffset) const;
+
+private:
+
+    /// The operation codes for the decode program.
+    enum eOpCode
+    {
+        OP_PRIMITIVE,           ///< Read one primitive value.
+        OP_STRING,              ///< Read one string into the string arena.
+        OP_PRIMITIVE_ARRAY,     ///< Bulk read a fixed number of primitives.
+        OP_PRIMITIVE_SEQUENCE,  ///< Bulk read a counted number of primitives.
+        OP_STRUCT,              ///< Descend into a nested struct.
+        OP_ARRAY,               ///< Loop the body over every array element.
+        OP_SEQUENCE,            ///< Loop the body over every sequence element.
+        OP_END,                 ///< End of a struct or loop body.
+        OP_UNSUPPORTED          ///< Member kind the monitor can't decode.
+    };
+
+    /// A single step in the decode program.
+    struct Op
+    {
+        /// What this step does.
+        eOpCode code;
+
+        /// The kind of the member, or of the elements for bulk reads.
+        CORBA::TCKind kind;
+
+        /// True if an XCDR2 delimiter header precedes this member.
+        bool delimited;
+
+        /// The byte offset within the current struct or element.
+        size_t offset;
+
+        /// The element size in bytes for array and sequence operations.
+        size_t stride;
+
+        /// The fixed array length for array operations.
+        size_t count;
+
+        /// The fewest payload bytes one sequence element can take up.
+        size_t wireSize;
+
+        /// Index of the matching OP_END for struct and loop operations.
+        size_t end;
+
+        /// The member name, for diagnostics only.
+        std::string name;
+    };
+
+    /// Base offset for members that are not at a fixed place in block 0.
+    static const size_t NO_BASE = static_cast<size_t>(-1);
+
+    /**
+     * @brief Append the operations for a single member.
+     * @param[in] node The layout of the member.
+     * @param[in] depth The nesting depth of the member.
+     * @param[in] base The block 0 offset of the enclosing struct, or NO_BASE.
+     */
+    void compileMember(const SampleLayout::Node& node,
+                       const size_t depth,
+                       const size_t base);
+
+    /**
+     * @brief Append the operations for every member of a struct.
+     * @param[in] node The layout of the struct.
+     * @param[in] depth The nesting depth of the struct.
+     * @param[in] base The block 0 offset of the struct, or NO_BASE.
+     */
+    void compileStruct(const SampleLayout::Node& node,
+                       const size_t depth,
+                       const size_t base);
+
+    /**
+     * @brief Advance the fixed payload position over a run of primitives.
+     * @param[in] kind The primitive kind.
+     * @param[in] count The number of values.
+     * @param[in] storageOffset The block 0 offset of the first value, or
+     *                          NO_BASE if it shouldn't be indexed.
+     * @param[in] stride The distance in bytes between values in block 0.
+     */
+    void trackFixed(const CORBA::TCKind kind,
+                    const size_t count,
+                    const size_t storageOffset,
+                    const size_t stride);
+
+    /**
+     * @brief Get the CDR alignment for a primitive kind.
+     * @param[in] kind The primitive kind.
+     * @return The alignment in bytes, accounting for the XCDR2 4 byte limit.
+     */
+    uint8_t alignmentOf(const CORBA::TCKind kind) const;
+
+    /**
+     * @brief Get the fewest payload bytes a member can take up.
+     * @remarks Padding is left out, so the real size is never smaller.
+     * @param[in] node The layout of the member.
+     * @return The minimum serialized size in bytes.
+     */
+    size_t minimumWireSize(const SampleLayout::Node& node) const;
+
+    /**
+     * @brief Check a sequence length against the rest of the payload.
+     * @details The length comes straight off the wire, so a corrupt or
+     *          hostile sample could otherwise make us allocate gigabytes.
+     * @param[in] stream The stream the length was read from.
+     * @param[in] length The sequence length.
+     * @param[in] wireSize The fewest payload bytes per element.
+     * @return True if the elements can fit in the remaining payload.
+     */
+    static bool fitsPayload(const OpenDDS::DCPS::Serializer& stream,
+                            const size_t length,
+                            const size_t wireSize);
+
+    /**
+     * @brief Read a single primitive value into the sample storage.
+     * @param[in] stream Read the value from this Serializer object.
+     * @param[in] kind The primitive kind to read.
+     * @param[out] dest Store the value here.
+     * @return True if the operation was successful; false otherwise.
+     */
+    static bool readPrimitive(OpenDDS::DCPS::Serializer& stream,
+                              const CORBA::TCKind kind,
+                              char* dest);
+
+    /**
+     * @brief Read a run of primitive values into the sample storage.
+     * @param[in] stream Read the values from this Serializer object.
+     * @param[in] kind The primitive kind of every element.
+     * @param[out] dest Store the values here.
+     * @param[in] count The number of elements to read.
+     * @return True if the operation was successful; false otherwise.
+     */
+    static bool readPrimitiveArray(OpenDDS::DCPS::Serializer& stream,
+                                   const CORBA::TCKind kind,
+                                   char* dest,
+                                   const size_t count);
+
+    /**
+     * @brief Read a string directly into its arena slot.
+     * @remarks Fails without allocating if the length is longer than the
+     *          rest of the payload.
+     * @param[in] stream Read the string from this Serializer object.
+     * @param[out] value Store the string here.
+     * @return True if the operation was successful; false otherwise.
+     */
+    static bool readString(OpenDDS::DCPS::Serializer& stream, std::string& value);
+
+    /// The layout of the samples this plan decodes into.
+    std::shared_ptr<const SampleLayout> m_layout;
+
+    /// Maps block 0 offsets to payload offsets for fixed position members.
+    std::unordered_map<size_t, size_t> m_fixedOffsets;
+
+    /// The payload position while compiling, valid while m_fixedPosition.
+    size_t m_payloadPosition;
+
+    /// False once compiling has passed a variable length member.
+    bool m_fixedPosition;
+
+    /// The compiled decode program.
+    std::vector<Op> m_ops;
+
+    /// The deepest struct/loop nesting in the program.
+    size_t m_maxDepth;
+
+    /// The encoding kind used for this type.
+    const OpenDDS::DCPS::Encoding::Kind m_encodingKind;
+
+    /// The extensibility of the topic type.
+    const OpenDDS::DCPS::Extensibility m_extensibility;
+
+    /// True if the top level struct is preceded by a delimiter header.
+    bool m_rootDelimited;
+
+    /// False if the type code couldn't be compiled.
+    bool m_valid;
+
+}; // End class DecodePlan
+
+#endif
+
+/**
+ * @}
+ */
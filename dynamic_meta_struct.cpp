@@ -1,11 +1,12 @@
 #include "dynamic_meta_struct.h"
 #include "open_dynamic_data.h"
 #include <cctype>
+#include <set>
 
 
 //------------------------------------------------------------------------------
-DynamicMetaStruct::DynamicMetaStruct(const std::shared_ptr<OpenDynamicData> oddInfo)
-    : m_sample(oddInfo)
+DynamicMetaStruct::DynamicMetaStruct(const CORBA::TypeCode* typeCode)
+    : m_typeCode(typeCode)
 {}
 
 
@@ -15,6 +16,110 @@ DynamicMetaStruct::~DynamicMetaStruct()
 }
 
 
+//------------------------------------------------------------------------------
+void DynamicMetaStruct::setSample(const std::shared_ptr<OpenDynamicData> sample)
+{
+    m_sample = sample;
+}
+
+
+//------------------------------------------------------------------------------
+bool DynamicMetaStruct::bindFields(const std::string& filter, std::string& unknownField)
+{
+    static const std::set<std::string> keywords =
+    {
+        "AND", "OR", "NOT", "BETWEEN", "LIKE", "IN", "MOD", "TRUE", "FALSE"
+    };
+
+    bool bound = true;
+    const size_t length = filter.size();
+    size_t pos = 0;
+    while (pos < length)
+    {
+        const unsigned char ch = filter[pos];
+
+        // Skip string literals
+        if (ch == '\'')
+        {
+            const size_t close = filter.find('\'', pos + 1);
+            pos = (close == std::string::npos) ? length : close + 1;
+            continue;
+        }
+
+        // Skip numbers and parameters such as %0
+        if (std::isdigit(ch) || ch == '%')
+        {
+            ++pos;
+            while (pos < length &&
+                   (std::isalnum(static_cast<unsigned char>(filter[pos])) || filter[pos] == '.'))
+            {
+                ++pos;
+            }
+            continue;
+        }
+
+        if (!std::isalpha(ch) && ch != '_')
+        {
+            ++pos;
+            continue;
+        }
+
+        // Field names may contain member and element separators
+        size_t end = pos;
+        while (end < length)
+        {
+            const unsigned char next = filter[end];
+            if (!std::isalnum(next) && next != '_' && next != '.' && next != '[' && next != ']')
+            {
+                break;
+            }
+            ++end;
+        }
+
+        const std::string field = filter.substr(pos, end - pos);
+        pos = end;
+
+        std::string upperField = field;
+        for (char& c : upperField)
+        {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+
+        if (keywords.count(upperField))
+        {
+            continue;
+        }
+
+        // Enum literals are quoted, so every other name has to be a member
+        MemberPath path(m_typeCode, field);
+        if (!path.isValid())
+        {
+            if (bound)
+            {
+                unknownField = field;
+                bound = false;
+            }
+            continue;
+        }
+
+        m_paths[field] = std::move(path);
+    }
+
+    return bound;
+
+} // End DynamicMetaStruct::bindFields
+
+
+//------------------------------------------------------------------------------
+template<class T>
+OpenDDS::DCPS::Value DynamicMetaStruct::readValue(const MemberPath& path) const
+{
+    T value = 0;
+    m_sample->getValue(path, value);
+    return value;
+}
+
+
 //------------------------------------------------------------------------------
 OpenDDS::DCPS::Value DynamicMetaStruct::getValue(const void*, DDS::MemberId) const
 {
@@ -40,41 +145,52 @@ OpenDDS::DCPS::Value DynamicMetaStruct::getValue(
         return 0;
     }
 
-    const std::shared_ptr<OpenDynamicData> member = m_sample->getMember(fieldSpec);
-    if (!member)
+    // m_paths is only written before the filter is installed, so the
+    // workers can share it without a lock. Filters with names that didn't
+    // bind are rejected, so a miss here means the parser found a name that
+    // bindFields() skipped.
+    const auto iter = m_paths.find(fieldSpec);
+    if (iter == m_paths.end())
     {
         std::cerr << "Filter error: "
                   << "Unable to find member named '"
                   << fieldSpec
                   << "'" << std::endl;
-
         return 0;
     }
 
+    const MemberPath& path = iter->second;
     OpenDDS::DCPS::Value newValue = 0;
 
-    switch (member->getKind())
+    switch (path.getKind())
     {
-        case CORBA::tk_longlong: newValue = member->getValue<CORBA::LongLong>(); break;
-        case CORBA::tk_ulonglong: newValue = member->getValue<CORBA::ULongLong>(); break;
-        case CORBA::tk_long: newValue = member->getValue<CORBA::Long>(); break;
-        case CORBA::tk_ulong: newValue = member->getValue<CORBA::ULong>(); break;
-        case CORBA::tk_boolean: newValue = member->getValue<CORBA::ULong>(); break;
-        case CORBA::tk_short: newValue = member->getValue<CORBA::Short>(); break;
-        case CORBA::tk_ushort: newValue = member->getValue<CORBA::UShort>(); break;
-        case CORBA::tk_octet: newValue = member->getValue<CORBA::Octet>(); break;
-        case CORBA::tk_char: newValue = member->getValue<CORBA::Char>(); break;
-        case CORBA::tk_wchar: newValue = member->getValue<CORBA::WChar>(); break;
-        case CORBA::tk_float: newValue = member->getValue<CORBA::Float>(); break;
-        case CORBA::tk_double: newValue = member->getValue<CORBA::Double>(); break;
-        case CORBA::tk_string: newValue = member->getStringValue(); break;
+        case CORBA::tk_longlong: newValue = readValue<CORBA::LongLong>(path); break;
+        case CORBA::tk_ulonglong: newValue = readValue<CORBA::ULongLong>(path); break;
+        case CORBA::tk_long: newValue = readValue<CORBA::Long>(path); break;
+        case CORBA::tk_ulong: newValue = readValue<CORBA::ULong>(path); break;
+        case CORBA::tk_boolean: newValue = readValue<CORBA::ULong>(path); break;
+        case CORBA::tk_short: newValue = readValue<CORBA::Short>(path); break;
+        case CORBA::tk_ushort: newValue = readValue<CORBA::UShort>(path); break;
+        case CORBA::tk_octet: newValue = readValue<CORBA::Octet>(path); break;
+        case CORBA::tk_char: newValue = readValue<CORBA::Char>(path); break;
+        case CORBA::tk_wchar: newValue = readValue<CORBA::WChar>(path); break;
+        case CORBA::tk_float: newValue = readValue<CORBA::Float>(path); break;
+        case CORBA::tk_double: newValue = readValue<CORBA::Double>(path); break;
+        case CORBA::tk_string:
+        {
+            const char* stringValue = "";
+            m_sample->getStringValue(path, stringValue);
+            newValue = stringValue;
+            break;
+        }
 
         // Use the string value for enums
         case CORBA::tk_enum:
         {
             // Make sure the int value is valid
-            const uint32_t enumValue = member->getValue<uint32_t>();
-            const CORBA::TypeCode* enumTypeCode = member->getTypeCode();
+            uint32_t enumValue = 0;
+            m_sample->getValue(path, enumValue);
+            const CORBA::TypeCode* enumTypeCode = path.getTypeCode();
             if (enumValue >= enumTypeCode->member_count())
             {
                 newValue = "***INVALID_ENUM_VALUE***\n";
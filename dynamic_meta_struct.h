@@ -3,6 +3,12 @@
 
 #include <dds/DCPS/FilterEvaluator.h> // For OpenDDS::DCPS::MetaStruct
 
+#include "member_path.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 class OpenDynamicData;
 
 
@@ -22,15 +28,34 @@ public:
 
     /**
      * @brief Constructor for the MetaStruct implementation of OpenDynamicData.
-     * @param[in] sample Create the MetaStruct for this sample.
+     * @param[in] typeCode Create the MetaStruct for samples of this type.
      */
-    DynamicMetaStruct(const std::shared_ptr<OpenDynamicData> sample);
+    DynamicMetaStruct(const CORBA::TypeCode* typeCode);
 
     /**
      * @brief Destructor for the MetaStruct implementation of OpenDynamicData.
      */
     ~DynamicMetaStruct();
 
+    /**
+     * @brief Point the MetaStruct at another sample of the same type.
+     * @remarks Member paths resolved for earlier samples are kept.
+     * @param[in] sample The sample to read member values from.
+     */
+    void setSample(const std::shared_ptr<OpenDynamicData> sample);
+
+    /**
+     * @brief Resolve every topic member referenced by a filter expression.
+     * @details Enum literals are quoted in the filter grammar, so every other
+     *          name has to be a topic member.
+     * @remarks String literals, parameters and SQL keywords are skipped. Call
+     *          before the MetaStruct is shared with the workers.
+     * @param[in] filter The SQL filter string.
+     * @param[out] unknownField The first name that isn't a topic member.
+     * @return True if every name was resolved; false otherwise.
+     */
+    bool bindFields(const std::string& filter, std::string& unknownField);
+
     /**
      * @brief This function does nothing, but is required by MetaStruct.
      */
@@ -109,8 +134,22 @@ public:
 
 private:
 
-    /// Stores the sample type information and values.
-    const std::shared_ptr<OpenDynamicData> m_sample;
+    /**
+     * @brief Read a member value of m_sample as a filter value.
+     * @param[in] path The member path.
+     * @return The member value.
+     */
+    template<class T>
+    OpenDDS::DCPS::Value readValue(const MemberPath& path) const;
+
+    /// The type definition pointer for the topic.
+    const CORBA::TypeCode* m_typeCode;
+
+    /// Stores the sample values.
+    std::shared_ptr<OpenDynamicData> m_sample;
+
+    /// Member paths by field name, resolved by bindFields().
+    std::unordered_map<std::string, MemberPath> m_paths;
 
 };
 
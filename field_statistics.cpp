@@ -0,0 +1,190 @@
+#include "field_statistics.h"
+#include "open_dynamic_data.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+//------------------------------------------------------------------------------
+FieldStatistics::FieldStatistics(const CORBA::TypeCode* typeCode) :
+                                 m_layout(SampleLayout::get(typeCode)),
+                                 m_count(0),
+                                 m_firstTime(0),
+                                 m_lastTime(0)
+{
+    if (m_layout)
+    {
+        addMembers(m_layout->root(), "");
+    }
+
+    m_values.resize(m_paths.size(), 0);
+    m_mean.resize(m_paths.size(), 0);
+    m_m2.resize(m_paths.size(), 0);
+    m_min.resize(m_paths.size(), 0);
+    m_max.resize(m_paths.size(), 0);
+    reset();
+}
+
+
+//------------------------------------------------------------------------------
+size_t FieldStatistics::size() const
+{
+    return m_paths.size();
+}
+
+
+//------------------------------------------------------------------------------
+int FieldStatistics::indexOf(const std::string& fullName) const
+{
+    const auto iter = m_indexes.find(fullName);
+    return iter != m_indexes.end() ? iter->second : -1;
+}
+
+
+//------------------------------------------------------------------------------
+void FieldStatistics::update(const OpenDynamicData& sample, const int64_t& receiveTime)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+
+    // Gather the members into a flat array first
+    const size_t count = m_paths.size();
+    double* values = m_values.data();
+    for (size_t i = 0; i < count; i++)
+    {
+        sample.getValue(m_paths[i], values[i]);
+    }
+
+    if (m_count == 0)
+    {
+        m_firstTime = receiveTime;
+    }
+    m_lastTime = receiveTime;
+    m_count++;
+
+    // Welford's update, one pass over the parallel arrays
+    const double scale = 1.0 / static_cast<double>(m_count);
+    double* mean = m_mean.data();
+    double* m2 = m_m2.data();
+    double* min = m_min.data();
+    double* max = m_max.data();
+    for (size_t i = 0; i < count; i++)
+    {
+        const double value = values[i];
+        const double delta = value - mean[i];
+        mean[i] += delta * scale;
+        m2[i] += delta * (value - mean[i]);
+        min[i] = std::min(min[i], value);
+        max[i] = std::max(max[i], value);
+    }
+
+} // End FieldStatistics::update
+
+
+//------------------------------------------------------------------------------
+void FieldStatistics::reset()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_count = 0;
+    m_firstTime = 0;
+    m_lastTime = 0;
+    std::fill(m_mean.begin(), m_mean.end(), 0.0);
+    std::fill(m_m2.begin(), m_m2.end(), 0.0);
+    std::fill(m_min.begin(), m_min.end(), std::numeric_limits<double>::infinity());
+    std::fill(m_max.begin(), m_max.end(), -std::numeric_limits<double>::infinity());
+}
+
+
+//------------------------------------------------------------------------------
+void FieldStatistics::getSnapshot(Snapshot& snapshot) const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    snapshot.count = m_count;
+    snapshot.min = m_min;
+    snapshot.max = m_max;
+    snapshot.mean = m_mean;
+
+    snapshot.rate = 0;
+    if (m_count > 1 && m_lastTime > m_firstTime)
+    {
+        snapshot.rate = static_cast<double>(m_count - 1) * 1e9 /
+                        static_cast<double>(m_lastTime - m_firstTime);
+    }
+
+    snapshot.stddev.resize(m_m2.size());
+    for (size_t i = 0; i < m_m2.size(); i++)
+    {
+        snapshot.stddev[i] = m_count > 1 ?
+            std::sqrt(m_m2[i] / static_cast<double>(m_count - 1)) : 0.0;
+    }
+
+} // End FieldStatistics::getSnapshot
+
+
+//------------------------------------------------------------------------------
+void FieldStatistics::addMembers(const SampleLayout::Node& node, const std::string& name)
+{
+    // The names match OpenDynamicData::getFullName(), where a struct name
+    // ends with '.'
+    switch (node.kind)
+    {
+    case CORBA::tk_struct:
+        for (const SampleLayout::Node& member : node.members)
+        {
+            addMembers(member, name + member.name +
+                       (member.kind == CORBA::tk_struct ? "." : ""));
+        }
+        break;
+
+    case CORBA::tk_array:
+    {
+        const SampleLayout::Node& element = node.members[0];
+        for (size_t i = 0; i < node.length; i++)
+        {
+            addMembers(element, name + "[" + std::to_string(i) + "]" +
+                       (element.kind == CORBA::tk_struct ? "." : ""));
+        }
+        break;
+    }
+
+    default:
+        if (isNumericKind(node.kind))
+        {
+            MemberPath path(m_layout, name);
+            if (path.isValid() && path.isFixed())
+            {
+                m_indexes[name] = static_cast<int>(m_paths.size());
+                m_paths.push_back(path);
+            }
+        }
+        break;
+    }
+
+} // End FieldStatistics::addMembers
+
+
+//------------------------------------------------------------------------------
+bool FieldStatistics::isNumericKind(const CORBA::TCKind kind)
+{
+    switch (kind)
+    {
+    case CORBA::tk_long:
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+    case CORBA::tk_ulong:
+    case CORBA::tk_float:
+    case CORBA::tk_double:
+    case CORBA::tk_boolean:
+    case CORBA::tk_octet:
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+/**
+ * @}
+ */
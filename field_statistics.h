@@ -0,0 +1,156 @@
+#ifndef __FIELD_STATISTICS_H__
+#define __FIELD_STATISTICS_H__
+
+#include "member_path.h"
+#include "sample_layout.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class OpenDynamicData;
+
+
+/**
+ * @brief Running statistics for the numeric members of a topic.
+ *
+ * @details Every numeric member at a fixed offset in the topic layout gets a
+ *          Welford accumulator for its mean and variance, plus its minimum
+ *          and maximum. The accumulators are kept as parallel arrays, one
+ *          entry per member. Each sample is first gathered into a flat array
+ *          of doubles, and the update is then one branch free loop over all
+ *          members, which the compiler can vectorize.
+ *
+ *          Members inside sequences are skipped, since their count changes
+ *          from sample to sample. Enums, chars and strings are skipped too.
+ */
+class FieldStatistics
+{
+public:
+
+    /**
+     * @brief A copy of the statistics for display.
+     */
+    struct Snapshot
+    {
+        /// The number of samples accumulated.
+        uint64_t count = 0;
+
+        /// The sample rate in Hz, from the receive times.
+        double rate = 0;
+
+        /// The smallest value of each member.
+        std::vector<double> min;
+
+        /// The largest value of each member.
+        std::vector<double> max;
+
+        /// The mean value of each member.
+        std::vector<double> mean;
+
+        /// The sample standard deviation of each member.
+        std::vector<double> stddev;
+    };
+
+    /**
+     * @brief Constructor for the field statistics.
+     * @param[in] typeCode The type definition pointer for the topic.
+     */
+    explicit FieldStatistics(const CORBA::TypeCode* typeCode);
+
+    /**
+     * @brief Get the number of members with statistics.
+     * @return The member count.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Find the statistics index of a member.
+     * @param[in] fullName The full member name, as from getFullName().
+     * @return The index or -1 if the member has no statistics.
+     */
+    int indexOf(const std::string& fullName) const;
+
+    /**
+     * @brief Add the member values of a sample.
+     * @remarks Thread safe. Called by TopicMonitor for every stored sample.
+     * @param[in] sample The top level sample.
+     * @param[in] receiveTime The receive timestamp in nanoseconds.
+     */
+    void update(const OpenDynamicData& sample, const int64_t& receiveTime);
+
+    /**
+     * @brief Forget all accumulated values.
+     * @remarks Thread safe.
+     */
+    void reset();
+
+    /**
+     * @brief Copy the current statistics.
+     * @remarks Thread safe.
+     * @param[out] snapshot Replaced with the current statistics.
+     */
+    void getSnapshot(Snapshot& snapshot) const;
+
+private:
+
+    /**
+     * @brief Recursively add the numeric members of a layout node.
+     * @param[in] node The layout of the member.
+     * @param[in] name The full name of the member.
+     */
+    void addMembers(const SampleLayout::Node& node, const std::string& name);
+
+    /**
+     * @brief Get whether a type kind gets statistics.
+     * @param[in] kind The type kind to check.
+     * @return True for numeric kinds.
+     */
+    static bool isNumericKind(const CORBA::TCKind kind);
+
+    /// The layout of the topic type.
+    std::shared_ptr<const SampleLayout> m_layout;
+
+    /// The resolved path of each member.
+    std::vector<MemberPath> m_paths;
+
+    /// The statistics index of each member name.
+    std::unordered_map<std::string, int> m_indexes;
+
+    /// The member values of the sample being added.
+    std::vector<double> m_values;
+
+    /// The number of samples accumulated.
+    uint64_t m_count;
+
+    /// The receive time of the first sample accumulated.
+    int64_t m_firstTime;
+
+    /// The receive time of the last sample accumulated.
+    int64_t m_lastTime;
+
+    /// The smallest value of each member.
+    std::vector<double> m_min;
+
+    /// The largest value of each member.
+    std::vector<double> m_max;
+
+    /// The running mean of each member.
+    std::vector<double> m_mean;
+
+    /// The running sum of squared differences from the mean of each member.
+    std::vector<double> m_m2;
+
+    /// Protects the accumulators.
+    mutable std::mutex m_mutex;
+
+}; // End class FieldStatistics
+
+#endif
+
+/**
+ * @}
+ */
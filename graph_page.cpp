@@ -1,5 +1,13 @@
 #include "graph_page.h"
+#include "config_reader.h"
 #include "dds_data.h"
+#include "plot_series.h"
+
+#include <QGLFormat>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 
 
 //------------------------------------------------------------------------------
@@ -11,9 +19,13 @@ GraphPage::GraphPage(QWidget* parent) :
     m_picker(NULL),
     m_marker(NULL),
     m_refreshTimer(this),
-    m_xCounter(0.0),
+    m_timeOrigin(0),
+    m_following(true),
     m_xMin(0.0),
-    m_xMax(0.0)
+    m_xMax(0.0),
+    m_directPainter(NULL),
+    m_fullRedraw(true),
+    m_paintedWidth(0)
 {
     setupUi(this);
 
@@ -24,13 +36,11 @@ GraphPage::GraphPage(QWidget* parent) :
     attachButton->hide();
     ejectButton->hide(); // Remove this line after attach/detach is ready
 
-    // Setup the initial x-axis data values;
-    for (int i = 0; i < MAX_HISTORY; i++)
-    {
-        m_xData[i] = MAX_HISTORY - i - 1;
-    }
-    m_xMin = m_xData[MAX_HISTORY - 1];
-    m_xMax = m_xData[MAX_HISTORY - m_propertiesUI->viewSpinBox->value()];
+    // The x values are seconds since the page was opened
+    m_timeOrigin = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    m_xMin = 0.0;
+    m_xMax = m_propertiesUI->viewSpinBox->value();
 
 
     //--------------------------------------------------------------------------
@@ -41,6 +51,26 @@ GraphPage::GraphPage(QWidget* parent) :
     grid->setPen(QColor(0, 0, 0, 50));
     grid->attach(qwtPlot);
 
+    // Incremental drawing is opt in. The GL canvas also runs on software
+    // renderers like llvmpipe, but fall back to the raster canvas without GL.
+    uint64_t glPlot = 0;
+    if (ConfigReader::readNumber("DDS_MONITOR_GL_PLOT", glPlot) && glPlot > 0)
+    {
+        if (QGLFormat::hasOpenGL())
+        {
+            QwtPlotGLCanvas* glCanvas = new QwtPlotGLCanvas();
+            glCanvas->setFrameStyle(QFrame::NoFrame);
+            qwtPlot->setCanvas(glCanvas);
+        }
+        else
+        {
+            std::cerr << "OpenGL is not available. Plotting without it."
+                      << std::endl;
+        }
+
+        m_directPainter = new QwtPlotDirectPainter(this);
+    }
+
     // Qt::WA_PaintOnScreen is only supported for X11, but leads
     // to substantial bugs with Qt 4.2.x/Windows
     #if QT_VERSION >= 0x040000
@@ -54,6 +84,7 @@ GraphPage::GraphPage(QWidget* parent) :
 
     // Create and set the custom label x-axis object
     m_xAxis = new TimeScaleDraw;
+    m_xAxis->setOrigin(m_timeOrigin);
     qwtPlot->setAxisScaleDraw(QwtPlot::xBottom, m_xAxis);
 
     // When the x-axis label is on the far right, we need to prevent the
@@ -156,7 +187,6 @@ void GraphPage::addVariable(const QString& topicName,
     }
 
     PlotData* newCurve = new PlotData;
-    double currentValue;
 
     variableCombo->addItem(variableName);
     m_propertiesUI->customXValueCombo->addItem(variableName);
@@ -174,21 +204,22 @@ void GraphPage::addVariable(const QString& topicName,
 
     newCurve->topicName = topicName;
     newCurve->variableName = variableName;
+    newCurve->memberPath = CommonData::resolveMember(topicName, variableName);
+    newCurve->history = CommonData::getHistory(topicName);
     newCurve->curve = new QwtPlotCurve(topicName + "." + variableName);
     newCurve->curve->attach(qwtPlot);
     newCurve->curve->setRenderHint(QwtPlotItem::RenderAntialiased);
 
-    // Fill the data array with the initial value
-    currentValue = CommonData::readValue(
-        newCurve->topicName, newCurve->variableName).toDouble();
+    // The curve reads the history in place and deletes it with itself
+    newCurve->series = new PlotSeries(MAX_HISTORY);
+    newCurve->curve->setData(newCurve->series);
 
-    for (int i = 0; i < MAX_HISTORY; i++)
-    {
-        newCurve->xData[i] = m_xCounter;
-        newCurve->yData[i] = currentValue;
-    }
+    // Start the history with the newest value, then take every new one
+    seedPlot(newCurve);
+    attachFeed(newCurve);
 
     m_plotData.append(newCurve);
+    m_fullRedraw = true;
 
 } // End GraphPage::addVariable
 
@@ -249,6 +280,7 @@ void GraphPage::graphAttributesChanged()
     }
 
 
+    m_fullRedraw = true;
     updateGraph();
     m_refreshTimer.setInterval(refreshRate);
 
@@ -278,140 +310,55 @@ void GraphPage::updateGraph()
         return;
     }
 
-    const int viewSize = m_propertiesUI->viewSpinBox->value();
     PlotData* plot = NULL;
-    m_xCounter += 1.0;
-
-
-    // Shift the x data back one array position
-    if (m_xData[0] < m_xCounter)
-    {
-        for (int c = MAX_HISTORY - 1; c > 0; c--)
-        {
-            m_xData[c] = m_xData[c - 1];
-        }
-        m_xData[0] = m_xCounter;
-    }
+    const PlotSeries* axisSeries = NULL;
 
 
     //--------------------------------------------------------------------------
-    // Setup the plot xaxis view
-    // Stretch the data to fit the view if the number of ticks is less than
-    // the view.
-    if (m_xCounter < viewSize)
-    {
-        m_xMin = m_xData[MAX_HISTORY - 1];
-        m_xMax = m_xData[MAX_HISTORY - (int)m_xCounter - 1];
-    }
-
-    // If we're at the far right of the plot, show the latest data
-    else if (m_xMax + 1.0 == m_xCounter)
-    {
-        m_xMin = m_xCounter - viewSize + 1.0;
-        m_xMax = m_xCounter;
-    }
-
-    // If we're at the end of the history and are scrolled to the far right,
-    // shift the min/max up
-    else if (m_xMin <= m_xData[MAX_HISTORY - 1] &&
-        m_xData[MAX_HISTORY - 1] != 0.0)
-    {
-        m_xMin = m_xData[MAX_HISTORY - 1];
-        m_xMax = m_xData[MAX_HISTORY - viewSize];
-    }
-
-    // If we are panned left or right, hold the position
-    else if (m_xMax + 1.5 < m_xCounter)
-    {
-        m_xMin = m_xMax - viewSize + 1.0;
-    }
-
-    // It should never get here, but if it does, just show the latest data.
-    else
-    {
-        m_xMin = m_xCounter - viewSize + 1.0;
-        m_xMax = m_xCounter;
-    }
-
-
-    // Update the x-axis label. If a custom x axis is enabled, the label will
-    // be set in the variable loop below.
-    if (m_propertiesUI->customXCheckBox->isChecked() == false)
-    {
-        m_xAxis->addLabel(m_xCounter, QTime::currentTime().toString());
-    }
-
-
-    //--------------------------------------------------------------------------
-    // Loop through each variable and attach the latest data
+    // Loop through each variable and append every value stored since the
+    // last tick
     for (int i = 0; i < m_plotData.count(); i++)
     {
-        int arrayStart = 0;
         plot = m_plotData.at(i);
         if (!plot)
         {
             continue;
         }
 
-        // If the latest data isn't valid, skip it
-        QVariant latestValue = CommonData::readValue(
-            plot->topicName, plot->variableName);
-        if (!latestValue.isValid())
+        // The type may not have been known when the variable was added
+        if (!plot->memberPath.isValid())
         {
-            continue;
-        }
-
-        // Shift the data back one position
-        for (int c = MAX_HISTORY - 1; c > 0; c--)
-        {
-            plot->xData[c] = plot->xData[c - 1];
-            plot->yData[c] = plot->yData[c - 1];
+            plot->memberPath = CommonData::resolveMember(
+                plot->topicName, plot->variableName);
+            if (plot->memberPath.isValid())
+            {
+                attachFeed(plot);
+            }
         }
 
-
-        // Get the starting axis array element
-        for (int c = 0; c < MAX_HISTORY; c++)
+        // Samples from several writers may arrive slightly out of time
+        // order. They're drawn at the newest time seen so far.
+        m_points.clear();
+        plot->feed->drain(m_points);
+        plot->history->touch();
+        for (const PlotPoint& point : m_points)
         {
-            if (plot->xData[c] == m_xMax)
+            double x = toX(point.time);
+            if (plot->series->count() > 0)
             {
-                arrayStart = c;
-                break;
+                x = std::max(x, plot->series->latest().x());
             }
+            plot->series->append(x, point.value);
         }
 
-        // Store the latest value
-        plot->xData[0] = m_xCounter;
-        plot->yData[0] = latestValue.toDouble();
+        plot->series->setBias(plot->biasScale, plot->biasShift);
 
 
-        // Apply the bias and populate the view arrays
-        for (int c = 0; c < viewSize; c++)
-        {
-            plot->xViewData[c] = plot->xData[c + arrayStart];
-            plot->yViewData[c] = plot->yData[c + arrayStart] *
-                plot->biasScale +
-                plot->biasShift;
-        }
-
-
-        // If this data has been marked as a custom x-axis, set the x-axis
-        // label to the value
+        // If this data has been marked as a custom x-axis, label the x-axis
+        // with its values
         if (plot->isAxisData == true)
         {
-            const double axisValue = plot->yData[0];
-
-            // If the value is a normalized time, show it as a time
-            if (m_propertiesUI->customXTimeCheckBox->isChecked() == true)
-            {
-                QTime timeValue(0, 0, 0, 0);
-                timeValue = timeValue.addSecs((int)axisValue);
-                m_xAxis->addLabel(m_xCounter, timeValue.toString());
-            }
-            else
-            {
-                m_xAxis->addLabel(m_xCounter, QString::number(axisValue));
-            }
-
+            axisSeries = plot->series;
             continue;
         }
 
@@ -430,18 +377,17 @@ void GraphPage::updateGraph()
 
         const QString newTitle =
             plot->topicName + "." + plot->variableName +
-            " [" + latestValue.toString() + "]";
+            " [" + QString::number(plot->series->latest().y()) + "]";
 
         plot->curve->setTitle(newTitle);
         plot->curve->setPen(plot->color);
-        plot->curve->setSamples(plot->xViewData,
-            plot->yViewData,
-            viewSize);
 
     } // End plot line loop
 
-    qwtPlot->setAxisScale(QwtPlot::xBottom, m_xMin, m_xMax);
-    qwtPlot->replot();
+    m_xAxis->setAxisSeries(axisSeries,
+        m_propertiesUI->customXTimeCheckBox->isChecked());
+
+    applyView();
 
 } // End GraphPage::updateGraph
 
@@ -493,52 +439,62 @@ void GraphPage::on_playPauseButton_clicked()
 //------------------------------------------------------------------------------
 void GraphPage::on_rewindButton_clicked()
 {
-    const int viewSize = m_propertiesUI->viewSpinBox->value();
+    const double viewSize = m_propertiesUI->viewSpinBox->value();
+    double oldest = 0.0;
+    double newest = 0.0;
+    if (!historyRange(oldest, newest))
+    {
+        return;
+    }
 
-    // Make sure we can pan to the left without going past 0
-    if (m_xMin - viewSize / 3 > m_xData[MAX_HISTORY - 1])
+    // Make sure we can pan to the left without going past the oldest data
+    m_following = false;
+    if (m_xMin - viewSize / 3 > oldest)
     {
         m_xMin -= viewSize / 3;
         m_xMax -= viewSize / 3;
     }
     else
     {
-        m_xMin = m_xData[MAX_HISTORY - 1];
-        m_xMax = m_xData[MAX_HISTORY - viewSize];
+        m_xMin = oldest;
+        m_xMax = oldest + viewSize;
     }
 
-    qwtPlot->replot();
+    applyView();
 }
 
 
 //------------------------------------------------------------------------------
 void GraphPage::on_forwardButton_clicked()
 {
-    const int viewSize = m_propertiesUI->viewSpinBox->value();
+    const double viewSize = m_propertiesUI->viewSpinBox->value();
+    double oldest = 0.0;
+    double newest = 0.0;
+    if (!historyRange(oldest, newest))
+    {
+        return;
+    }
 
-    // Make sure we can pan to the right without going past the max
-    if (m_xMax + viewSize / 3 < m_xData[0])
+    // Make sure we can pan to the right without going past the newest data
+    if (m_xMax + viewSize / 3 < newest)
     {
         m_xMin += viewSize / 3;
         m_xMax += viewSize / 3;
     }
     else
     {
-        m_xMin = m_xData[viewSize];
-        m_xMax = m_xData[0];
+        m_following = true;
     }
 
-    qwtPlot->replot();
+    applyView();
 }
 
 
 //------------------------------------------------------------------------------
 void GraphPage::on_frontButton_clicked()
 {
-    m_xMin = m_xData[m_propertiesUI->viewSpinBox->value()];
-    m_xMax = m_xData[0];
-
-    qwtPlot->replot();
+    m_following = true;
+    applyView();
 }
 
 
@@ -546,26 +502,11 @@ void GraphPage::on_frontButton_clicked()
 void GraphPage::on_refreshButton_clicked()
 {
     PlotData* plot = NULL;
-    double currentValue;
-
-    // Setup the initial x-axis data values;
-    for (int i = 0; i < MAX_HISTORY; i++)
-    {
-        m_xData[i] = MAX_HISTORY - i - 1;
-    }
 
-    m_xCounter = 0.0;
-    m_xMin = m_xData[MAX_HISTORY - 1];
-    m_xMax = m_xData[MAX_HISTORY - m_propertiesUI->viewSpinBox->value()];
+    // Follow the newest data again
+    m_following = true;
     m_marker->detach();
 
-    // Clear out the label history
-    while (m_xAxis != NULL && !m_xAxis->m_xLabels.isEmpty())
-    {
-        delete m_xAxis->m_xLabels.back();
-        m_xAxis->m_xLabels.pop_back();
-    }
-
 
     // Reset the data for each of the plots
     for (int i = 0; i < m_plotData.count(); i++)
@@ -576,24 +517,15 @@ void GraphPage::on_refreshButton_clicked()
             continue;
         }
 
-        // Flush all the data back to 0
-        memset(plot->xData, 0, sizeof(plot->xData));
-        memset(plot->yData, 0, sizeof(plot->yData));
-        memset(plot->xViewData, 0, sizeof(plot->xViewData));
-        memset(plot->yViewData, 0, sizeof(plot->yViewData));
-
-        // Fill the data array with the current value
-        currentValue = CommonData::readValue(
-            plot->topicName, plot->variableName).toDouble();
-
-        for (int j = 0; j < MAX_HISTORY; j++)
-        {
-            plot->xData[j] = m_xCounter;
-            plot->yData[j] = currentValue;
-        }
+        // Drop the buffered values and restart with the current one
+        m_points.clear();
+        plot->feed->drain(m_points);
+        plot->series->clear();
+        seedPlot(plot);
 
     } // End plot loop
 
+    m_fullRedraw = true;
     updateGraph();
 
 } // End GraphPage::on_refreshButton_clicked
@@ -621,6 +553,7 @@ void GraphPage::on_scaleButton_clicked()
     if (ok)
     {
         plotData->biasScale = value;
+        m_fullRedraw = true;
         updateGraph();
     }
 
@@ -649,6 +582,7 @@ void GraphPage::on_shiftButton_clicked()
     if (ok)
     {
         plotData->biasShift = value;
+        m_fullRedraw = true;
         updateGraph();
     }
 
@@ -725,6 +659,7 @@ void GraphPage::on_trashButton_clicked()
         delete plot;
 
         plot = NULL;
+        m_fullRedraw = true;
         break;
     }
 
@@ -782,6 +717,225 @@ void GraphPage::on_attachButton_clicked()
 }
 
 
+//------------------------------------------------------------------------------
+double GraphPage::toX(const int64_t& time) const
+{
+    return static_cast<double>(time - m_timeOrigin) / 1e9;
+}
+
+
+//------------------------------------------------------------------------------
+void GraphPage::attachFeed(PlotData* plot)
+{
+    if (plot->feed)
+    {
+        plot->history->removePlotFeed(plot->feed);
+    }
+
+    plot->feed = std::make_shared<PlotFeed>(plot->memberPath);
+    plot->history->addPlotFeed(plot->feed);
+}
+
+
+//------------------------------------------------------------------------------
+void GraphPage::seedPlot(PlotData* plot)
+{
+    const uint64_t latest = plot->history->latestSequence();
+    const QList<SampleInfo> info = plot->history->getSampleInfo(latest, 1);
+    if (info.isEmpty())
+    {
+        return;
+    }
+
+    const QVariant value = CommonData::readValue(
+        plot->history->getSampleBySequence(latest), plot->memberPath);
+    if (!value.isValid())
+    {
+        return;
+    }
+
+    const SampleInfo& newest = info.front();
+    plot->series->append(
+        toX(newest.sourceTime > 0 ? newest.sourceTime : newest.receiveTime),
+        value.toDouble());
+}
+
+
+//------------------------------------------------------------------------------
+bool GraphPage::historyRange(double& oldest, double& newest) const
+{
+    bool found = false;
+    for (const PlotData* plot : m_plotData)
+    {
+        if (!plot || plot->series->count() == 0)
+        {
+            continue;
+        }
+
+        const double first = plot->series->oldest().x();
+        const double last = plot->series->latest().x();
+        oldest = found ? std::min(oldest, first) : first;
+        newest = found ? std::max(newest, last) : last;
+        found = true;
+    }
+
+    return found;
+}
+
+
+//------------------------------------------------------------------------------
+void GraphPage::applyView()
+{
+    const double viewSize = m_propertiesUI->viewSpinBox->value();
+    const double previousMin = m_xMin;
+    const double previousMax = m_xMax;
+    double oldest = 0.0;
+    double newest = 0.0;
+
+    if (historyRange(oldest, newest))
+    {
+        // Fill the view from the left until there's more data than fits
+        if (m_following && newest - oldest < viewSize)
+        {
+            m_xMin = oldest;
+            m_xMax = oldest + viewSize;
+        }
+
+        // When drawing incrementally, only move the view once the data runs
+        // past it. Leave two thirds of it for new data, so most updates only
+        // draw the new segments.
+        else if (m_following && m_directPainter)
+        {
+            if (newest > m_xMax || newest < m_xMax - viewSize)
+            {
+                m_xMin = newest - viewSize / 3;
+                m_xMax = m_xMin + viewSize;
+            }
+            else
+            {
+                m_xMin = m_xMax - viewSize;
+            }
+        }
+
+        // Show the latest data
+        else if (m_following)
+        {
+            m_xMin = newest - viewSize;
+            m_xMax = newest;
+        }
+
+        // If the history ran out from under a panned view, move the view up
+        else if (m_xMax - viewSize < oldest)
+        {
+            m_xMin = oldest;
+            m_xMax = oldest + viewSize;
+        }
+
+        // If we are panned left or right, hold the position
+        else
+        {
+            m_xMin = m_xMax - viewSize;
+        }
+    }
+
+    // Long windows are decimated to the pixel columns of the canvas
+    const int columns = qwtPlot->canvas()->width();
+    for (PlotData* plot : m_plotData)
+    {
+        if (plot)
+        {
+            plot->series->setResolution(columns);
+            plot->series->setWindow(m_xMin, m_xMax);
+        }
+    }
+
+    // Without a change to the view, only the new points have to be drawn
+    if (m_directPainter && !m_fullRedraw && columns == m_paintedWidth &&
+        m_xMin == previousMin && m_xMax == previousMax && drawNewSegments())
+    {
+        return;
+    }
+
+    m_xAxis->refreshLabels();
+    qwtPlot->setAxisScale(QwtPlot::xBottom, m_xMin, m_xMax);
+    qwtPlot->replot();
+
+    for (PlotData* plot : m_plotData)
+    {
+        if (plot)
+        {
+            plot->painted = plot->series->size();
+        }
+    }
+    m_fullRedraw = false;
+    m_paintedWidth = columns;
+
+} // End GraphPage::applyView
+
+
+//------------------------------------------------------------------------------
+bool GraphPage::drawNewSegments()
+{
+    const QwtScaleDiv& yScale = qwtPlot->axisScaleDiv(QwtPlot::yLeft);
+    const bool autoScaleY = qwtPlot->axisAutoScale(QwtPlot::yLeft);
+
+    // Check every curve before drawing any of them
+    for (const PlotData* plot : m_plotData)
+    {
+        if (!plot)
+        {
+            continue;
+        }
+
+        // The custom x-axis labels change with the axis variable
+        if (plot->isAxisData)
+        {
+            return false;
+        }
+
+        // The served points were replaced, not extended
+        const size_t count = plot->series->size();
+        if (plot->painted > 0 && plot->series->stableCount() == 0)
+        {
+            return false;
+        }
+
+        // A new extreme rescales an automatic y-axis
+        if (autoScaleY && count > 0)
+        {
+            const QRectF bounds = plot->series->boundingRect();
+            if (bounds.top() < yScale.lowerBound() ||
+                bounds.bottom() > yScale.upperBound())
+            {
+                return false;
+            }
+        }
+    }
+
+    // Redraw from the last unchanged point, so the new segments connect
+    for (PlotData* plot : m_plotData)
+    {
+        if (!plot)
+        {
+            continue;
+        }
+
+        const size_t stable = plot->series->stableCount();
+        const size_t count = plot->series->size();
+        const size_t from = stable > 0 ? stable - 1 : 0;
+        if (count > from + 1)
+        {
+            m_directPainter->drawSeries(plot->curve,
+                static_cast<int>(from), static_cast<int>(count - 1));
+        }
+        plot->painted = count;
+    }
+
+    return true;
+
+} // End GraphPage::drawNewSegments
+
+
 //------------------------------------------------------------------------------
 GraphPage::PlotData* GraphPage::getPlot(const QString& variableName)
 {
@@ -806,48 +960,70 @@ GraphPage::PlotData* GraphPage::getPlot(const QString& variableName)
 }
 
 
+//------------------------------------------------------------------------------
+GraphPage::TimeScaleDraw::TimeScaleDraw() :
+    m_origin(0),
+    m_axisSeries(NULL),
+    m_axisIsTime(false)
+{}
+
+
 //------------------------------------------------------------------------------
 GraphPage::TimeScaleDraw::~TimeScaleDraw()
 {}
 
 
 //------------------------------------------------------------------------------
-void GraphPage::TimeScaleDraw::addLabel(const double& value,
-                                        const QString& label)
+void GraphPage::TimeScaleDraw::setOrigin(const int64_t& origin)
 {
-    // Make sure we don't have too many x-labels
-    while (m_xLabels.count() > MAX_HISTORY)
-    {
-        delete m_xLabels.front();
-        m_xLabels.pop_front();
-    }
+    m_origin = origin;
+}
 
-    QPair<double, QString>* labelPair = new QPair<double, QString>;
 
-    labelPair->first = value;
-    labelPair->second = label;
+//------------------------------------------------------------------------------
+void GraphPage::TimeScaleDraw::setAxisSeries(const PlotSeries* series,
+                                             const bool isTime)
+{
+    m_axisSeries = series;
+    m_axisIsTime = isTime;
+}
+
 
-    m_xLabels.push_back(labelPair);
+//------------------------------------------------------------------------------
+void GraphPage::TimeScaleDraw::refreshLabels()
+{
+    invalidateCache();
 }
 
 
 //------------------------------------------------------------------------------
 QwtText GraphPage::TimeScaleDraw::label(double value) const
 {
-    for (int i = 0; i < m_xLabels.count(); i++)
+    // Label with the custom x-axis variable at this time
+    if (m_axisSeries)
     {
-        if (!m_xLabels.at(i))
+        if (m_axisSeries->count() == 0 || value < m_axisSeries->oldest().x())
         {
-            continue;
+            return QwtText("");
         }
 
-        if (m_xLabels.at(i)->first == value)
+        const double axisValue = m_axisSeries->valueAt(value);
+
+        // If the value is a normalized time, show it as a time
+        if (m_axisIsTime)
         {
-            return m_xLabels.at(i)->second;
+            QTime timeValue(0, 0, 0, 0);
+            timeValue = timeValue.addSecs((int)axisValue);
+            return timeValue.toString();
         }
+
+        return QString::number(axisValue);
     }
 
-    return QwtText("");
+    // Only show milliseconds when the tick isn't on a whole second
+    const qint64 msecs = m_origin / 1000000 + qRound64(value * 1000.0);
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(msecs);
+    return time.toString(msecs % 1000 ? "hh:mm:ss.zzz" : "hh:mm:ss");
 }
 
 
@@ -859,11 +1035,8 @@ GraphPage::PlotData::PlotData()
     biasScale = 1.0;
     biasShift = 0.0;
     curve = NULL;
-
-    memset(xData, 0, sizeof(xData));
-    memset(yData, 0, sizeof(yData));
-    memset(xViewData, 0, sizeof(xViewData));
-    memset(yViewData, 0, sizeof(yViewData));
+    series = NULL;
+    painted = 0;
 
     isAxisData = false;
 }
@@ -872,7 +1045,14 @@ GraphPage::PlotData::PlotData()
 //------------------------------------------------------------------------------
 GraphPage::PlotData::~PlotData()
 {
+    // Stop the producer before the feed goes away
+    if (history && feed)
+    {
+        history->removePlotFeed(feed);
+    }
+
     curve = NULL;
+    series = NULL;
 }
 
 
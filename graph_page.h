@@ -2,6 +2,9 @@
 #define DEF_VARIABLE_GRAPH_WIDGET
 
 #include "first_define.h"
+#include "member_path.h"
+#include "plot_feed.h"
+#include "topic_history.h"
 
 #define _USE_MATH_DEFINES 1
 #include <cmath>
@@ -12,6 +15,7 @@
 #include <QInputDialog>
 #include <QFileDialog>
 #include <QDataStream>
+#include <QDateTime>
 #include <QDropEvent>
 #include <QByteArray>
 #include <QPrinter>
@@ -31,6 +35,8 @@
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 #endif
 #include <qwt_picker_machine.h>
+#include <qwt_plot_directpainter.h>
+#include <qwt_plot_glcanvas.h>
 #include <qwt_plot_renderer.h>
 #include <qwt_scale_widget.h>
 #include <qwt_scale_engine.h>
@@ -52,6 +58,8 @@
 #include "ui_graph_page.h"
 #include "ui_graph_properties.h"
 
+class PlotSeries;
+
 
 //------------------------------------------------------------------------------
 // class GraphPage
@@ -60,6 +68,8 @@
  * @brief The variable graphing widget class.
  *
  * @remarks This class uses the QWT graphing library to display the plot.
+ * @remarks Setting DDS_MONITOR_GL_PLOT=1 draws the plot with OpenGL and only
+ *          draws the new segments of each curve while following live data.
  * @remarks The icons on the bottom of the page are from
  *          http://www.axialis.com/free/icons.
  *
@@ -185,8 +195,8 @@ signals:
 
 private:
 
-    /// The maximum number of data points for a variable.
-    static const int MAX_HISTORY = 4096;
+    /// The maximum number of raw data points for a variable. Older points are kept as summaries.
+    static const int MAX_HISTORY = 262144;
 
     /// The maximum number of variable lines to plot.
     static const int MAX_LINES = 6;
@@ -194,23 +204,38 @@ private:
     /**
      * @brief Axis class that GraphPage uses to display the custom labels
      *        along the xaxis.
+     *
+     * @details The x values are seconds since the origin. They are shown as
+     *          the time of day, or as the value of the custom x-axis variable
+     *          at that time.
      */
     class TimeScaleDraw : public QwtScaleDraw
     {
     public:
 
         ///  Contructor for the custom x-axis object.
-        TimeScaleDraw() {}
+        TimeScaleDraw();
 
         ///  Destructor for the custom x-axis object.
         ~TimeScaleDraw();
 
         /**
-         * @brief Add a label value to the xaxis.
-         * @param[in] value Set the label for this value.
-         * @param[in] label The label to display for the given value.
+         * @brief Set the time of x value 0.
+         * @param[in] origin The time in nanoseconds since the epoch.
+         */
+        void setOrigin(const int64_t& origin);
+
+        /**
+         * @brief Label the axis with the values of a variable.
+         * @param[in] series The history of the variable or NULL for times.
+         * @param[in] isTime True if the values are a normalized time.
+         */
+        void setAxisSeries(const PlotSeries* series, const bool isTime);
+
+        /**
+         * @brief Drop the cached labels, so they're formatted again.
          */
-        void addLabel(const double& value, const QString& label);
+        void refreshLabels();
 
         /**
          * @brief Return the label string for the passed in value.
@@ -220,11 +245,16 @@ private:
          */
         QwtText label(double value) const;
 
-        /**
-         * @brief Stores the xaxis label history.
-         * @remarks The array size has a limit of GraphPage::MAX_HISTORY
-         */
-        QList<QPair<double, QString> *> m_xLabels;
+    private:
+
+        /// The time of x value 0 in nanoseconds since the epoch.
+        int64_t m_origin;
+
+        /// The history of the custom x-axis variable or NULL.
+        const PlotSeries* m_axisSeries;
+
+        /// True if the custom x-axis variable is a normalized time.
+        bool m_axisIsTime;
 
     }; // End TimeScaleDraw
 
@@ -252,29 +282,70 @@ private:
         /// The DDS topic member name.
         QString variableName;
 
+        /// The resolved path of the topic member.
+        MemberPath memberPath;
+
+        /// The sample history of the topic.
+        std::shared_ptr<TopicHistory> history;
+
+        /// Receives every stored value of the variable.
+        std::shared_ptr<PlotFeed> feed;
+
         /// The y-axis scaler value.
         double biasScale;
 
         /// The y-axis shift value.
         double biasShift;
 
-        /// The x-axis history.
-        double xData[MAX_HISTORY];
+        /// The x-axis and y-axis history, owned by the curve.
+        PlotSeries* series;
 
-        /// The y-axis history.
-        double yData[MAX_HISTORY];
-
-        /// The x-axis data array that's displayed on the plot.
-        double xViewData[MAX_HISTORY];
-
-        /// The y-axis data array with the bias applied.
-        double yViewData[MAX_HISTORY];
+        /// The number of served points drawn on the canvas.
+        size_t painted;
 
         /// Flag set to true when this data is used as the x-axis.
         bool isAxisData;
     };
 
 
+    /**
+     * @brief Convert a timestamp to an x value.
+     * @param[in] time The time in nanoseconds since the epoch.
+     * @return The x value in seconds since m_timeOrigin.
+     */
+    double toX(const int64_t& time) const;
+
+    /**
+     * @brief Feed the stored values of a variable to its plot.
+     * @param[in] plot The plot to feed. Any previous feed is removed.
+     */
+    void attachFeed(PlotData* plot);
+
+    /**
+     * @brief Start the history of a plot with the newest stored value.
+     * @param[in] plot The plot to start.
+     */
+    void seedPlot(PlotData* plot);
+
+    /**
+     * @brief Get the x range of the plotted histories.
+     * @param[out] oldest The x value of the oldest point.
+     * @param[out] newest The x value of the newest point.
+     * @return False if there are no points.
+     */
+    bool historyRange(double& oldest, double& newest) const;
+
+    /**
+     * @brief Fit the view to the histories and redraw the plot.
+     */
+    void applyView();
+
+    /**
+     * @brief Draw only the points added to the curves since the last draw.
+     * @return False if the plot needs a full redraw instead.
+     */
+    bool drawNewSegments();
+
     /**
      * @brief Return the plot with the passed in name.
      * @param[in] variableName The full VTS variable name of the variable.
@@ -303,11 +374,11 @@ private:
     /// Redraw the graph when this timer expires.
     QTimer m_refreshTimer;
 
-    /// Stores the x-axis data.
-    double m_xData[MAX_HISTORY];
+    /// The time of x value 0 in nanoseconds since the epoch.
+    int64_t m_timeOrigin;
 
-    /// Counts the number of times the plot has been drawn. Used for x-axis.
-    double m_xCounter;
+    /// True if the view follows the newest data.
+    bool m_following;
 
     /// Stores the lowest x value to display on the x-axis.
     double m_xMin;
@@ -315,6 +386,18 @@ private:
     /// Stores the highest x value to display on the x-axis.
     double m_xMax;
 
+    /// The points drained from a feed, reused across plots.
+    std::vector<PlotPoint> m_points;
+
+    /// Draws new curve segments without a replot or NULL to always replot.
+    QwtPlotDirectPainter* m_directPainter;
+
+    /// True if the next update has to replot everything.
+    bool m_fullRedraw;
+
+    /// The canvas width of the last full redraw.
+    int m_paintedWidth;
+
 }; // End GraphPage
 
 #endif
@@ -0,0 +1,197 @@
+#include "history_budget.h"
+#include "config_reader.h"
+#include "topic_history.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+
+//------------------------------------------------------------------------------
+HistoryBudget::HistoryBudget(const uint64_t limit,
+                             const size_t defaultMaxSamples,
+                             const int64_t defaultMaxAge) :
+                             m_limit(limit),
+                             m_used(0),
+                             m_evicted(0),
+                             m_defaultMaxSamples(std::max<size_t>(defaultMaxSamples, 1)),
+                             m_defaultMaxAge(std::max<int64_t>(defaultMaxAge, 0))
+{}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<HistoryBudget> HistoryBudget::createFromEnvironment()
+{
+    uint64_t limit = DEFAULT_LIMIT;
+    size_t maxSamples = 500;
+    int64_t maxAge = 0;
+
+    // 0 turns the budget off
+    uint64_t budgetMiB = 0;
+    if (ConfigReader::readNumber("DDS_MONITOR_MEMORY_BUDGET", budgetMiB))
+    {
+        // Anything larger wraps around when converted to bytes
+        if (budgetMiB <= (UINT64_MAX >> 20))
+        {
+            limit = budgetMiB * 1024 * 1024;
+        }
+        else
+        {
+            ConfigReader::reportInvalid("DDS_MONITOR_MEMORY_BUDGET", std::to_string(budgetMiB));
+        }
+    }
+
+    uint64_t depth = 0;
+    if (ConfigReader::readNumber("DDS_MONITOR_HISTORY_DEPTH", depth) && depth > 0)
+    {
+        maxSamples = static_cast<size_t>(depth);
+    }
+
+    double window = 0;
+    if (ConfigReader::readDecimal("DDS_MONITOR_HISTORY_WINDOW", window))
+    {
+        maxAge = static_cast<int64_t>(window * 1e9);
+    }
+
+    return std::make_shared<HistoryBudget>(limit, maxSamples, maxAge);
+
+} // End HistoryBudget::createFromEnvironment
+
+
+//------------------------------------------------------------------------------
+void HistoryBudget::addHistory(const std::shared_ptr<TopicHistory>& history)
+{
+    std::lock_guard<std::mutex> locker(m_historyMutex);
+    m_histories.push_back(history);
+}
+
+
+//------------------------------------------------------------------------------
+bool HistoryBudget::charge(const uint64_t bytes)
+{
+    const uint64_t used = m_used.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    const uint64_t limit = m_limit.load(std::memory_order_relaxed);
+    return limit > 0 && used > limit;
+}
+
+
+//------------------------------------------------------------------------------
+void HistoryBudget::credit(const uint64_t bytes)
+{
+    m_used.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+
+//------------------------------------------------------------------------------
+void HistoryBudget::enforce()
+{
+    std::unique_lock<std::mutex> enforcing(m_enforceMutex, std::try_to_lock);
+    if (!enforcing.owns_lock())
+    {
+        return;
+    }
+
+    const uint64_t limit = m_limit;
+    if (limit == 0 || m_used <= limit)
+    {
+        return;
+    }
+
+    // Evict a little extra, so we don't come back here on every sample
+    const uint64_t target = limit - limit / 10;
+
+    std::vector<std::shared_ptr<TopicHistory>> histories;
+    {
+        std::lock_guard<std::mutex> locker(m_historyMutex);
+        histories.reserve(m_histories.size());
+        for (size_t i = 0; i < m_histories.size(); )
+        {
+            std::shared_ptr<TopicHistory> history = m_histories[i].lock();
+            if (!history)
+            {
+                m_histories[i] = m_histories.back();
+                m_histories.pop_back();
+                continue;
+            }
+
+            histories.push_back(std::move(history));
+            i++;
+        }
+    }
+
+    // The least recently viewed topics give up their samples first
+    std::vector<std::pair<int64_t, TopicHistory*>> order;
+    order.reserve(histories.size());
+    for (const std::shared_ptr<TopicHistory>& history : histories)
+    {
+        order.emplace_back(history->lastAccess(), history.get());
+    }
+    std::sort(order.begin(), order.end());
+
+    for (const std::pair<int64_t, TopicHistory*>& entry : order)
+    {
+        const uint64_t used = m_used;
+        if (used <= target)
+        {
+            break;
+        }
+
+        entry.second->evictBytes(used - target);
+    }
+
+} // End HistoryBudget::enforce
+
+
+//------------------------------------------------------------------------------
+void HistoryBudget::setLimit(const uint64_t limit)
+{
+    m_limit = limit;
+    enforce();
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t HistoryBudget::limit() const
+{
+    return m_limit;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t HistoryBudget::usedBytes() const
+{
+    return m_used;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t HistoryBudget::evictedCount() const
+{
+    return m_evicted;
+}
+
+
+//------------------------------------------------------------------------------
+void HistoryBudget::addEvicted(const uint64_t count)
+{
+    m_evicted += count;
+}
+
+
+//------------------------------------------------------------------------------
+size_t HistoryBudget::defaultMaxSamples() const
+{
+    return m_defaultMaxSamples;
+}
+
+
+//------------------------------------------------------------------------------
+int64_t HistoryBudget::defaultMaxAge() const
+{
+    return m_defaultMaxAge;
+}
+
+
+/**
+ * @}
+ */
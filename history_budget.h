@@ -0,0 +1,150 @@
+#ifndef __HISTORY_BUDGET_H__
+#define __HISTORY_BUDGET_H__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TopicHistory;
+
+
+/**
+ * @brief The process wide memory budget shared by all topic histories.
+ *
+ * @details Each history charges the bytes of the samples it stores and
+ *          credits them back on eviction. When the total goes over the limit
+ *          the storing thread evicts the oldest samples of the least recently
+ *          viewed topics until the total is back under the low water mark,
+ *          so topics on screen keep their history longest.
+ *
+ *          The budget also holds the default depth of new topic histories.
+ */
+class HistoryBudget
+{
+public:
+
+    /**
+     * @brief Constructor for the history budget.
+     * @param[in] limit The byte limit for all histories. 0 is unlimited.
+     * @param[in] defaultMaxSamples The sample count of new histories.
+     * @param[in] defaultMaxAge The time window of new histories in
+     *            nanoseconds or 0 for none.
+     */
+    HistoryBudget(const uint64_t limit,
+                  const size_t defaultMaxSamples,
+                  const int64_t defaultMaxAge);
+
+    /**
+     * @brief Create the budget from the environment settings.
+     * @details $DDS_MONITOR_MEMORY_BUDGET sets the limit in MiB,
+     *          $DDS_MONITOR_HISTORY_DEPTH the default sample count and
+     *          $DDS_MONITOR_HISTORY_WINDOW the default time window in seconds.
+     * @return The new budget.
+     */
+    static std::shared_ptr<HistoryBudget> createFromEnvironment();
+
+    /**
+     * @brief Track a new topic history for eviction.
+     * @param[in] history The topic history.
+     */
+    void addHistory(const std::shared_ptr<TopicHistory>& history);
+
+    /**
+     * @brief Add stored bytes to the total.
+     * @param[in] bytes The number of bytes.
+     * @return True if the total is now over the limit.
+     */
+    bool charge(const uint64_t bytes);
+
+    /**
+     * @brief Remove evicted bytes from the total.
+     * @param[in] bytes The number of bytes.
+     */
+    void credit(const uint64_t bytes);
+
+    /**
+     * @brief Evict samples until the total is under the low water mark.
+     * @remarks Only one thread enforces at a time; others return at once.
+     */
+    void enforce();
+
+    /**
+     * @brief Change the byte limit.
+     * @param[in] limit The byte limit for all histories. 0 is unlimited.
+     */
+    void setLimit(const uint64_t limit);
+
+    /**
+     * @brief Get the byte limit.
+     * @return The byte limit or 0 if unlimited.
+     */
+    uint64_t limit() const;
+
+    /**
+     * @brief Get the bytes held by all histories.
+     * @return The total in bytes.
+     */
+    uint64_t usedBytes() const;
+
+    /**
+     * @brief Get the number of samples evicted to stay within the limit.
+     * @return The eviction count.
+     */
+    uint64_t evictedCount() const;
+
+    /**
+     * @brief Count samples evicted to stay within the limit.
+     * @param[in] count The number of samples.
+     */
+    void addEvicted(const uint64_t count);
+
+    /**
+     * @brief Get the sample count of new histories.
+     * @return The default sample count.
+     */
+    size_t defaultMaxSamples() const;
+
+    /**
+     * @brief Get the time window of new histories.
+     * @return The default time window in nanoseconds or 0 for none.
+     */
+    int64_t defaultMaxAge() const;
+
+    /// The default byte limit for all histories (512 MiB).
+    static const uint64_t DEFAULT_LIMIT = 512ull * 1024 * 1024;
+
+private:
+
+    /// The byte limit or 0 if unlimited.
+    std::atomic<uint64_t> m_limit;
+
+    /// The bytes held by all histories.
+    std::atomic<uint64_t> m_used;
+
+    /// The number of samples evicted to stay within the limit.
+    std::atomic<uint64_t> m_evicted;
+
+    /// The sample count of new histories.
+    const size_t m_defaultMaxSamples;
+
+    /// The time window of new histories in nanoseconds.
+    const int64_t m_defaultMaxAge;
+
+    /// The tracked histories.
+    std::vector<std::weak_ptr<TopicHistory>> m_histories;
+
+    /// Protects m_histories.
+    std::mutex m_historyMutex;
+
+    /// Held by the thread that's currently enforcing the limit.
+    std::mutex m_enforceMutex;
+
+}; // End class HistoryBudget
+
+#endif
+
+/**
+ * @}
+ */
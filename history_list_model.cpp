@@ -0,0 +1,186 @@
+#include "history_list_model.h"
+#include "dds_data.h"
+
+#include <algorithm>
+
+
+//------------------------------------------------------------------------------
+HistoryListModel::HistoryListModel(const std::shared_ptr<TopicHistory>& history,
+                                   const int pageSize,
+                                   QObject* parent) :
+                                   QAbstractListModel(parent),
+                                   m_history(history),
+                                   m_pageSize(std::max(pageSize, 1)),
+                                   m_anchor(0),
+                                   m_writer(0),
+                                   m_changeCount(0)
+{
+    reload(m_history->latestSequence());
+}
+
+
+//------------------------------------------------------------------------------
+int HistoryListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+
+    return static_cast<int>(m_rows.size());
+}
+
+
+//------------------------------------------------------------------------------
+QVariant HistoryListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size()))
+    {
+        return QVariant();
+    }
+
+    const SampleInfo& info = m_rows[index.row()];
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return CommonData::formatTime(info.sourceTime);
+    case SEQUENCE_ROLE:
+        return static_cast<qulonglong>(info.sequence);
+    default:
+        return QVariant();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void HistoryListModel::refresh()
+{
+    const uint64_t changeCount = m_history->changeCount();
+    if (changeCount == m_changeCount)
+    {
+        return;
+    }
+    m_changeCount = changeCount;
+
+    // The oldest rows go first when their samples are evicted
+    const uint64_t oldest = m_history->oldestSequence();
+    size_t keep = m_rows.size();
+    while (keep > 0 && m_rows[keep - 1].sequence < oldest)
+    {
+        keep--;
+    }
+    if (keep < m_rows.size())
+    {
+        beginRemoveRows(QModelIndex(), static_cast<int>(keep), static_cast<int>(m_rows.size()) - 1);
+        m_rows.erase(m_rows.begin() + keep, m_rows.end());
+        endRemoveRows();
+    }
+
+    // A page of older samples doesn't grow
+    if (m_anchor != 0)
+    {
+        return;
+    }
+
+    const uint64_t latest = m_history->latestSequence();
+    const uint64_t newest = m_rows.empty() ? 0 : m_rows.front().sequence;
+    if (latest <= newest)
+    {
+        return;
+    }
+
+    // If more arrived than fit on the page, nothing on it would be kept
+    if (latest - newest >= static_cast<uint64_t>(m_pageSize))
+    {
+        reload(latest);
+        return;
+    }
+
+    // Only read the samples stored since the last refresh
+    const QList<SampleInfo> added =
+        m_history->getSampleInfo(latest, static_cast<size_t>(latest - newest), m_writer);
+    int count = 0;
+    while (count < added.size() && added.at(count).sequence > newest)
+    {
+        count++;
+    }
+
+    if (count > 0)
+    {
+        beginInsertRows(QModelIndex(), 0, count - 1);
+        for (int i = count - 1; i >= 0; i--)
+        {
+            m_rows.push_front(added.at(i));
+        }
+        endInsertRows();
+    }
+
+    // Push the oldest rows off the end of the page
+    if (m_rows.size() > static_cast<size_t>(m_pageSize))
+    {
+        beginRemoveRows(QModelIndex(), m_pageSize, static_cast<int>(m_rows.size()) - 1);
+        m_rows.erase(m_rows.begin() + m_pageSize, m_rows.end());
+        endRemoveRows();
+    }
+
+} // End HistoryListModel::refresh
+
+
+//------------------------------------------------------------------------------
+void HistoryListModel::setAnchor(const uint64_t sequence)
+{
+    m_anchor = sequence;
+    reload(m_anchor ? m_anchor : m_history->latestSequence());
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t HistoryListModel::anchor() const
+{
+    return m_anchor;
+}
+
+
+//------------------------------------------------------------------------------
+void HistoryListModel::setWriter(const uint32_t writer)
+{
+    m_writer = writer;
+    reload(m_anchor ? m_anchor : m_history->latestSequence());
+}
+
+
+//------------------------------------------------------------------------------
+uint32_t HistoryListModel::writer() const
+{
+    return m_writer;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t HistoryListModel::sequence(const int row) const
+{
+    if (row < 0 || row >= static_cast<int>(m_rows.size()))
+    {
+        return 0;
+    }
+
+    return m_rows[row].sequence;
+}
+
+
+//------------------------------------------------------------------------------
+void HistoryListModel::reload(const uint64_t sequence)
+{
+    m_changeCount = m_history->changeCount();
+    const QList<SampleInfo> page =
+        m_history->getSampleInfo(sequence, static_cast<size_t>(m_pageSize), m_writer);
+
+    beginResetModel();
+    m_rows.assign(page.begin(), page.end());
+    endResetModel();
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,143 @@
+#ifndef __HISTORY_LIST_MODEL_H__
+#define __HISTORY_LIST_MODEL_H__
+
+#include "first_define.h"
+#include "topic_history.h"
+
+#include <QAbstractListModel>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+
+/**
+ * @brief List model for one page of the sample history of a topic.
+ *
+ * @details Each row is a stored sample, the newest on top. A refresh only
+ *          reads the samples stored since the last one and reports them with
+ *          rowsInserted(). Samples that were evicted, and rows pushed off the
+ *          end of the page, are reported with rowsRemoved(). Views keep their
+ *          selection and scroll position, and a busy topic doesn't rebuild
+ *          the whole list on every change. Timestamps are only formatted for
+ *          the rows on screen.
+ *
+ *          With an anchor set, the model shows a fixed page of older samples
+ *          and only drops the rows whose samples are evicted.
+ *
+ *          With a writer set, only the samples of that writer are listed.
+ *          They are read from the per-writer index of the history.
+ */
+class HistoryListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+
+    /// Data roles beyond the standard Qt roles.
+    enum eDataRoles
+    {
+        SEQUENCE_ROLE = Qt::UserRole
+    };
+
+    /**
+     * @brief Constructor for the history list model.
+     * @param[in] history The sample history of the topic.
+     * @param[in] pageSize The maximum number of rows.
+     * @param[in] parent The parent of this Qt object.
+     */
+    HistoryListModel(const std::shared_ptr<TopicHistory>& history,
+                     const int pageSize,
+                     QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor for the history list model.
+     */
+    virtual ~HistoryListModel() = default;
+
+    /**
+     * @brief Standard row count for the list.
+     * @param[in] parent The parent model index.
+     * @return The number of samples shown.
+     */
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    /**
+     * @brief Return the data for a sample row.
+     * @param[in] index The model index of the row.
+     * @param[in] role The timestamp for Qt::DisplayRole or the sequence
+     *            number for SEQUENCE_ROLE.
+     * @return The requested data or an invalid QVariant.
+     */
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Apply the changes made to the history since the last refresh.
+     */
+    void refresh();
+
+    /**
+     * @brief Show a page of older samples or follow the newest ones.
+     * @param[in] sequence Show the newest samples up to this sequence
+     *            number. 0 follows the newest sample.
+     */
+    void setAnchor(const uint64_t sequence);
+
+    /**
+     * @brief Get the newest sequence number of the page.
+     * @return The anchor or 0 if the newest samples are followed.
+     */
+    uint64_t anchor() const;
+
+    /**
+     * @brief Only show the samples of a single writer.
+     * @param[in] writer The writer id or 0 for all writers.
+     */
+    void setWriter(const uint32_t writer);
+
+    /**
+     * @brief Get the writer whose samples are shown.
+     * @return The writer id or 0 for all writers.
+     */
+    uint32_t writer() const;
+
+    /**
+     * @brief Get the sequence number of a row.
+     * @param[in] row The row number.
+     * @return The sequence number or 0 if the row doesn't exist.
+     */
+    uint64_t sequence(const int row) const;
+
+private:
+
+    /**
+     * @brief Replace all rows with a page read from the history.
+     * @param[in] sequence Read the newest samples up to this sequence number.
+     */
+    void reload(const uint64_t sequence);
+
+    /// The sample history of the topic.
+    const std::shared_ptr<TopicHistory> m_history;
+
+    /// The maximum number of rows.
+    const int m_pageSize;
+
+    /// The newest sequence number of the page or 0 to follow the newest.
+    uint64_t m_anchor;
+
+    /// The writer whose samples are shown or 0 for all writers.
+    uint32_t m_writer;
+
+    /// The change count of the history at the last refresh.
+    uint64_t m_changeCount;
+
+    /// The samples shown, the newest first.
+    std::deque<SampleInfo> m_rows;
+
+}; // End class HistoryListModel
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,115 @@
+#include "instance_list_model.h"
+#include "dds_data.h"
+#include "topic_history.h"
+
+
+//------------------------------------------------------------------------------
+InstanceListModel::InstanceListModel(const std::shared_ptr<InstanceStore>& instances,
+                                     QObject* parent) :
+                                     QAbstractListModel(parent),
+                                     m_instances(instances),
+                                     m_rowCount(0),
+                                     m_changeCount(0)
+{
+    refresh();
+}
+
+
+//------------------------------------------------------------------------------
+int InstanceListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+
+    return m_rowCount;
+}
+
+
+//------------------------------------------------------------------------------
+QVariant InstanceListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rowCount)
+    {
+        return QVariant();
+    }
+
+    InstanceInfo info;
+    if (!m_instances->getInstance(static_cast<size_t>(index.row()), info))
+    {
+        return QVariant();
+    }
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return info.key + " (" + QString::number(info.count) + ")";
+    case Qt::ToolTipRole:
+    {
+        QString toolTip = m_instances->keyNames().join(", ");
+        if (info.latest)
+        {
+            toolTip += "\n" + CommonData::formatTime(info.latest->info.sourceTime);
+        }
+        return toolTip;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void InstanceListModel::refresh()
+{
+    const uint64_t changeCount = m_instances->changeCount();
+    if (changeCount == m_changeCount)
+    {
+        return;
+    }
+    m_changeCount = changeCount;
+
+    // Instances are only removed all at once
+    const int size = static_cast<int>(m_instances->size());
+    if (size < m_rowCount)
+    {
+        beginResetModel();
+        m_rowCount = size;
+        endResetModel();
+        return;
+    }
+
+    if (size > m_rowCount)
+    {
+        beginInsertRows(QModelIndex(), m_rowCount, size - 1);
+        m_rowCount = size;
+        endInsertRows();
+    }
+
+    // The counts of the known instances may have changed
+    if (m_rowCount > 0)
+    {
+        emit dataChanged(index(0), index(m_rowCount - 1), { Qt::DisplayRole, Qt::ToolTipRole });
+    }
+
+} // End InstanceListModel::refresh
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const SampleRecord> InstanceListModel::latest(const int row) const
+{
+    InstanceInfo info;
+    if (row < 0 || row >= m_rowCount ||
+        !m_instances->getInstance(static_cast<size_t>(row), info))
+    {
+        return nullptr;
+    }
+
+    return info.latest;
+}
+
+
+/**
+ * @}
+ */
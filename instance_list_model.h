@@ -0,0 +1,86 @@
+#ifndef __INSTANCE_LIST_MODEL_H__
+#define __INSTANCE_LIST_MODEL_H__
+
+#include "first_define.h"
+#include "instance_store.h"
+
+#include <QAbstractListModel>
+
+#include <cstdint>
+#include <memory>
+
+
+/**
+ * @brief List model for the keyed instances of a topic.
+ *
+ * @details Each row is an instance in the order it first appeared, showing
+ *          its key values and sample count. Instances are only ever added
+ *          to the store, so a refresh reports the new ones with
+ *          rowsInserted() and the rest with a single dataChanged(). A clear
+ *          resets the model.
+ */
+class InstanceListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Constructor for the instance list model.
+     * @param[in] instances The instance store of the topic.
+     * @param[in] parent The parent of this Qt object.
+     */
+    InstanceListModel(const std::shared_ptr<InstanceStore>& instances,
+                      QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor for the instance list model.
+     */
+    virtual ~InstanceListModel() = default;
+
+    /**
+     * @brief Standard row count for the list.
+     * @param[in] parent The parent model index.
+     * @return The number of instances shown.
+     */
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    /**
+     * @brief Return the data for an instance row.
+     * @param[in] index The model index of the row.
+     * @param[in] role The key and count for Qt::DisplayRole or the key
+     *            names and newest timestamp for Qt::ToolTipRole.
+     * @return The requested data or an invalid QVariant.
+     */
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Apply the changes made to the instance store since the last refresh.
+     */
+    void refresh();
+
+    /**
+     * @brief Get the newest sample of an instance.
+     * @param[in] row The row number.
+     * @return The sample or nullptr if the row doesn't exist.
+     */
+    std::shared_ptr<const SampleRecord> latest(const int row) const;
+
+private:
+
+    /// The instance store of the topic.
+    const std::shared_ptr<InstanceStore> m_instances;
+
+    /// The number of rows shown.
+    int m_rowCount;
+
+    /// The change count of the store at the last refresh.
+    uint64_t m_changeCount;
+
+}; // End class InstanceListModel
+
+#endif
+
+/**
+ * @}
+ */
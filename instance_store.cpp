@@ -0,0 +1,255 @@
+#include "instance_store.h"
+#include "history_budget.h"
+#include "member_path.h"
+#include "open_dynamic_data.h"
+#include "topic_history.h"
+
+#include <cstring>
+#include <functional>
+
+
+//------------------------------------------------------------------------------
+InstanceStore::InstanceStore(const std::vector<MemberPath>& keyPaths,
+                             const std::shared_ptr<HistoryBudget>& budget,
+                             const size_t maxInstances) :
+                             m_slots(INITIAL_SLOTS, -1),
+                             m_maxInstances(maxInstances),
+                             m_budget(budget),
+                             m_bytes(0),
+                             m_droppedCount(0),
+                             m_changeCount(0)
+{
+    m_keyColumns.reserve(keyPaths.size());
+    for (const MemberPath& keyPath : keyPaths)
+    {
+        m_keyColumns.emplace_back(keyPath);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+InstanceStore::~InstanceStore()
+{
+    if (m_budget)
+    {
+        m_budget->credit(m_bytes);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+QStringList InstanceStore::keyNames() const
+{
+    QStringList names;
+    for (const SampleColumn& column : m_keyColumns)
+    {
+        names.append(QString::fromStdString(column.path.getName()));
+    }
+    return names;
+}
+
+
+//------------------------------------------------------------------------------
+void InstanceStore::store(const std::shared_ptr<const SampleRecord>& record)
+{
+    if (!record || !record->sample)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+    packKey(*record);
+    const size_t hash = std::hash<std::string>()(m_key);
+    const size_t slot = findSlot(m_key, hash);
+
+    // Known instance
+    if (m_slots[slot] >= 0)
+    {
+        InstanceInfo& info = m_instances[m_slots[slot]].info;
+        const uint64_t oldBytes = info.latest->info.byteSize;
+        const uint64_t newBytes = record->info.byteSize;
+        m_bytes = m_bytes - oldBytes + newBytes;
+        if (m_budget)
+        {
+            m_budget->charge(newBytes);
+            m_budget->credit(oldBytes);
+        }
+
+        info.count++;
+        info.latest = record;
+        m_changeCount.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    if (m_instances.size() >= m_maxInstances)
+    {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // New instance. The key is only formatted once.
+    Instance instance;
+    instance.key = m_key;
+    instance.hash = hash;
+    instance.info.count = 1;
+    instance.info.latest = record;
+    for (const SampleColumn& column : m_keyColumns)
+    {
+        if (!instance.info.key.isEmpty())
+        {
+            instance.info.key += ", ";
+        }
+        instance.info.key += column.toString(0);
+    }
+
+    m_slots[slot] = static_cast<int32_t>(m_instances.size());
+    m_instances.push_back(std::move(instance));
+
+    m_bytes += record->info.byteSize;
+    if (m_budget)
+    {
+        m_budget->charge(record->info.byteSize);
+    }
+
+    // Keep the table at most half full, so probes stay short
+    if (m_instances.size() * 2 > m_slots.size())
+    {
+        grow();
+    }
+
+    m_changeCount.fetch_add(1, std::memory_order_release);
+
+} // End InstanceStore::store
+
+
+//------------------------------------------------------------------------------
+void InstanceStore::clear()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (m_budget)
+    {
+        m_budget->credit(m_bytes);
+    }
+    m_bytes = 0;
+    m_instances.clear();
+    m_slots.assign(INITIAL_SLOTS, -1);
+    m_droppedCount.store(0, std::memory_order_relaxed);
+    m_changeCount.fetch_add(1, std::memory_order_release);
+}
+
+
+//------------------------------------------------------------------------------
+size_t InstanceStore::size() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return m_instances.size();
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t InstanceStore::changeCount() const
+{
+    return m_changeCount.load(std::memory_order_acquire);
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t InstanceStore::droppedCount() const
+{
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+
+//------------------------------------------------------------------------------
+bool InstanceStore::getInstance(const size_t index, InstanceInfo& info) const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (index >= m_instances.size())
+    {
+        return false;
+    }
+
+    info = m_instances[index].info;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+void InstanceStore::packKey(const SampleRecord& record)
+{
+    m_key.clear();
+    for (SampleColumn& column : m_keyColumns)
+    {
+        column.clear();
+        column.append(record.sample.get());
+
+        // Mark missing members, so they can't collide with a value
+        if (!column.valid[0])
+        {
+            m_key += '\0';
+            continue;
+        }
+        m_key += '\1';
+
+        switch (column.type)
+        {
+        case SampleColumn::DOUBLE:
+            m_key.append(reinterpret_cast<const char*>(&column.doubles[0]), sizeof(double));
+            break;
+        case SampleColumn::INT64:
+            m_key.append(reinterpret_cast<const char*>(&column.integers[0]), sizeof(int64_t));
+            break;
+        case SampleColumn::STRING:
+        {
+            // Include the terminator, so "a" + "bc" differs from "ab" + "c"
+            const char* value = column.strings[0] ? column.strings[0] : "";
+            m_key.append(value, strlen(value) + 1);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+} // End InstanceStore::packKey
+
+
+//------------------------------------------------------------------------------
+size_t InstanceStore::findSlot(const std::string& key, const size_t hash) const
+{
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = hash & mask;
+    while (m_slots[slot] >= 0)
+    {
+        const Instance& instance = m_instances[m_slots[slot]];
+        if (instance.hash == hash && instance.key == key)
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+
+//------------------------------------------------------------------------------
+void InstanceStore::grow()
+{
+    m_slots.assign(m_slots.size() * 2, -1);
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = 0; i < m_instances.size(); i++)
+    {
+        size_t slot = m_instances[i].hash & mask;
+        while (m_slots[slot] >= 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = static_cast<int32_t>(i);
+    }
+}
+
+
+/**
+ * @}
+ */
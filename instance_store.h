@@ -0,0 +1,199 @@
+#ifndef __INSTANCE_STORE_H__
+#define __INSTANCE_STORE_H__
+
+#include "sample_columns.h"
+
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class HistoryBudget;
+class MemberPath;
+struct SampleRecord;
+
+
+/**
+ * @brief What is known about a single instance of a keyed topic.
+ */
+struct InstanceInfo
+{
+    /// The key member values, for display.
+    QString key;
+
+    /// The number of samples received for the instance.
+    uint64_t count;
+
+    /// The newest sample of the instance.
+    std::shared_ptr<const SampleRecord> latest;
+};
+
+
+/**
+ * @brief The newest sample of every instance of a topic.
+ *
+ * @details The key members are read from each stored sample through resolved
+ *          member paths and packed into a byte string. The key is hashed into
+ *          an open addressing table with linear probing, which holds indexes
+ *          into a list of instances in the order they first appeared. The
+ *          table doubles once it's half full, and the instance indexes never
+ *          change, so views can treat them as stable rows.
+ *
+ *          The topic history evicts by age and count, so a busy instance
+ *          pushes the quiet ones out within moments. This store keeps the
+ *          newest sample of each instance no matter how long ago it arrived.
+ *          Once the store holds the maximum number of instances, samples of
+ *          new instances are only counted.
+ *
+ *          The newest sample of each instance is charged to the history
+ *          budget and credited back when it's replaced or cleared, so a store
+ *          that outlives the history's copies still counts against the limit.
+ */
+class InstanceStore
+{
+public:
+
+    /**
+     * @brief Constructor for the instance store.
+     * @param[in] keyPaths The key members, resolved for the topic type.
+     * @param[in] budget Charge the kept samples here or null for no budget.
+     * @param[in] maxInstances The maximum number of instances to keep.
+     */
+    InstanceStore(const std::vector<MemberPath>& keyPaths,
+                  const std::shared_ptr<HistoryBudget>& budget,
+                  const size_t maxInstances = DEFAULT_MAX_INSTANCES);
+
+    /**
+     * @brief Destructor for the instance store. Credits the kept samples.
+     */
+    ~InstanceStore();
+
+    /**
+     * @brief Get the names of the key members.
+     * @return The full member names.
+     */
+    QStringList keyNames() const;
+
+    /**
+     * @brief Make a stored sample the newest of its instance.
+     * @remarks Thread safe. Called by TopicHistory for every stored sample.
+     *          Going over the budget is left to the history to enforce,
+     *          since this runs under its write lock.
+     * @param[in] record The stored sample.
+     */
+    void store(const std::shared_ptr<const SampleRecord>& record);
+
+    /**
+     * @brief Forget all instances.
+     * @remarks Thread safe.
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of instances.
+     * @return The instance count.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the number of changes made to the store.
+     * @return The change count.
+     */
+    uint64_t changeCount() const;
+
+    /**
+     * @brief Get the number of samples of instances that didn't fit.
+     * @return The dropped sample count.
+     */
+    uint64_t droppedCount() const;
+
+    /**
+     * @brief Get an instance by index.
+     * @param[in] index The instance index, in the order of appearance.
+     * @param[out] info The instance.
+     * @return False if there is no instance at this index.
+     */
+    bool getInstance(const size_t index, InstanceInfo& info) const;
+
+    /// The default maximum number of instances.
+    static const size_t DEFAULT_MAX_INSTANCES = 100000;
+
+    /// The initial number of table slots. Must be a power of two.
+    static const size_t INITIAL_SLOTS = 64;
+
+private:
+
+    /// An instance along with its key.
+    struct Instance
+    {
+        /// The packed key member values.
+        std::string key;
+
+        /// The hash of the packed key.
+        size_t hash;
+
+        /// The instance for display.
+        InstanceInfo info;
+    };
+
+    /**
+     * @brief Read and pack the key members of a sample into m_key.
+     * @param[in] record The stored sample.
+     */
+    void packKey(const SampleRecord& record);
+
+    /**
+     * @brief Find the table slot of a key.
+     * @param[in] key The packed key.
+     * @param[in] hash The hash of the key.
+     * @return The slot holding the key or the empty slot where it belongs.
+     */
+    size_t findSlot(const std::string& key, const size_t hash) const;
+
+    /**
+     * @brief Double the size of the table and insert all instances again.
+     */
+    void grow();
+
+    /// Reads the key members of a sample.
+    std::vector<SampleColumn> m_keyColumns;
+
+    /// The packed key of the sample being stored.
+    std::string m_key;
+
+    /// The instances in the order they first appeared.
+    std::vector<Instance> m_instances;
+
+    /// The open addressing table. Each slot is an instance index or -1.
+    std::vector<int32_t> m_slots;
+
+    /// The maximum number of instances.
+    const size_t m_maxInstances;
+
+    /// The budget the kept samples are charged to. May be null.
+    const std::shared_ptr<HistoryBudget> m_budget;
+
+    /// The bytes of the kept samples.
+    uint64_t m_bytes;
+
+    /// The number of samples of instances that didn't fit.
+    std::atomic<uint64_t> m_droppedCount;
+
+    /// The number of changes made to the store.
+    std::atomic<uint64_t> m_changeCount;
+
+    /// Protects the key columns, the instances, the table and m_bytes.
+    mutable std::mutex m_mutex;
+
+}; // End class InstanceStore
+
+#endif
+
+/**
+ * @}
+ */
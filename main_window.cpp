@@ -6,6 +6,10 @@
 #include "participant_page.h"
 #include "publication_monitor.h"
 #include "subscription_monitor.h"
+#include "change_notifier.h"
+#include "history_budget.h"
+#include "sample_pipeline.h"
+#include "spill_store.h"
 
 #include <iostream>
 #include <iomanip>
@@ -64,6 +68,16 @@ DDSMonitorMainWindow::DDSMonitorMainWindow() :
         setWindowTitle("DDS Monitor - Domain " + QString::number(domainID));
 
 
+        // Topic histories share one memory budget and spill to disk if enabled
+        CommonData::m_historyBudget = HistoryBudget::createFromEnvironment();
+        CommonData::m_spillWriter = SpillWriter::createFromEnvironment();
+
+        // Pages are told when a topic changes instead of polling it
+        CommonData::m_changeNotifier = ChangeNotifier::createFromEnvironment();
+
+        // Received samples are filtered and stored on worker threads
+        CommonData::m_samplePipeline = SamplePipeline::createFromEnvironment();
+
         // Join the DDS domain
         CommonData::m_ddsManager = std::make_unique<DDSManager>();
         m_participantPage = new ParticipantPage(mainTabWidget);
@@ -0,0 +1,219 @@
+#include "member_path.h"
+
+#include <cstdlib>
+#include <iostream>
+
+
+//------------------------------------------------------------------------------
+MemberPath::MemberPath() :
+                       m_node(nullptr),
+                       m_offset(0)
+{}
+
+
+//------------------------------------------------------------------------------
+MemberPath::MemberPath(const CORBA::TypeCode* typeCode, const std::string& fullName) :
+                       MemberPath(SampleLayout::get(typeCode), fullName)
+{}
+
+
+//------------------------------------------------------------------------------
+MemberPath::MemberPath(const std::shared_ptr<const SampleLayout>& layout,
+                       const std::string& fullName) :
+                       m_layout(layout),
+                       m_node(nullptr),
+                       m_name(fullName),
+                       m_offset(0)
+{
+    if (!m_layout || !resolve())
+    {
+        m_node = nullptr;
+        m_steps.clear();
+        m_offset = 0;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberPath::resolve()
+{
+    const SampleLayout::Node* node = &m_layout->root();
+    const size_t length = m_name.size();
+    size_t pos = 0;
+
+    while (pos < length)
+    {
+        const char ch = m_name[pos];
+
+        // Eat '.' between struct members
+        if (ch == '.')
+        {
+            ++pos;
+            continue;
+        }
+
+        // Array or sequence element
+        if (ch == '[')
+        {
+            const size_t close = m_name.find(']', pos);
+            if (close == std::string::npos ||
+                (node->kind != CORBA::tk_array && node->kind != CORBA::tk_sequence))
+            {
+                return false;
+            }
+
+            const std::string indexText = m_name.substr(pos + 1, close - pos - 1);
+            char* indexEnd = nullptr;
+            const size_t index = strtoul(indexText.c_str(), &indexEnd, 10);
+            if (indexText.empty() || *indexEnd != '\0')
+            {
+                return false;
+            }
+
+            if (node->kind == CORBA::tk_array)
+            {
+                if (index >= node->length)
+                {
+                    return false;
+                }
+                m_offset += index * node->stride;
+            }
+            else
+            {
+                // The element block is only known at read time
+                m_steps.push_back({ m_offset, index, node->stride });
+                m_offset = 0;
+            }
+
+            node = &node->members[0];
+            pos = close + 1;
+            continue;
+        }
+
+        // Struct member
+        if (node->kind != CORBA::tk_struct)
+        {
+            return false;
+        }
+
+        size_t end = m_name.find_first_of(".[", pos);
+        if (end == std::string::npos)
+        {
+            end = length;
+        }
+
+        const std::string memberName = m_name.substr(pos, end - pos);
+        const SampleLayout::Node* member = nullptr;
+        for (const SampleLayout::Node& child : node->members)
+        {
+            if (child.name == memberName)
+            {
+                member = &child;
+                break;
+            }
+        }
+
+        if (!member)
+        {
+            return false;
+        }
+
+        m_offset += member->offset;
+        node = member;
+        pos = end;
+    }
+
+    // An empty name is not a member
+    if (node == &m_layout->root())
+    {
+        return false;
+    }
+
+    m_node = node;
+    return true;
+
+} // End MemberPath::resolve
+
+
+//------------------------------------------------------------------------------
+bool MemberPath::isValid() const
+{
+    return m_node != nullptr;
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberPath::isFixed() const
+{
+    return m_steps.empty();
+}
+
+
+//------------------------------------------------------------------------------
+const std::string& MemberPath::getName() const
+{
+    return m_name;
+}
+
+
+//------------------------------------------------------------------------------
+CORBA::TCKind MemberPath::getKind() const
+{
+    return m_node ? m_node->kind : CORBA::tk_null;
+}
+
+
+//------------------------------------------------------------------------------
+const CORBA::TypeCode* MemberPath::getTypeCode() const
+{
+    return m_node ? m_node->typeCode : nullptr;
+}
+
+
+//------------------------------------------------------------------------------
+const SampleLayout::Node* MemberPath::getNode() const
+{
+    return m_node;
+}
+
+
+//------------------------------------------------------------------------------
+const std::shared_ptr<const SampleLayout>& MemberPath::getLayout() const
+{
+    return m_layout;
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberPath::locate(const SampleStorage& storage,
+                        uint32_t& block,
+                        size_t& offset) const
+{
+    if (!m_node)
+    {
+        return false;
+    }
+
+    uint32_t currentBlock = 0;
+    size_t base = 0;
+    for (const Step& step : m_steps)
+    {
+        const size_t handleOffset = base + step.offset;
+        if (step.index >= storage.sequenceLength(currentBlock, handleOffset))
+        {
+            return false;
+        }
+
+        currentBlock = storage.sequenceBlock(currentBlock, handleOffset);
+        base = step.index * step.stride;
+    }
+
+    block = currentBlock;
+    offset = base + m_offset;
+    return true;
+}
+
+
+/**
+ * @}
+ */
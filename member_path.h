@@ -0,0 +1,139 @@
+#ifndef __MEMBER_PATH_H__
+#define __MEMBER_PATH_H__
+
+#include "sample_layout.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Pre-resolved handle to a (possibly nested) member of a topic type.
+ *
+ * @details A full member name such as "pose.position[2].x" is parsed once
+ *          against the SampleLayout of the topic. Struct members and array
+ *          elements fold into a single byte offset. Only sequence elements
+ *          need a lookup at read time, because their storage block depends on
+ *          the sample. Locating a member is then a few additions instead of a
+ *          name search through the member views.
+ */
+class MemberPath
+{
+public:
+
+    /**
+     * @brief Constructor for an invalid member path.
+     */
+    MemberPath();
+
+    /**
+     * @brief Resolve a member name for a topic type.
+     * @param[in] typeCode The type definition pointer for the topic.
+     * @param[in] fullName The full member name, as from getFullName().
+     */
+    MemberPath(const CORBA::TypeCode* typeCode, const std::string& fullName);
+
+    /**
+     * @brief Resolve a member name for a topic layout.
+     * @param[in] layout The layout of the topic type.
+     * @param[in] fullName The full member name, as from getFullName().
+     */
+    MemberPath(const std::shared_ptr<const SampleLayout>& layout,
+               const std::string& fullName);
+
+    /**
+     * @brief Get whether the name was resolved to a member.
+     * @return True if the path is usable; false otherwise.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Get whether the member is at a fixed offset in every sample.
+     * @return True if no sequence element is on the path.
+     */
+    bool isFixed() const;
+
+    /**
+     * @brief Get the full member name this path was resolved from.
+     * @return The full member name.
+     */
+    const std::string& getName() const;
+
+    /**
+     * @brief Get the type kind of the member.
+     * @return The type kind or tk_null if the path is invalid.
+     */
+    CORBA::TCKind getKind() const;
+
+    /**
+     * @brief Get the type code of the member.
+     * @return The type code or nullptr if the path is invalid.
+     */
+    const CORBA::TypeCode* getTypeCode() const;
+
+    /**
+     * @brief Get the layout of the member.
+     * @return The layout node or nullptr if the path is invalid.
+     */
+    const SampleLayout::Node* getNode() const;
+
+    /**
+     * @brief Get the layout this path was resolved against.
+     * @return The topic layout.
+     */
+    const std::shared_ptr<const SampleLayout>& getLayout() const;
+
+    /**
+     * @brief Find the member within the storage of a sample.
+     * @param[in] storage The decoded storage of a sample of this type.
+     * @param[out] block The storage block holding the member.
+     * @param[out] offset The byte offset of the member within the block.
+     * @return False if a sequence on the path is too short for this sample.
+     */
+    bool locate(const SampleStorage& storage, uint32_t& block, size_t& offset) const;
+
+private:
+
+    /// A step into a sequence element.
+    struct Step
+    {
+        /// The offset of the sequence handle from the current base.
+        size_t offset;
+
+        /// The element index.
+        size_t index;
+
+        /// The size of each element.
+        size_t stride;
+    };
+
+    /**
+     * @brief Parse the member name into steps.
+     * @return True if the name was resolved; false otherwise.
+     */
+    bool resolve();
+
+    /// The layout this path was resolved against.
+    std::shared_ptr<const SampleLayout> m_layout;
+
+    /// The layout of the target member, or nullptr if the path is invalid.
+    const SampleLayout::Node* m_node;
+
+    /// The full member name.
+    std::string m_name;
+
+    /// The sequence elements on the path.
+    std::vector<Step> m_steps;
+
+    /// The offset of the member from the base of the last step.
+    size_t m_offset;
+
+}; // End class MemberPath
+
+#endif
+
+/**
+ * @}
+ */
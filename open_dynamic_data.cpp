@@ -1,43 +1,65 @@
 #include <tao/AnyTypeCode/Enum_TypeCode.h>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 #include "open_dynamic_data.h"
 
 std::shared_ptr<OpenDynamicData> CreateOpenDynamicData(const CORBA::TypeCode* typeCode,
     const OpenDDS::DCPS::Encoding::Kind encodingKind, 
-    const OpenDDS::DCPS::Extensibility extensibility,
-    const std::weak_ptr<OpenDynamicData> parent)
+    const OpenDDS::DCPS::Extensibility extensibility)
 {
-    std::shared_ptr<OpenDynamicData> temp = std::make_shared<OpenDynamicData>(typeCode, encodingKind, extensibility, parent);
-    temp->populate(); //Can't call this in the constructor because shared_from_this isn't ready yet!
+    std::shared_ptr<OpenDynamicData> temp = std::make_shared<OpenDynamicData>(typeCode, encodingKind, extensibility);
+    temp->populate();
     return temp;
 }
 
 //------------------------------------------------------------------------------
 OpenDynamicData::OpenDynamicData(const CORBA::TypeCode* typeCode,
                                  const OpenDDS::DCPS::Encoding::Kind encodingKind, 
-                                 const OpenDDS::DCPS::Extensibility extensibility,
-                                 const std::weak_ptr<OpenDynamicData> parent) :
-                                 m_encodingKind(encodingKind),
-                                 m_extensibility(extensibility),
-                                 m_parent(parent),
+                                 const OpenDDS::DCPS::Extensibility extensibility) :
+                                 m_layout(nullptr),
+                                 m_block(0),
+                                 m_offset(0),
+                                 m_childBlock(0),
+                                 m_childBytes(0),
                                  m_name("EMPTY_NAME"),
                                  m_typeCode(typeCode), 
-                                 m_containsComplexTypes(false)
+                                 m_encodingKind(encodingKind),
+                                 m_extensibility(extensibility)
 {
     if (!m_typeCode)
     {
         std::cerr << "Bad typecode received in OpenDynamicData()" << std::endl;
         return;
     }
-
-    memset(&m_value, 0, sizeof(m_value));
-    //Can't call this in the constructor because shared_from_this isn't ready yet!
-    //populate();
 }
 
 
+//------------------------------------------------------------------------------
+OpenDynamicData::OpenDynamicData(const std::shared_ptr<SampleStorage>& storage,
+                                 const SampleLayout::Node* layout,
+                                 const uint32_t block,
+                                 const size_t offset,
+                                 const std::string& name,
+                                 const OpenDDS::DCPS::Encoding::Kind encodingKind,
+                                 const std::weak_ptr<OpenDynamicData> parent) :
+                                 m_storage(storage),
+                                 m_layout(layout),
+                                 m_block(block),
+                                 m_offset(offset),
+                                 m_childBlock(0),
+                                 m_childBytes(0),
+                                 m_parent(parent),
+                                 m_name(name),
+                                 m_typeCode(layout->typeCode),
+                                 m_encodingKind(encodingKind),
+                                 //RJ 2022-01-21 I think older verisons of ddsman will default to topics being appendable, but structs within them being final. I think.
+                                 m_extensibility(OpenDDS::DCPS::Extensibility::FINAL)
+{}
+
+
 //------------------------------------------------------------------------------
 OpenDynamicData::~OpenDynamicData()
 {
@@ -58,8 +80,24 @@ OpenDynamicData& OpenDynamicData::operator=(const OpenDynamicData& other)
         return *this;
     }
 
+    if (!m_storage || !other.m_storage)
+    {
+        std::cerr << "OpenDynamicData::operator=: "
+                  << "Sample was not populated"
+                  << std::endl;
+        return *this;
+    }
+
+    // Whole samples are copied as a single block of memory
+    const SampleLayout::Node* rootLayout = &m_storage->layout()->root();
+    if (m_layout == rootLayout && other.m_layout == rootLayout)
+    {
+        m_storage->copyFrom(*other.m_storage);
+        return *this;
+    }
+
     const size_t otherCount = other.getLength();
-    const size_t childCount = m_children.size();
+    const size_t childCount = getLength();
 
     if (childCount != otherCount)
     {
@@ -72,47 +110,47 @@ OpenDynamicData& OpenDynamicData::operator=(const OpenDynamicData& other)
     for (size_t i = 0; i < childCount; i++)
     {
         const std::shared_ptr<OpenDynamicData> otherChild = other.getMember(i);
-        std::shared_ptr<OpenDynamicData> thisChild = m_children[i];
+        std::shared_ptr<OpenDynamicData> thisChild = getMember(i);
 
         const CORBA::TCKind kind = thisChild->getKind();
         switch (kind)
         {
         case CORBA::tk_long:
-            thisChild->setValue(otherChild->m_value.int32);
+            thisChild->setValue(otherChild->load<ACE_CDR::Long>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_short:
-            thisChild->setValue(otherChild->m_value.int16);
+            thisChild->setValue(otherChild->load<ACE_CDR::Short>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_ushort:
-            thisChild->setValue(otherChild->m_value.uint16);
+            thisChild->setValue(otherChild->load<ACE_CDR::UShort>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_enum:
         case CORBA::tk_ulong:
-            thisChild->setValue(otherChild->m_value.uint32);
+            thisChild->setValue(otherChild->load<ACE_CDR::ULong>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_float:
-            thisChild->setValue(otherChild->m_value.float32);
+            thisChild->setValue(otherChild->load<ACE_CDR::Float>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_double:
-            thisChild->setValue(otherChild->m_value.float64);
+            thisChild->setValue(otherChild->load<ACE_CDR::Double>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_boolean:
-            thisChild->setValue(otherChild->m_value.boolean != 0);
+            thisChild->setValue(otherChild->load<ACE_CDR::Octet>(otherChild->m_block, otherChild->m_offset) != 0);
             break;
         case CORBA::tk_char:
-            thisChild->setValue(otherChild->m_value.char8);
+            thisChild->setValue(otherChild->load<ACE_CDR::Char>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_wchar:
-            thisChild->setValue(otherChild->m_value.char16);
+            thisChild->setValue(otherChild->load<ACE_CDR::WChar>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_octet:
-            thisChild->setValue(otherChild->m_value.uint8);
+            thisChild->setValue(otherChild->load<ACE_CDR::Octet>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_longlong:
-            thisChild->setValue(otherChild->m_value.int64);
+            thisChild->setValue(otherChild->load<ACE_CDR::LongLong>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_ulonglong:
-            thisChild->setValue(otherChild->m_value.uint64);
+            thisChild->setValue(otherChild->load<ACE_CDR::ULongLong>(otherChild->m_block, otherChild->m_offset));
             break;
         case CORBA::tk_string:
             thisChild->setStringValue(otherChild->getStringValue());
@@ -153,7 +191,7 @@ bool OpenDynamicData::operator==(const OpenDynamicData& other)
     }
 
     const size_t otherCount = other.getLength();
-    const size_t childCount = m_children.size();
+    const size_t childCount = getLength();
 
     if (childCount != otherCount)
     {
@@ -166,7 +204,7 @@ bool OpenDynamicData::operator==(const OpenDynamicData& other)
     for (size_t i = 0; i < childCount; i++)
     {
         const std::shared_ptr<OpenDynamicData> otherChild = other.getMember(i);
-        std::shared_ptr<OpenDynamicData> thisChild = m_children[i];
+        std::shared_ptr<OpenDynamicData> thisChild = getMember(i);
 
         const CORBA::TCKind kind = thisChild->getKind();
         switch (kind)
@@ -283,6 +321,7 @@ bool OpenDynamicData::operator==(const OpenDynamicData& other)
 //------------------------------------------------------------------------------
 void OpenDynamicData::dump() const
 {
+    syncChildren();
     for (const auto& child : m_children)
     {
         if (child->getKind() == CORBA::tk_sequence ||
@@ -376,6 +415,7 @@ bool OpenDynamicData::operator>>(OpenDDS::DCPS::Serializer& stream) const
 {
     //std::cout << "DEBUG OpenDynamicData::operator>>" << endl;
     bool pass = true;
+    syncChildren();
     for (const std::shared_ptr<OpenDynamicData>& child : m_children)
     {
         switch (child->getKind())
@@ -511,6 +551,7 @@ bool OpenDynamicData::operator<<(OpenDDS::DCPS::Serializer& stream)
     SimpleTypeUnion tmpValue;
     memset(&tmpValue, 0, sizeof(tmpValue));
 
+    syncChildren();
     for (std::shared_ptr<OpenDynamicData> child : m_children)
     {
         // Protection for inconsistent topics or junk data
@@ -686,6 +727,11 @@ std::string OpenDynamicData::getName() const
 //------------------------------------------------------------------------------
 CORBA::TCKind OpenDynamicData::getKind() const
 {
+    if (m_layout)
+    {
+        return m_layout->kind;
+    }
+
     if (!m_typeCode)
     {
         return CORBA::tk_null;
@@ -697,19 +743,19 @@ CORBA::TCKind OpenDynamicData::getKind() const
 //------------------------------------------------------------------------------
 bool OpenDynamicData::isPrimitive() const
 {
-    return isPrimitiveImpl(m_typeCode->kind());
+    return isPrimitiveKind(getKind());
 }
 
 //------------------------------------------------------------------------------
 bool OpenDynamicData::isContainerType() const
 {
-    return isContainerType(m_typeCode->kind());
+    return isContainerType(getKind());
 }
 
 //------------------------------------------------------------------------------
 size_t OpenDynamicData::getEncapsulationLength()
 {
-    switch (m_typeCode->kind())
+    switch (getKind())
     {
         case CORBA::tk_long:
             return sizeof(CORBA::Long);
@@ -739,9 +785,8 @@ size_t OpenDynamicData::getEncapsulationLength()
             return sizeof(CORBA::Boolean);
         case CORBA::tk_string:
             {
-                std::string temp(m_stringValue);
                 //Per xtypes spec, section 7.4.3.5.3 rules 3, this includes NUL, and 4 bytes for string length
-                return temp.length() + 1 + sizeof(CORBA::ULong) ; 
+                return strlen(getStringValue()) + 1 + sizeof(CORBA::ULong) ; 
             }
         case CORBA::tk_sequence:
             {
@@ -752,7 +797,7 @@ size_t OpenDynamicData::getEncapsulationLength()
                 
                 if(getLength() > 0)
                 {
-                    ret +=  m_children[0]->getEncapsulationLength() * getLength();
+                    ret +=  getMember(0)->getEncapsulationLength() * getLength();
                 }
                 if((m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1) && containsComplexTypes())
                 {
@@ -763,6 +808,7 @@ size_t OpenDynamicData::getEncapsulationLength()
         case CORBA::tk_struct:
             {
                 size_t sum=0;
+                syncChildren();
                 for(const auto& child : m_children)
                 {
                     sum += child->getEncapsulationLength();
@@ -779,7 +825,7 @@ size_t OpenDynamicData::getEncapsulationLength()
                 size_t sum = 0;
                 if(getLength() > 0)
                 {
-                    sum += m_children[0]->getEncapsulationLength() * getLength();
+                    sum += getMember(0)->getEncapsulationLength() * getLength();
                 }
                 if((m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1) && containsComplexTypes())
                 {
@@ -797,7 +843,7 @@ size_t OpenDynamicData::getEncapsulationLength()
 //------------------------------------------------------------------------------
 bool OpenDynamicData::containsComplexTypes() const
 {
-    return m_containsComplexTypes;
+    return m_layout ? m_layout->containsComplexTypes : false;
 }
 
 //------------------------------------------------------------------------------
@@ -810,44 +856,157 @@ const CORBA::TypeCode* OpenDynamicData::getTypeCode() const
 //------------------------------------------------------------------------------
 size_t OpenDynamicData::getLength() const
 {
-    return m_children.size();
+    if (!m_layout)
+    {
+        return 0;
+    }
+
+    switch (m_layout->kind)
+    {
+    case CORBA::tk_struct:
+    case CORBA::tk_array:
+        return m_layout->length;
+    case CORBA::tk_sequence:
+        ensureDecoded();
+        return m_storage->sequenceLength(m_block, m_offset);
+    default:
+        return 0;
+    }
 }
 
 
 //------------------------------------------------------------------------------
 void OpenDynamicData::setLength(const size_t& length)
 {
-    //while (!m_children.empty())
-    //{
-    //    delete m_children.back();
-    //    m_children.back() = nullptr;
-    //    m_children.pop_back();
-    //}
+    if (getKind() != CORBA::tk_sequence)
+    {
+        if (length != getLength())
+        {
+            std::cerr << "OpenDynamicData::setLength: "
+                      << "Only sequences can be resized "
+                      << m_name
+                      << std::endl;
+        }
+        return;
+    }
+
+    ensureDecoded();
+    std::lock_guard<std::recursive_mutex> locker(m_storage->viewMutex());
+    m_storage->resizeSequence(m_block, m_offset, length, m_layout->stride);
+
+    // The element views are recreated on the next access
     m_children.clear();
+    m_childBlock = 0;
 
-    m_children.resize(length);
-    for (size_t i = 0; i < length; i++)
+} // End OpenDynamicData::setLength
+
+
+//------------------------------------------------------------------------------
+void OpenDynamicData::syncChildren() const
+{
+    if (!m_layout || !m_storage)
+    {
+        return;
+    }
+
+    // Sequence element views depend on the decoded length
+    if (m_layout->kind == CORBA::tk_sequence)
+    {
+        ensureDecoded();
+    }
+
+    // Const accessors get here from any thread, so the views of a sample are
+    // only built under its storage lock. Once built they stay put until a
+    // sequence is resized, so callers may walk m_children afterwards.
+    std::lock_guard<std::recursive_mutex> locker(m_storage->viewMutex());
+
+    // The children keep a weak reference to this member
+    std::weak_ptr<OpenDynamicData> self =
+        std::const_pointer_cast<OpenDynamicData>(weak_from_this().lock());
+
+    switch (m_layout->kind)
+    {
+    case CORBA::tk_struct:
+        if (m_children.size() == m_layout->members.size())
+        {
+            return;
+        }
+
+        m_children.clear();
+        m_children.reserve(m_layout->members.size());
+        for (const SampleLayout::Node& member : m_layout->members)
+        {
+            m_children.emplace_back(new OpenDynamicData(m_storage,
+                                                        &member,
+                                                        m_block,
+                                                        m_offset + member.offset,
+                                                        member.name,
+                                                        m_encodingKind,
+                                                        self));
+        }
+        break;
+
+    case CORBA::tk_array:
+    case CORBA::tk_sequence:
     {
-        std::string elementName;
-        elementName += "[";
-        elementName += std::to_string(i);
-        elementName += "]";
+        uint32_t block = m_block;
+        size_t base = m_offset;
+        size_t length = m_layout->length;
+        if (m_layout->kind == CORBA::tk_sequence)
+        {
+            block = m_storage->sequenceBlock(m_block, m_offset);
+            base = 0;
+            length = m_storage->sequenceLength(m_block, m_offset);
+        }
 
-        // Get the true type for this array/sequence
-        CORBA::TypeCode_ptr contentType = m_typeCode->content_type();
+        // Element views are positional, so they stay valid until the
+        // sequence is resized
+        if (m_children.size() == length && m_childBlock == block)
+        {
+            return;
+        }
 
-        // Follow the alias trail until we have the true type
-        while (contentType->kind() == CORBA::tk_alias)
+        m_children.clear();
+        m_children.reserve(length);
+        m_childBlock = block;
+        const SampleLayout::Node* element = &m_layout->members[0];
+        for (size_t i = 0; i < length; i++)
         {
-            contentType = TAO::unaliased_typecode(contentType);
+            std::string elementName;
+            elementName += "[";
+            elementName += std::to_string(i);
+            elementName += "]";
+
+            m_children.emplace_back(new OpenDynamicData(m_storage,
+                                                        element,
+                                                        block,
+                                                        base + i * m_layout->stride,
+                                                        elementName,
+                                                        m_encodingKind,
+                                                        self));
         }
-        //RJ 2022-01-21 I think older verisons of ddsman will default to topics being appendable, but structs within them being final. I think.
-        std::shared_ptr<OpenDynamicData> elementMember = CreateOpenDynamicData(contentType, m_encodingKind, OpenDDS::DCPS::Extensibility::FINAL, weak_from_this());
-        elementMember->setName(elementName);
-        m_children[i] = elementMember;
+        break;
     }
 
-} // End OpenDynamicData::setLength
+    default:
+        return;
+    }
+
+    // The sample was measured when it was stored, so charge what the views
+    // added since
+    size_t childBytes = m_children.capacity() * sizeof(std::shared_ptr<OpenDynamicData>);
+    for (const std::shared_ptr<OpenDynamicData>& child : m_children)
+    {
+        childBytes += sizeof(OpenDynamicData) + child->m_name.capacity();
+    }
+
+    if (childBytes > m_childBytes)
+    {
+        m_storage->charge(childBytes - m_childBytes);
+        m_childBytes = childBytes;
+    }
+
+} // End OpenDynamicData::syncChildren
 
 //------------------------------------------------------------------------------
 std::string OpenDynamicData::getFullName() const
@@ -879,6 +1038,7 @@ std::shared_ptr<OpenDynamicData> OpenDynamicData::getMember(const std::string& f
     }
 
     // First, check for simple matches
+    syncChildren();
     for (auto child : m_children)
     {
        if (child->getName() == fullName)
@@ -919,6 +1079,7 @@ std::shared_ptr<OpenDynamicData> OpenDynamicData::getMember(const std::string& f
 //------------------------------------------------------------------------------
 std::shared_ptr<OpenDynamicData> OpenDynamicData::getMember(const size_t& index) const
 {
+    syncChildren();
     if (index >= m_children.size())
     {
         std::cerr << "OpenDynamicData::getMember: "
@@ -942,9 +1103,126 @@ const char* OpenDynamicData::getStringValue() const
             << getFullName()
             << std::endl;
 
+        return "";
     }
-    const char* charValue = m_stringValue;
-    return charValue;
+
+    ensureDecoded();
+    return m_storage->getString(m_block, m_offset);
+}
+
+
+//------------------------------------------------------------------------------
+bool OpenDynamicData::getStringValue(const MemberPath& path, const char*& value) const
+{
+    uint32_t block = 0;
+    size_t offset = 0;
+    if (path.getKind() != CORBA::tk_string || !locate(path, block, offset))
+    {
+        return false;
+    }
+
+    ensureDecoded();
+    value = m_storage->getString(block, offset);
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+template<class V>
+static void convertValues(const char* source,
+                          const size_t stride,
+                          const size_t length,
+                          float* values)
+{
+    // A fixed size copy per element compiles to a plain load, so the loop
+    // vectorizes when the elements are packed
+    for (size_t i = 0; i < length; i++)
+    {
+        V value;
+        memcpy(&value, source + i * stride, sizeof(V));
+        values[i] = static_cast<float>(value);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool OpenDynamicData::getValues(const MemberPath& path, std::vector<float>& values) const
+{
+    const SampleLayout::Node* node = path.getNode();
+    uint32_t block = 0;
+    size_t offset = 0;
+    if (!node ||
+        (node->kind != CORBA::tk_array && node->kind != CORBA::tk_sequence) ||
+        node->members.empty() ||
+        !isPrimitiveKind(node->members[0].kind) ||
+        !locate(path, block, offset))
+    {
+        return false;
+    }
+
+    // Array elements are inline, sequence elements have a block of their own
+    ensureDecoded();
+    size_t length = node->length;
+    if (node->kind == CORBA::tk_sequence)
+    {
+        length = m_storage->sequenceLength(block, offset);
+        block = m_storage->sequenceBlock(block, offset);
+        offset = 0;
+    }
+
+    values.resize(length);
+    if (length == 0)
+    {
+        return true;
+    }
+
+    const char* source = m_storage->data(block) + offset;
+    const size_t stride = node->stride;
+    float* target = values.data();
+    switch (node->members[0].kind)
+    {
+    case CORBA::tk_long: convertValues<ACE_CDR::Long>(source, stride, length, target); break;
+    case CORBA::tk_short: convertValues<ACE_CDR::Short>(source, stride, length, target); break;
+    case CORBA::tk_ushort: convertValues<ACE_CDR::UShort>(source, stride, length, target); break;
+    case CORBA::tk_enum:
+    case CORBA::tk_ulong: convertValues<ACE_CDR::ULong>(source, stride, length, target); break;
+    case CORBA::tk_float: convertValues<ACE_CDR::Float>(source, stride, length, target); break;
+    case CORBA::tk_double: convertValues<ACE_CDR::Double>(source, stride, length, target); break;
+    case CORBA::tk_boolean: convertValues<ACE_CDR::Octet>(source, stride, length, target); break;
+    case CORBA::tk_char: convertValues<ACE_CDR::Char>(source, stride, length, target); break;
+    case CORBA::tk_wchar: convertValues<ACE_CDR::WChar>(source, stride, length, target); break;
+    case CORBA::tk_octet: convertValues<ACE_CDR::Octet>(source, stride, length, target); break;
+    case CORBA::tk_longlong: convertValues<ACE_CDR::LongLong>(source, stride, length, target); break;
+    case CORBA::tk_ulonglong: convertValues<ACE_CDR::ULongLong>(source, stride, length, target); break;
+    default:
+        values.clear();
+        return false;
+    }
+
+    return true;
+
+} // End OpenDynamicData::getValues
+
+
+//------------------------------------------------------------------------------
+bool OpenDynamicData::locate(const MemberPath& path, uint32_t& block, size_t& offset) const
+{
+    // Paths are resolved from the top level type
+    if (!m_storage ||
+        !path.isValid() ||
+        path.getLayout() != m_storage->layout() ||
+        m_layout != &m_storage->layout()->root())
+    {
+        return false;
+    }
+
+    // Sequence lengths and blocks only exist once the sample is decoded
+    if (!path.isFixed())
+    {
+        ensureDecoded();
+    }
+
+    return path.locate(*m_storage, block, offset);
 }
 
 
@@ -956,19 +1234,17 @@ void OpenDynamicData::setStringValue(const char* value)
         std::cerr << "Warning: Set a string value to a non-string member: "
                   << getFullName()
                   << std::endl;
-    }
-    m_stringValue = CORBA::string_dup(value);
-}
 
+        return;
+    }
 
-//------------------------------------------------------------------------------
-void OpenDynamicData::setName(const std::string& name)
-{
-    m_name = name;
+    ensureDecoded();
+    m_storage->stringSlot(m_block, m_offset) = value ? value : "";
 }
 
+
 //------------------------------------------------------------------------------
-bool OpenDynamicData::isPrimitiveImpl(const CORBA::TCKind tck) const
+bool OpenDynamicData::isPrimitiveKind(const CORBA::TCKind tck)
 {
     switch (tck)
     {
@@ -1038,78 +1314,190 @@ void OpenDynamicData::populate()
         return;
     }
 
-    const CORBA::TCKind kind = m_typeCode->kind();
+    // Only the top level sample owns the storage; members are views onto it
+    if (m_storage)
+    {
+        return;
+    }
+
+    std::shared_ptr<const SampleLayout> layout = SampleLayout::get(m_typeCode);
+    m_storage = std::make_shared<SampleStorage>(layout);
+    m_layout = &layout->root();
 
-  
-    if((kind == CORBA::tk_array) || (kind == CORBA::tk_sequence))
+} // End OpenDynamicData::populate
+
+
+//------------------------------------------------------------------------------
+bool OpenDynamicData::recycle()
+{
+    // Only the top level sample may reset the shared storage
+    if (!m_storage || m_layout != &m_storage->layout()->root())
     {
-        // If XCDR2 we need to know when deserializing a sequence or array if 
-        // this is a sequence/array of primitive or complex types, so 
-        // we can conditionally deserialize the delimiter header.
-        
-        // Get the true type for this array/sequence
-        CORBA::TypeCode_ptr contentType = m_typeCode->content_type();
-
-        // Follow the alias trail until we have the true type
-        while (contentType->kind() == CORBA::tk_alias)
-        {
-            contentType = TAO::unaliased_typecode(contentType);
-        }
+        return false;
+    }
 
-        m_containsComplexTypes = !isPrimitiveImpl(contentType->kind());
+    {
+        std::lock_guard<std::recursive_mutex> locker(m_storage->viewMutex());
+        m_children.clear();
+        m_childBlock = 0;
+        m_childBytes = 0;
     }
-    else {
-        m_containsComplexTypes = !isPrimitiveImpl(kind);
+
+    // Every remaining reference belongs to a member view held elsewhere
+    if (m_storage.use_count() != 1)
+    {
+        return false;
     }
 
-    // Create child members for each element in array and sequence types
-    if (kind == CORBA::tk_array)
+    m_storage->reset();
+    return true;
+
+} // End OpenDynamicData::recycle
+
+
+//------------------------------------------------------------------------------
+bool OpenDynamicData::setPayload(const std::shared_ptr<const DecodePlan>& plan,
+                                 const ACE_Message_Block& payload,
+                                 const OpenDDS::DCPS::Encoding::Kind encodingKind,
+                                 const OpenDDS::DCPS::Endianness endianness)
+{
+    if (!m_storage || m_layout != &m_storage->layout()->root())
     {
-        const size_t arrayLength = m_typeCode->length();
-        setLength(arrayLength); // Resizes m_children
+        std::cerr << "OpenDynamicData::setPayload: "
+                  << "Only top level samples can hold a payload"
+                  << std::endl;
+        return false;
     }
-    else if (kind == CORBA::tk_sequence)
+
+    m_storage->setPayload(plan, payload, encodingKind, endianness);
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+bool OpenDynamicData::getPayload(const char*& data,
+                                 size_t& length,
+                                 OpenDDS::DCPS::Encoding::Kind& encodingKind,
+                                 OpenDDS::DCPS::Endianness& endianness) const
+{
+    if (!m_storage || m_layout != &m_storage->layout()->root())
     {
-        // Large sequences can cause the application to hang, so set the length
-        // an empty size. It will be resized when data is received.
-        setLength(0);
-        
+        return false;
     }
 
+    return m_storage->getPayload(data, length, encodingKind, endianness);
+}
+
+
+//------------------------------------------------------------------------------
+bool OpenDynamicData::isDecoded() const
+{
+    return !m_storage || m_storage->isDecoded();
+}
 
-    // Create child members for each member of struct types
-    if (kind == CORBA::tk_struct)
+
+//------------------------------------------------------------------------------
+void OpenDynamicData::getSequenceLengths(std::vector<size_t>& lengths) const
+{
+    lengths.clear();
+    if (!m_storage || !m_layout)
     {
-        const CORBA::ULong memberCount = m_typeCode->member_count();
-        for (CORBA::ULong i = 0; i < memberCount; i++)
+        return;
+    }
+
+    ensureDecoded();
+    collectSequenceLengths(*m_layout, m_block, m_offset, lengths);
+}
+
+
+//------------------------------------------------------------------------------
+void OpenDynamicData::collectSequenceLengths(const SampleLayout::Node& node,
+                                             const uint32_t block,
+                                             const size_t offset,
+                                             std::vector<size_t>& lengths) const
+{
+    switch (node.kind)
+    {
+    case CORBA::tk_struct:
+        for (const SampleLayout::Node& member : node.members)
         {
-            CORBA::TypeCode_ptr memberType = m_typeCode->member_type(i);
-            if (!memberType)
-            {
-                std::cerr << "Invalid member type on ["
-                          << i
-                          << "] within "
-                          << m_typeCode->name()
-                          << std::endl;
+            collectSequenceLengths(member, block, offset + member.offset, lengths);
+        }
+        break;
 
-                continue;
+    case CORBA::tk_array:
+        // Arrays of primitives have a fixed shape
+        if (node.containsComplexTypes)
+        {
+            for (size_t i = 0; i < node.length; i++)
+            {
+                collectSequenceLengths(node.members[0], block, offset + i * node.stride, lengths);
             }
+        }
+        break;
 
-            // Follow the alias trail until we have the true type
-            while (memberType->kind() == CORBA::tk_alias)
+    case CORBA::tk_sequence:
+    {
+        const size_t length = m_storage->sequenceLength(block, offset);
+        lengths.push_back(length);
+        if (node.containsComplexTypes)
+        {
+            const uint32_t elementBlock = m_storage->sequenceBlock(block, offset);
+            for (size_t i = 0; i < length; i++)
             {
-                memberType = TAO::unaliased_typecode(memberType);
+                collectSequenceLengths(node.members[0], elementBlock, i * node.stride, lengths);
             }
-            //RJ 2022-01-21 I think older verisons of ddsman will default to topics being appendable, but structs within them being final. I think.
-            const std::string memberName = m_typeCode->member_name(i);
-            std::shared_ptr<OpenDynamicData> newMember = CreateOpenDynamicData(memberType, m_encodingKind,  OpenDDS::DCPS::Extensibility::FINAL, weak_from_this());
-            newMember->setName(memberName);
-            m_children.push_back(newMember);
         }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+} // End OpenDynamicData::collectSequenceLengths
+
+
+//------------------------------------------------------------------------------
+size_t OpenDynamicData::setCharge(const std::function<void(const size_t)>& charge)
+{
+    if (!m_storage || m_layout != &m_storage->layout()->root())
+    {
+        return 0;
+    }
+
+    return m_storage->setCharge(charge);
+}
+
+
+//------------------------------------------------------------------------------
+size_t OpenDynamicData::getByteSize() const
+{
+    std::unique_lock<std::recursive_mutex> locker;
+    if (m_storage)
+    {
+        locker = std::unique_lock<std::recursive_mutex>(m_storage->viewMutex());
+    }
+
+    size_t bytes = sizeof(OpenDynamicData) + m_name.capacity() +
+                   m_children.capacity() * sizeof(std::shared_ptr<OpenDynamicData>);
+
+    for (const std::shared_ptr<OpenDynamicData>& child : m_children)
+    {
+        if (child)
+        {
+            bytes += child->getByteSize();
+        }
+    }
 
-    } // End struct check
+    // The storage is shared by the whole tree, so only the root counts it
+    if (m_storage && m_layout == &m_storage->layout()->root())
+    {
+        bytes += m_storage->byteSize();
+    }
 
-} // End OpenDynamicData::populate
+    return bytes;
+}
 
 
 /**
@@ -6,9 +6,13 @@
 #include <dds/DCPS/TypeSupportImpl.h>
 #include <tao/AnyTypeCode/TypeCode.h>
 #include <cctype>
+#include <functional>
 #include <string>
 #include <vector>
 
+#include "member_path.h"
+#include "sample_layout.h"
+
 /// Simplified noncopyable without Boost
 class noncopyable
 {
@@ -24,6 +28,13 @@ public:
  * @brief Non-standard dynamic data class with similar features to XTypes
  *        with OpenDDS.
  *
+ * @details The member values of a sample live in a single SampleStorage
+ *          buffer laid out by SampleLayout. Every OpenDynamicData object is a
+ *          lightweight view onto one member of that buffer. Child views are
+ *          only created when a member is accessed. A sample may be created
+ *          from a serialized payload, which is then only decoded when a member
+ *          value is first read.
+ *
  * @remarks This class will not be required when OpenDDS implements
  *          dds::core::xtypes::DynamicData.
  */
@@ -38,12 +49,10 @@ public:
      * @param[in] typeCode The type definition pointer for this type.
      * @param[in] encodingKind the encoding kind for this type. XCDR1 or XCDR2
      * @param[in] extensibility the extensibility for this type. final/appendable/mutable.
-     * @param[in] parent The parent of this member or nullptr if it's the root.
      */
     OpenDynamicData(const CORBA::TypeCode* typeCode,
                     const OpenDDS::DCPS::Encoding::Kind encodingKind, 
-                    const OpenDDS::DCPS::Extensibility extensibility,
-                    const std::weak_ptr<OpenDynamicData> parent = std::weak_ptr<OpenDynamicData>());
+                    const OpenDDS::DCPS::Extensibility extensibility);
 
     /**
      * @brief Destructor for the flexible DDS sample class.
@@ -185,31 +194,50 @@ public:
     template<class T>
     T getValue() const
     {
-        switch (m_typeCode->kind())
+        return loadAs<T>(getKind(), m_block, m_offset);
+    }
+
+    /**
+     * @brief Get the value of a member of this sample by a resolved path.
+     * @remarks Only valid for top level samples.
+     * @param[in] path The member path, resolved for this sample type.
+     * @param[out] value The value of the member.
+     * @return False if the member doesn't exist in this sample.
+     */
+    template<class T>
+    bool getValue(const MemberPath& path, T& value) const
+    {
+        uint32_t block = 0;
+        size_t offset = 0;
+        if (!locate(path, block, offset))
         {
-        case CORBA::tk_long: return static_cast<T>(m_value.int32);
-        case CORBA::tk_short: return static_cast<T>(m_value.int16);
-        case CORBA::tk_ushort: return static_cast<T>(m_value.uint16);
-        case CORBA::tk_enum:
-        case CORBA::tk_ulong: return static_cast<T>(m_value.uint32);
-        case CORBA::tk_float: return static_cast<T>(m_value.float32);
-        case CORBA::tk_double: return static_cast<T>(m_value.float64);
-        case CORBA::tk_boolean: return static_cast<T>(m_value.boolean);
-        case CORBA::tk_char: return static_cast<T>(m_value.char8);
-        case CORBA::tk_wchar: return static_cast<T>(m_value.char16);
-        case CORBA::tk_octet: return static_cast<T>(m_value.uint8);
-        case CORBA::tk_longlong: return static_cast<T>(m_value.int64);
-        case CORBA::tk_ulonglong: return static_cast<T>(m_value.uint64);
-        default:
-            std::cerr << "OpenDynamicData::getValue: "
-                      << "Unsupported type (" << m_typeCode->kind() << ")"
-                      << std::endl;
-            break;
+            return false;
         }
 
-        return static_cast<T>(0);
+        value = loadAs<T>(path.getKind(), block, offset);
+        return true;
+    }
+
+    /**
+     * @brief Get the value of a string member of this sample by a resolved path.
+     * @remarks Only valid for top level samples.
+     * @param[in] path The member path, resolved for this sample type.
+     * @param[out] value The string value of the member.
+     * @return False if the member doesn't exist in this sample.
+     */
+    bool getStringValue(const MemberPath& path, const char*& value) const;
 
-    } // End OpenDynamicData::getValue
+    /**
+     * @brief Get the elements of a numeric array or sequence member of this
+     *        sample by a resolved path.
+     * @remarks Only valid for top level samples. The elements are converted
+     *          straight from the storage block.
+     * @param[in] path The array or sequence member path.
+     * @param[out] values Replaced with the element values.
+     * @return False if the member doesn't exist in this sample or doesn't
+     *         hold primitive elements.
+     */
+    bool getValues(const MemberPath& path, std::vector<float>& values) const;
 
     /**
      * @brief Set the value for this member.
@@ -218,50 +246,158 @@ public:
     template<class T>
     void setValue(const T& value)
     {
-        switch (m_typeCode->kind())
+        switch (getKind())
         {
-        case CORBA::tk_long: m_value.int32 = static_cast<CORBA::Long>(value); break;
-        case CORBA::tk_short: m_value.int16  = static_cast<CORBA::Short>(value); break;
-        case CORBA::tk_ushort: m_value.uint16  = static_cast<CORBA::UShort>(value); break;
+        case CORBA::tk_long: store(static_cast<ACE_CDR::Long>(value)); break;
+        case CORBA::tk_short: store(static_cast<ACE_CDR::Short>(value)); break;
+        case CORBA::tk_ushort: store(static_cast<ACE_CDR::UShort>(value)); break;
         case CORBA::tk_enum:
-        case CORBA::tk_ulong: m_value.uint32  = static_cast<CORBA::ULong>(value); break;
-        case CORBA::tk_float: m_value.float32  = static_cast<CORBA::Float>(value); break;
-        case CORBA::tk_double: m_value.float64  = static_cast<CORBA::Double>(value); break;
-        case CORBA::tk_boolean: m_value.boolean  = static_cast<CORBA::Boolean>(value); break;
-        case CORBA::tk_char: m_value.char8  = static_cast<CORBA::Char>(value); break;
-        case CORBA::tk_wchar: m_value.char16  = static_cast<CORBA::WChar>(value); break;
-        case CORBA::tk_octet: m_value.uint8  = static_cast<CORBA::Octet>(value); break;
-        case CORBA::tk_longlong: m_value.int64  = static_cast<CORBA::LongLong>(value); break;
-        case CORBA::tk_ulonglong: m_value.uint64  = static_cast<CORBA::ULongLong>(value); break;
+        case CORBA::tk_ulong: store(static_cast<ACE_CDR::ULong>(value)); break;
+        case CORBA::tk_float: store(static_cast<ACE_CDR::Float>(value)); break;
+        case CORBA::tk_double: store(static_cast<ACE_CDR::Double>(value)); break;
+        case CORBA::tk_boolean: store(static_cast<ACE_CDR::Boolean>(value)); break;
+        case CORBA::tk_char: store(static_cast<ACE_CDR::Char>(value)); break;
+        case CORBA::tk_wchar: store(static_cast<ACE_CDR::WChar>(value)); break;
+        case CORBA::tk_octet: store(static_cast<ACE_CDR::Octet>(value)); break;
+        case CORBA::tk_longlong: store(static_cast<ACE_CDR::LongLong>(value)); break;
+        case CORBA::tk_ulonglong: store(static_cast<ACE_CDR::ULongLong>(value)); break;
         default:
             std::cerr << "OpenDynamicData::setValue: "
-                      << "Unsupported type (" << m_typeCode->kind() << ")"
+                      << "Unsupported type (" << getKind() << ")"
                       << std::endl;
             break;
         }
 
     } // End OpenDynamicData::setValue
 
-        /**
-     * @brief Recursively populate the internal data structure.
+    /**
+     * @brief Allocate the value storage for a top level sample.
      */
     void populate();
 
+    /**
+     * @brief Return a top level sample to its default values for reuse.
+     * @remarks The cached member views are dropped. The reset is refused if a
+     *          member view of this sample is still held elsewhere.
+     * @return True if the sample was reset; false otherwise.
+     */
+    bool recycle();
+
+    /**
+     * @brief Keep a serialized payload to be decoded on first access.
+     * @remarks Only valid for top level samples.
+     * @param[in] plan The decode plan for the sample type.
+     * @param[in] payload The serialized sample.
+     * @param[in] encodingKind The encoding kind of the payload.
+     * @param[in] endianness The byte order of the payload.
+     * @return True if the operation was successful; false otherwise.
+     */
+    bool setPayload(const std::shared_ptr<const DecodePlan>& plan,
+                    const ACE_Message_Block& payload,
+                    const OpenDDS::DCPS::Encoding::Kind encodingKind,
+                    const OpenDDS::DCPS::Endianness endianness);
+
+    /**
+     * @brief Get the serialized payload this sample was received with.
+     * @remarks Only top level samples hold a payload.
+     * @param[out] data The first byte of the payload.
+     * @param[out] length The payload length in bytes.
+     * @param[out] encodingKind The encoding kind of the payload.
+     * @param[out] endianness The byte order of the payload.
+     * @return False if the sample holds no payload.
+     */
+    bool getPayload(const char*& data,
+                    size_t& length,
+                    OpenDDS::DCPS::Encoding::Kind& encodingKind,
+                    OpenDDS::DCPS::Endianness& endianness) const;
+
+    /**
+     * @brief Get whether the member values of this sample were decoded.
+     * @return False if a pending payload still has to be decoded.
+     */
+    bool isDecoded() const;
+
+    /**
+     * @brief Get the element count of every sequence in this sample.
+     * @details The counts are listed depth first, in member order. Two samples
+     *          of the same type have the same members exactly when their
+     *          counts match, so this is a cheap key for the member shape.
+     * @param[out] lengths Replaced with the sequence element counts.
+     */
+    void getSequenceLengths(std::vector<size_t>& lengths) const;
+
+    /**
+     * @brief Get the number of bytes held by this sample.
+     * @remarks Includes the retained payload, the decoded values and any
+     *          member objects created so far.
+     * @return The size in bytes.
+     */
+    size_t getByteSize() const;
+
+    /**
+     * @brief Report later growth of this sample to whoever stores it.
+     * @details Decoding and member views created on first access grow a
+     *          sample after getByteSize() measured it.
+     * @remarks Only valid for top level samples. Thread safe.
+     * @param[in] charge Called with each growth in bytes, or empty to detach.
+     * @return The bytes passed to the previous function.
+     */
+    size_t setCharge(const std::function<void(const size_t)>& charge);
+
+    /**
+     * @brief Get the number of bytes this member occupies in XCDR.
+     * @return The serialized size, including any delimiter headers.
+     */
     size_t getEncapsulationLength();
 
+    /**
+     * @brief Get whether a type kind is a primitive kind.
+     * @param[in] tck The type kind to check.
+     * @return true if primitive type. false if not.
+     */
+    static bool isPrimitiveKind(const CORBA::TCKind tck);
+
 private:
 
+    /// The decode plan writes member values directly.
+    friend class DecodePlan;
+
     /**
-     * @brief Set the name of a child member.
-     * @param[in] name The name of the child member.
+     * @brief Constructor for a view onto a member of an existing sample.
+     * @param[in] storage The value storage of the sample.
+     * @param[in] layout The layout of this member.
+     * @param[in] block The storage block holding this member.
+     * @param[in] offset The byte offset of this member within the block.
+     * @param[in] name The name of this member.
+     * @param[in] encodingKind the encoding kind for this type. XCDR1 or XCDR2
+     * @param[in] parent The parent of this member.
      */
-    void setName(const std::string& name);
+    OpenDynamicData(const std::shared_ptr<SampleStorage>& storage,
+                    const SampleLayout::Node* layout,
+                    const uint32_t block,
+                    const size_t offset,
+                    const std::string& name,
+                    const OpenDDS::DCPS::Encoding::Kind encodingKind,
+                    const std::weak_ptr<OpenDynamicData> parent);
 
     /**
-     * @brief Get whether a type is a primitive kind. Required for serializing xcdr2 properly.
-     * @return true if primitive type. false if not. 
+     * @brief Make sure the child views match the current storage.
+     * @remarks Sequence element views are recreated if the sequence was
+     *          resized since they were built. Thread safe.
+     */
+    void syncChildren() const;
+
+    /**
+     * @brief Recursively collect the sequence element counts of a member.
+     * @param[in] node The layout of the member.
+     * @param[in] block The storage block holding the member.
+     * @param[in] offset The byte offset of the member within the block.
+     * @param[out] lengths Append the sequence element counts here.
      */
-    bool isPrimitiveImpl(const CORBA::TCKind tck) const;
+    void collectSequenceLengths(const SampleLayout::Node& node,
+                                const uint32_t block,
+                                const size_t offset,
+                                std::vector<size_t>& lengths) const;
 
     /**
      * @brief Does this type contain child data.  Used to determine if the type needs recursive handling.
@@ -269,6 +405,96 @@ private:
      */
     bool isContainerType(const CORBA::TCKind tck) const;
 
+    /**
+     * @brief Decode the pending payload of the sample, if any.
+     */
+    void ensureDecoded() const
+    {
+        if (m_storage && !m_storage->isDecoded())
+        {
+            m_storage->decode();
+        }
+    }
+
+    /**
+     * @brief Find a member of this sample by a resolved path.
+     * @param[in] path The member path.
+     * @param[out] block The storage block holding the member.
+     * @param[out] offset The byte offset of the member within the block.
+     * @return False if the path doesn't apply to this sample.
+     */
+    bool locate(const MemberPath& path, uint32_t& block, size_t& offset) const;
+
+    /**
+     * @brief Read a fixed size value from the storage as another type.
+     * @param[in] kind The type kind of the stored value.
+     * @param[in] block The storage block holding the value.
+     * @param[in] offset The byte offset of the value within the block.
+     * @return The converted value or 0 if we found an unsupported type.
+     */
+    template<class T>
+    T loadAs(const CORBA::TCKind kind, const uint32_t block, const size_t offset) const
+    {
+        switch (kind)
+        {
+        case CORBA::tk_long: return static_cast<T>(load<ACE_CDR::Long>(block, offset));
+        case CORBA::tk_short: return static_cast<T>(load<ACE_CDR::Short>(block, offset));
+        case CORBA::tk_ushort: return static_cast<T>(load<ACE_CDR::UShort>(block, offset));
+        case CORBA::tk_enum:
+        case CORBA::tk_ulong: return static_cast<T>(load<ACE_CDR::ULong>(block, offset));
+        case CORBA::tk_float: return static_cast<T>(load<ACE_CDR::Float>(block, offset));
+        case CORBA::tk_double: return static_cast<T>(load<ACE_CDR::Double>(block, offset));
+        case CORBA::tk_boolean: return static_cast<T>(load<ACE_CDR::Octet>(block, offset) != 0);
+        case CORBA::tk_char: return static_cast<T>(load<ACE_CDR::Char>(block, offset));
+        case CORBA::tk_wchar: return static_cast<T>(load<ACE_CDR::WChar>(block, offset));
+        case CORBA::tk_octet: return static_cast<T>(load<ACE_CDR::Octet>(block, offset));
+        case CORBA::tk_longlong: return static_cast<T>(load<ACE_CDR::LongLong>(block, offset));
+        case CORBA::tk_ulonglong: return static_cast<T>(load<ACE_CDR::ULongLong>(block, offset));
+        default:
+            std::cerr << "OpenDynamicData::getValue: "
+                      << "Unsupported type (" << kind << ")"
+                      << std::endl;
+            break;
+        }
+
+        return static_cast<T>(0);
+
+    } // End OpenDynamicData::loadAs
+
+    /**
+     * @brief Read a fixed size value from the storage.
+     * @remarks Top level members at a fixed CDR position are read from a
+     *          pending payload without decoding it.
+     * @param[in] block The storage block holding the value.
+     * @param[in] offset The byte offset of the value within the block.
+     * @return The stored value.
+     */
+    template<class V>
+    V load(const uint32_t block, const size_t offset) const
+    {
+        if (!m_storage->isDecoded())
+        {
+            V value;
+            if (block == 0 && m_storage->peek(offset, value))
+            {
+                return value;
+            }
+            m_storage->decode();
+        }
+
+        return m_storage->load<V>(block, offset);
+    }
+
+    /**
+     * @brief Write the fixed size value of this member to the storage.
+     * @param[in] value The new value of this member.
+     */
+    template<class V>
+    void store(const V& value)
+    {
+        ensureDecoded();
+        m_storage->store<V>(m_block, m_offset, value);
+    }
 
     /// Stores all primitive data types.
     union SimpleTypeUnion
@@ -287,8 +513,28 @@ private:
         ACE_CDR::Boolean boolean;
     };
 
-    /// Stores the child members.
-    std::vector<std::shared_ptr<OpenDynamicData>> m_children;
+    /// The value storage shared by every member of the sample.
+    std::shared_ptr<SampleStorage> m_storage;
+
+    /// The layout of this member within the storage.
+    const SampleLayout::Node* m_layout;
+
+    /// The storage block holding this member.
+    uint32_t m_block;
+
+    /// The byte offset of this member within the block.
+    size_t m_offset;
+
+    /// The child member views, created on first access under the view lock
+    /// of the storage.
+    mutable std::vector<std::shared_ptr<OpenDynamicData>> m_children;
+
+    /// The sequence element block the child views were created for.
+    mutable uint32_t m_childBlock;
+
+    /// The most bytes the child views held so far. Growth past this is
+    /// charged to the storage.
+    mutable size_t m_childBytes;
 
     /// Stores the parent of this member or nullptr if it's the root.
     const std::weak_ptr<OpenDynamicData> m_parent;
@@ -296,12 +542,6 @@ private:
     /// The name of this member.
     std::string m_name;
 
-    /// The value of this member for primitive types.
-    SimpleTypeUnion m_value;
-
-    /// The value of this member for the string type.
-    TAO::String_Manager m_stringValue;
-
     /// The type code for this member.
     const CORBA::TypeCode* m_typeCode;
 
@@ -311,15 +551,11 @@ private:
     /// The extensibility of this type. Required by Serializer.
     const OpenDDS::DCPS::Extensibility m_extensibility;
 
-    /// Boolean indicating whether this type contains complex types. Only valid if this type is sequence or array.
-    bool m_containsComplexTypes;
-
 }; // End class OpenDynamicData
 
 std::shared_ptr<OpenDynamicData> CreateOpenDynamicData(const CORBA::TypeCode* typeCode,
     const OpenDDS::DCPS::Encoding::Kind encodingKind, 
-    const OpenDDS::DCPS::Extensibility extensibility,
-    const std::weak_ptr<OpenDynamicData> parent = std::weak_ptr<OpenDynamicData>());
+    const OpenDDS::DCPS::Extensibility extensibility);
 
 #endif
 
@@ -0,0 +1,90 @@
+#include "plot_feed.h"
+#include "open_dynamic_data.h"
+#include "topic_history.h"
+
+#include <cstdlib>
+
+
+//------------------------------------------------------------------------------
+PlotFeed::PlotFeed(const MemberPath& memberPath, const size_t capacity) :
+                   m_memberPath(memberPath),
+                   m_points(capacity)
+{}
+
+
+//------------------------------------------------------------------------------
+const MemberPath& PlotFeed::memberPath() const
+{
+    return m_memberPath;
+}
+
+
+//------------------------------------------------------------------------------
+void PlotFeed::push(const SampleInfo& info, const OpenDynamicData& sample)
+{
+    PlotPoint point;
+    point.time = info.sourceTime > 0 ? info.sourceTime : info.receiveTime;
+    point.value = 0.0;
+
+    // Plotted strings are parsed as numbers, like CommonData::readValue()
+    bool found = false;
+    switch (m_memberPath.getKind())
+    {
+    case CORBA::tk_long:
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+    case CORBA::tk_ulong:
+    case CORBA::tk_float:
+    case CORBA::tk_double:
+    case CORBA::tk_boolean:
+    case CORBA::tk_enum:
+    case CORBA::tk_char:
+    case CORBA::tk_wchar:
+    case CORBA::tk_octet:
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+        found = sample.getValue(m_memberPath, point.value);
+        break;
+    case CORBA::tk_string:
+    {
+        const char* value = nullptr;
+        found = sample.getStringValue(m_memberPath, value) && value;
+        point.value = found ? std::strtod(value, nullptr) : 0.0;
+        break;
+    }
+    default:
+        break;
+    }
+
+    if (!found)
+    {
+        return;
+    }
+
+    PlotPoint* slot = m_points.claim();
+    if (slot)
+    {
+        *slot = point;
+        m_points.publish();
+    }
+
+} // End PlotFeed::push
+
+
+//------------------------------------------------------------------------------
+size_t PlotFeed::drain(std::vector<PlotPoint>& points)
+{
+    return m_points.drain(points);
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t PlotFeed::droppedCount() const
+{
+    return m_points.droppedCount();
+}
+
+
+/**
+ * @}
+ */
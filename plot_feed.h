@@ -0,0 +1,97 @@
+#ifndef __PLOT_FEED_H__
+#define __PLOT_FEED_H__
+
+#include "member_path.h"
+#include "spsc_ring.h"
+
+#include <cstdint>
+#include <vector>
+
+class OpenDynamicData;
+struct SampleInfo;
+
+
+/**
+ * @brief A timestamped value of a plotted variable.
+ */
+struct PlotPoint
+{
+    /// The source timestamp in nanoseconds since the epoch, or the receive
+    /// timestamp if the sample has no source timestamp.
+    int64_t time;
+
+    /// The value of the variable.
+    double value;
+};
+
+
+/**
+ * @brief Hands every stored value of a plotted variable to the graph.
+ *
+ * @details A single producer, single consumer ring of points. TopicHistory
+ *          pushes the member value of each stored sample under its feed
+ *          lock, so there is only ever one producer, and the graph drains
+ *          the new points on its refresh tick. Neither side locks.
+ *
+ *          The ring is sized for several seconds of a fast topic between
+ *          ticks. If the graph falls that far behind, for instance while
+ *          paused, the newest points are dropped and counted.
+ */
+class PlotFeed
+{
+public:
+
+    /**
+     * @brief Constructor for the plot feed.
+     * @param[in] memberPath The plotted member, resolved for the topic type.
+     * @param[in] capacity The number of points buffered. Rounded up to a
+     *            power of two.
+     */
+    PlotFeed(const MemberPath& memberPath, const size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Get the plotted member.
+     * @return The resolved member path.
+     */
+    const MemberPath& memberPath() const;
+
+    /**
+     * @brief Read the plotted member of a stored sample and buffer it.
+     * @remarks Producer side. Called by TopicHistory with its feed lock held.
+     * @param[in] info The bookkeeping of the stored sample.
+     * @param[in] sample The stored sample.
+     */
+    void push(const SampleInfo& info, const OpenDynamicData& sample);
+
+    /**
+     * @brief Move the buffered points to a list.
+     * @remarks Consumer side. Only called from the GUI thread.
+     * @param[out] points The points are appended here, oldest first.
+     * @return The number of points appended.
+     */
+    size_t drain(std::vector<PlotPoint>& points);
+
+    /**
+     * @brief Get the number of points dropped because the ring was full.
+     * @return The dropped point count.
+     */
+    uint64_t droppedCount() const;
+
+    /// The default number of points buffered.
+    static const size_t DEFAULT_CAPACITY = 65536;
+
+private:
+
+    /// The plotted member.
+    const MemberPath m_memberPath;
+
+    /// The ring of points.
+    SpscRing<PlotPoint> m_points;
+
+}; // End class PlotFeed
+
+#endif
+
+/**
+ * @}
+ */
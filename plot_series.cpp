@@ -0,0 +1,561 @@
+#include "plot_series.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+//------------------------------------------------------------------------------
+PlotSeries::PlotSeries(const size_t capacity) :
+                       m_levels(SUMMARY_LEVELS + 1),
+                       m_first(0),
+                       m_windowCount(0),
+                       m_xMin(0.0),
+                       m_xMax(0.0),
+                       m_scale(1.0),
+                       m_shift(0.0),
+                       m_resolution(0),
+                       m_decimated(false),
+                       m_columnLevel(0),
+                       m_columnWidth(0.0),
+                       m_servedFirst(0),
+                       m_servedCount(0),
+                       m_stableCount(0),
+                       m_boundsValid(false)
+{
+    size_t size = std::max<size_t>(capacity, 1);
+    uint64_t span = 1;
+    for (size_t l = 0; l < m_levels.size(); l++)
+    {
+        Level& level = m_levels[l];
+        level.span = span;
+        level.x.resize(size);
+        level.low.resize(size);
+        if (l > 0)
+        {
+            level.high.resize(size);
+            level.mean.resize(size);
+        }
+
+        // The summary levels all hold the same number of summaries
+        size = std::max<size_t>(std::max<size_t>(capacity, 1) / LEVEL_FACTOR, 1);
+        span *= LEVEL_FACTOR;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::append(const double x, const double y)
+{
+    appendPoint(m_levels[0], x, y);
+
+    // Grow the open summary of each level or start a new one
+    for (size_t l = 1; l < m_levels.size(); l++)
+    {
+        Level& level = m_levels[l];
+        if (level.count == 0 || level.openCount == level.span)
+        {
+            appendPoint(level, x, y);
+            level.openCount = 1;
+            continue;
+        }
+
+        const size_t newest = position(level, level.count - 1);
+        level.openCount++;
+        level.low[newest] = std::min(level.low[newest], y);
+        level.high[newest] = std::max(level.high[newest], y);
+        level.mean[newest] += (y - level.mean[newest]) / level.openCount;
+    }
+
+    updateWindow();
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::clear()
+{
+    for (Level& level : m_levels)
+    {
+        level.head = 0;
+        level.count = 0;
+        level.openCount = 0;
+    }
+
+    m_columns.clear();
+    updateWindow();
+    decimate();
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotSeries::count() const
+{
+    return m_levels[0].count;
+}
+
+
+//------------------------------------------------------------------------------
+QPointF PlotSeries::latest() const
+{
+    const Level& raw = m_levels[0];
+    if (raw.count == 0)
+    {
+        return QPointF(0.0, 0.0);
+    }
+
+    const size_t newest = position(raw, raw.count - 1);
+    return QPointF(raw.x[newest], raw.low[newest]);
+}
+
+
+//------------------------------------------------------------------------------
+QPointF PlotSeries::oldest() const
+{
+    // The coarsest level reaches back the furthest
+    for (size_t l = m_levels.size(); l > 0; l--)
+    {
+        const Level& level = m_levels[l - 1];
+        if (level.count > 0)
+        {
+            return QPointF(level.x[level.head], meanValues(level)[level.head]);
+        }
+    }
+
+    return QPointF(0.0, 0.0);
+}
+
+
+//------------------------------------------------------------------------------
+double PlotSeries::valueAt(const double x) const
+{
+    for (const Level& level : m_levels)
+    {
+        if (level.count > 0 && (reaches(level, x) || &level == &m_levels.back()))
+        {
+            const size_t after = findPoint(level, x, true);
+            return meanValues(level)[position(level, after > 0 ? after - 1 : 0)];
+        }
+    }
+
+    return 0.0;
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::setWindow(const double xMin, const double xMax)
+{
+    m_xMin = xMin;
+    m_xMax = xMax;
+    updateWindow();
+    decimate();
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::setResolution(const int columns)
+{
+    if (columns != m_resolution)
+    {
+        m_resolution = std::max(columns, 0);
+        m_columns.clear();
+        decimate();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool PlotSeries::isDecimated() const
+{
+    return m_decimated;
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotSeries::stableCount() const
+{
+    return m_stableCount;
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::setBias(const double scale, const double shift)
+{
+    if (scale != m_scale || shift != m_shift)
+    {
+        m_scale = scale;
+        m_shift = shift;
+        m_boundsValid = false;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotSeries::size() const
+{
+    return m_decimated ? m_decimatedPoints.size() : m_windowCount;
+}
+
+
+//------------------------------------------------------------------------------
+QPointF PlotSeries::sample(size_t i) const
+{
+    if (m_decimated)
+    {
+        const QPointF& point = m_decimatedPoints[i];
+        return QPointF(point.x(), point.y() * m_scale + m_shift);
+    }
+
+    const Level& raw = m_levels[0];
+    const size_t pos = position(raw, m_first + i);
+    return QPointF(raw.x[pos], raw.low[pos] * m_scale + m_shift);
+}
+
+
+//------------------------------------------------------------------------------
+QRectF PlotSeries::boundingRect() const
+{
+    if (m_boundsValid)
+    {
+        return m_bounds;
+    }
+
+    // An invalid rectangle tells Qwt there is nothing to scale to
+    m_bounds = QRectF(1.0, 1.0, -2.0, -2.0);
+    const size_t count = size();
+    if (count > 0)
+    {
+        double yMin = sample(0).y();
+        double yMax = yMin;
+        for (size_t i = 1; i < count; i++)
+        {
+            const double y = sample(i).y();
+            yMin = std::min(yMin, y);
+            yMax = std::max(yMax, y);
+        }
+
+        const double xMin = sample(0).x();
+        const double xMax = sample(count - 1).x();
+        m_bounds = QRectF(xMin, yMin, xMax - xMin, yMax - yMin);
+    }
+
+    m_boundsValid = true;
+    return m_bounds;
+
+} // End PlotSeries::boundingRect
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::appendPoint(Level& level, const double x, const double y)
+{
+    size_t pos = level.head;
+    if (level.count < level.x.size())
+    {
+        pos = position(level, level.count);
+        level.count++;
+    }
+    else
+    {
+        // Overwrite the oldest point
+        level.head = (level.head + 1) % level.x.size();
+    }
+
+    level.x[pos] = x;
+    level.low[pos] = y;
+    if (!level.high.empty())
+    {
+        level.high[pos] = y;
+        level.mean[pos] = y;
+    }
+
+    level.appended++;
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotSeries::position(const Level& level, const size_t index)
+{
+    return (level.head + index) % level.x.size();
+}
+
+
+//------------------------------------------------------------------------------
+const std::vector<double>& PlotSeries::highValues(const Level& level)
+{
+    return level.high.empty() ? level.low : level.high;
+}
+
+
+//------------------------------------------------------------------------------
+const std::vector<double>& PlotSeries::meanValues(const Level& level)
+{
+    return level.mean.empty() ? level.low : level.mean;
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotSeries::findPoint(const Level& level, const double x, const bool after)
+{
+    size_t low = 0;
+    size_t high = level.count;
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        const double value = level.x[position(level, middle)];
+        if (after ? value <= x : value < x)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+//------------------------------------------------------------------------------
+bool PlotSeries::reaches(const Level& level, const double x)
+{
+    return level.appended == level.count ||
+           (level.count > 0 && level.x[level.head] <= x);
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::updateWindow()
+{
+    const Level& raw = m_levels[0];
+    m_first = findPoint(raw, m_xMin, false);
+    const size_t last = findPoint(raw, m_xMax, true);
+    m_windowCount = last > m_first ? last - m_first : 0;
+    m_boundsValid = false;
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::decimate()
+{
+    const size_t columns = static_cast<size_t>(m_resolution);
+    const double width = columns > 0 ? (m_xMax - m_xMin) / columns : 0.0;
+    const size_t rawLimit = DECIMATION_FACTOR * columns;
+
+    // Use the finest level reaching back to the window start that doesn't
+    // have too many points per column, or else the coarsest one
+    size_t chosen = m_levels.size() - 1;
+    for (size_t l = 0; l < m_levels.size() && width > 0.0; l++)
+    {
+        const Level& level = m_levels[l];
+        const size_t first = findPoint(level, m_xMin, false);
+        const size_t last = findPoint(level, m_xMax, true);
+        if (reaches(level, m_xMin) && last - std::min(first, last) <= LEVEL_FACTOR * rawLimit)
+        {
+            chosen = l;
+            break;
+        }
+    }
+
+    const bool wasDecimated = m_decimated;
+    m_decimated = width > 0.0 && (chosen > 0 || m_windowCount > rawLimit);
+    m_boundsValid = false;
+    if (!m_decimated)
+    {
+        // The raw points are unchanged if the window starts at the same one
+        const Level& raw = m_levels[0];
+        const uint64_t servedFirst = raw.appended - raw.count + m_first;
+        m_stableCount = !wasDecimated && servedFirst == m_servedFirst ?
+            std::min(m_servedCount, m_windowCount) : 0;
+        m_servedFirst = servedFirst;
+        m_servedCount = m_windowCount;
+
+        m_columns.clear();
+        m_decimatedPoints.clear();
+        return;
+    }
+
+    // The cached columns only fit this zoom level and resolution
+    if (width != m_columnWidth || chosen != m_columnLevel)
+    {
+        m_columns.clear();
+        m_columnWidth = width;
+        m_columnLevel = chosen;
+    }
+
+    const Level& level = m_levels[m_columnLevel];
+    const int64_t firstBin = static_cast<int64_t>(std::floor(m_xMin / width));
+    const int64_t lastBin = static_cast<int64_t>(std::floor(m_xMax / width));
+    const uint64_t oldest = level.appended - level.count;
+
+    // Forget the columns that scrolled out of view
+    while (!m_columns.empty() && m_columns.front().bin < firstBin)
+    {
+        m_columns.pop_front();
+    }
+    while (!m_columns.empty() && m_columns.back().bin > lastBin)
+    {
+        m_columns.pop_back();
+    }
+
+    // A summary starting left of the window also covers points inside it
+    size_t start = findPoint(level, firstBin * width, false);
+    if (m_columnLevel > 0 && start > 0)
+    {
+        start--;
+    }
+    const size_t end = findPoint(level, (lastBin + 1) * width, false);
+    if (m_columns.empty() || m_columns.front().first < oldest)
+    {
+        m_columns.clear();
+        binPoints(start, end, m_columns);
+    }
+    else
+    {
+        // Bin the columns that scrolled in on the left
+        const size_t cachedStart = static_cast<size_t>(m_columns.front().first - oldest);
+        if (start < cachedStart)
+        {
+            std::deque<Column> added;
+            binPoints(start, cachedStart, added);
+            m_columns.insert(m_columns.begin(), added.begin(), added.end());
+        }
+
+        // The last column may have grown, and its newest summary may still be
+        // open, so bin it again with the new points
+        const size_t redoStart = static_cast<size_t>(m_columns.back().first - oldest);
+        m_columns.pop_back();
+        binPoints(redoStart, std::max(redoStart, end), m_columns);
+    }
+
+    // Serve up to 4 points per column. Which of the minimum and maximum came
+    // first doesn't matter, since they're drawn in the same pixel column.
+    m_previousPoints.swap(m_decimatedPoints);
+    m_decimatedPoints.clear();
+    for (const Column& column : m_columns)
+    {
+        m_decimatedPoints.push_back(column.firstPoint);
+        if (column.count > 2 || m_columnLevel > 0)
+        {
+            const double middle = (column.firstPoint.x() + column.lastPoint.x()) / 2.0;
+            m_decimatedPoints.push_back(QPointF(middle, column.min));
+            m_decimatedPoints.push_back(QPointF(middle, column.max));
+        }
+        if (column.count > 1)
+        {
+            m_decimatedPoints.push_back(column.lastPoint);
+        }
+    }
+
+    m_stableCount = 0;
+    if (wasDecimated)
+    {
+        const size_t common = std::min(m_previousPoints.size(), m_decimatedPoints.size());
+        while (m_stableCount < common &&
+               m_previousPoints[m_stableCount] == m_decimatedPoints[m_stableCount])
+        {
+            m_stableCount++;
+        }
+    }
+
+} // End PlotSeries::decimate
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::binPoints(const size_t start,
+                           const size_t end,
+                           std::deque<Column>& columns) const
+{
+    const Level& level = m_levels[m_columnLevel];
+    const std::vector<double>& means = meanValues(level);
+    const int64_t firstBin = static_cast<int64_t>(std::floor(m_xMin / m_columnWidth));
+
+    size_t index = start;
+    while (index < end)
+    {
+        const size_t pos = position(level, index);
+        Column column;
+        column.bin = static_cast<int64_t>(std::floor(level.x[pos] / m_columnWidth));
+        column.first = level.appended - level.count + index;
+
+        // Always take at least one point, in case of rounding at the edge
+        const size_t next = std::min(
+            std::max(findPoint(level, (column.bin + 1) * m_columnWidth, false), index + 1), end);
+
+        // A summary is drawn at its mean, between its extremes. One that
+        // starts left of the window gets a column of its own, which is drawn
+        // at the window edge and binned again on every update.
+        const size_t last = position(level, next - 1);
+        const double firstX = column.bin < firstBin ? m_xMin : level.x[pos];
+        const double lastX = column.bin < firstBin ? m_xMin : level.x[last];
+        column.count = next - index;
+        column.firstPoint = QPointF(firstX, means[pos]);
+        column.lastPoint = QPointF(lastX, means[last]);
+        findExtremes(index, next, column.min, column.max);
+
+        columns.push_back(column);
+        index = next;
+    }
+
+} // End PlotSeries::binPoints
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::findExtremes(const size_t start,
+                              const size_t end,
+                              double& low,
+                              double& high) const
+{
+    const Level& level = m_levels[m_columnLevel];
+    const std::vector<double>& highs = highValues(level);
+    low = level.low[position(level, start)];
+    high = highs[position(level, start)];
+
+    // Scan the contiguous parts of the ring. Each lane keeps its own
+    // extremes, so the lanes don't depend on each other and map onto SIMD
+    // min and max instructions without reordering any comparisons.
+    const size_t LANES = 4;
+    double lowLanes[LANES];
+    double highLanes[LANES];
+    std::fill(lowLanes, lowLanes + LANES, low);
+    std::fill(highLanes, highLanes + LANES, high);
+
+    size_t index = start;
+    while (index < end)
+    {
+        const size_t pos = position(level, index);
+        const size_t count = std::min(end - index, level.x.size() - pos);
+        const double* lows = &level.low[pos];
+        const double* tops = &highs[pos];
+
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+        {
+            for (size_t lane = 0; lane < LANES; lane++)
+            {
+                const double lowValue = lows[i + lane];
+                const double highValue = tops[i + lane];
+                lowLanes[lane] = lowValue < lowLanes[lane] ? lowValue : lowLanes[lane];
+                highLanes[lane] = highValue > highLanes[lane] ? highValue : highLanes[lane];
+            }
+        }
+
+        for (; i < count; i++)
+        {
+            low = lows[i] < low ? lows[i] : low;
+            high = tops[i] > high ? tops[i] : high;
+        }
+
+        index += count;
+    }
+
+    for (size_t lane = 0; lane < LANES; lane++)
+    {
+        low = lowLanes[lane] < low ? lowLanes[lane] : low;
+        high = highLanes[lane] > high ? highLanes[lane] : high;
+    }
+
+} // End PlotSeries::findExtremes
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,366 @@
+#ifndef __PLOT_SERIES_H__
+#define __PLOT_SERIES_H__
+
+#include <QPointF>
+#include <QRectF>
+
+#ifdef __GNUG__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+#include <qwt_series_data.h>
+#ifdef __GNUG__
+#pragma GCC diagnostic pop
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+
+/**
+ * @brief The points of a plotted variable, served to Qwt in place.
+ *
+ * @details Points are kept in a pyramid of circular buffers. Level 0 holds
+ *          the raw points. Each level above summarizes LEVEL_FACTOR points
+ *          of the level below with their minimum, maximum and mean, so it
+ *          reaches LEVEL_FACTOR times further back in the same memory. An
+ *          append updates the open summary at every level, which is a fixed
+ *          amount of work and memory per point no matter how long the plot
+ *          runs. The x values must not decrease.
+ *
+ *          Qwt reads the points through the QwtSeriesData interface, which
+ *          only exposes the points inside the view window with the bias
+ *          applied. The window is served from the finest level that reaches
+ *          back to its start without too many points per pixel column, found
+ *          with a binary search per level.
+ *
+ *          A window holding more than DECIMATION_FACTOR points per pixel
+ *          column is reduced to the first, minimum, maximum and last point
+ *          of each column (M4 decimation). That draws the same pixels as the
+ *          points, extremes included, so the cost of a replot depends on the
+ *          plot width rather than the point count. The columns are aligned to
+ *          multiples of the column width and cached for the current zoom
+ *          level. Following live data only bins the new points and the last
+ *          column, and panning only bins the columns that scrolled into view.
+ */
+class PlotSeries : public QwtSeriesData<QPointF>
+{
+public:
+
+    /**
+     * @brief Constructor for the plot series.
+     * @param[in] capacity The maximum number of raw points kept. Each
+     *            summary level keeps capacity / LEVEL_FACTOR summaries.
+     */
+    explicit PlotSeries(const size_t capacity);
+
+    /**
+     * @brief Append a point, dropping the oldest one if the buffer is full.
+     * @param[in] x The x value. Not less than the x value of the last point.
+     * @param[in] y The raw y value.
+     */
+    void append(const double x, const double y);
+
+    /**
+     * @brief Remove all points.
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of stored raw points.
+     * @return The number of points in the raw buffer.
+     */
+    size_t count() const;
+
+    /**
+     * @brief Get the newest point.
+     * @return The raw newest point or (0, 0) if there is none.
+     */
+    QPointF latest() const;
+
+    /**
+     * @brief Get the oldest point kept at any resolution.
+     * @return The oldest point, or the mean of the oldest summary, or
+     *         (0, 0) if there is none.
+     */
+    QPointF oldest() const;
+
+    /**
+     * @brief Get the y value at an x value.
+     * @param[in] x The x value.
+     * @return The raw y value of the newest point at or before x, or the
+     *         mean of a summary if the raw point is gone.
+     */
+    double valueAt(const double x) const;
+
+    /**
+     * @brief Set the range of x values served to Qwt.
+     * @remarks Also brings the decimated points up to date with the
+     *          appended ones.
+     * @param[in] xMin The lowest x value shown.
+     * @param[in] xMax The highest x value shown.
+     */
+    void setWindow(const double xMin, const double xMax);
+
+    /**
+     * @brief Set the number of pixel columns the view window is drawn on.
+     * @param[in] columns The plot width in pixels or 0 to only serve raw points.
+     */
+    void setResolution(const int columns);
+
+    /**
+     * @brief Get whether the window is served decimated.
+     * @return True if Qwt gets M4 points instead of the raw ones.
+     */
+    bool isDecimated() const;
+
+    /**
+     * @brief Get the number of leading served points that are unchanged.
+     * @details The first points in the view window that were also served,
+     *          in the same order, before the last window or resolution
+     *          update. The points after them extend the old ones, so only
+     *          they have to be drawn. A decimated column that grew is drawn
+     *          over its old points within the same pixel column.
+     * @return The number of unchanged points.
+     */
+    size_t stableCount() const;
+
+    /**
+     * @brief Set the bias applied to the served y values.
+     * @param[in] scale The y value scaler.
+     * @param[in] shift The y value shift, applied after the scaler.
+     */
+    void setBias(const double scale, const double shift);
+
+    /**
+     * @brief Get the number of points in the view window.
+     * @remarks Reimplemented from QwtSeriesData.
+     * @return The number of points served.
+     */
+    size_t size() const override;
+
+    /**
+     * @brief Get a point in the view window with the bias applied.
+     * @remarks Reimplemented from QwtSeriesData.
+     * @param[in] i The point index, 0 being the oldest in the window.
+     * @return The biased point.
+     */
+    QPointF sample(size_t i) const override;
+
+    /**
+     * @brief Get the bounds of the points in the view window.
+     * @remarks Reimplemented from QwtSeriesData. Cached until the points,
+     *          the window or the bias change.
+     * @return The bounding rectangle of the served points.
+     */
+    QRectF boundingRect() const override;
+
+    /// Decimate when there are more points than this per pixel column.
+    static const size_t DECIMATION_FACTOR = 4;
+
+    /// The number of points of the level below in a summary.
+    static const size_t LEVEL_FACTOR = 16;
+
+    /// The number of summary levels above the raw points.
+    static const size_t SUMMARY_LEVELS = 4;
+
+private:
+
+    /// The points of one resolution.
+    struct Level
+    {
+        /// The x value of each point, or of the first raw point of a summary.
+        std::vector<double> x;
+
+        /// The raw y values, or the lowest raw y value of each summary.
+        std::vector<double> low;
+
+        /// The highest raw y value of each summary. Empty on level 0.
+        std::vector<double> high;
+
+        /// The mean raw y value of each summary. Empty on level 0.
+        std::vector<double> mean;
+
+        /// The buffer position of the oldest point.
+        size_t head = 0;
+
+        /// The number of stored points.
+        size_t count = 0;
+
+        /// The number of points ever appended.
+        uint64_t appended = 0;
+
+        /// The number of raw points in a complete summary.
+        uint64_t span = 1;
+
+        /// The number of raw points in the newest summary.
+        uint64_t openCount = 0;
+    };
+
+    /// The points of one pixel column of the decimated window.
+    struct Column
+    {
+        /// The column number, the column x range divided by its width.
+        int64_t bin;
+
+        /// The append count of the first point in the column.
+        uint64_t first;
+
+        /// The number of points in the column.
+        size_t count;
+
+        /// The first point.
+        QPointF firstPoint;
+
+        /// The last point.
+        QPointF lastPoint;
+
+        /// The lowest raw y value.
+        double min;
+
+        /// The highest raw y value.
+        double max;
+    };
+
+    /**
+     * @brief Append a point to a level, dropping its oldest one if it's full.
+     * @param[in] level The level.
+     * @param[in] x The x value.
+     * @param[in] y The raw y value, used as the minimum, maximum and mean.
+     */
+    static void appendPoint(Level& level, const double x, const double y);
+
+    /**
+     * @brief Get the buffer position of a point.
+     * @param[in] level The level of the point.
+     * @param[in] index The point index, 0 being the oldest in the level.
+     * @return The position in the level buffers.
+     */
+    static size_t position(const Level& level, const size_t index);
+
+    /**
+     * @brief Get the highest raw y values of a level.
+     * @param[in] level The level.
+     * @return The buffer of maximums.
+     */
+    static const std::vector<double>& highValues(const Level& level);
+
+    /**
+     * @brief Get the mean raw y values of a level.
+     * @param[in] level The level.
+     * @return The buffer of means.
+     */
+    static const std::vector<double>& meanValues(const Level& level);
+
+    /**
+     * @brief Find the first point of a level at or after an x value.
+     * @param[in] level The level.
+     * @param[in] x The x value.
+     * @param[in] after Find the first point after the x value instead.
+     * @return The point index, 0 being the oldest point of the level.
+     */
+    static size_t findPoint(const Level& level, const double x, const bool after);
+
+    /**
+     * @brief Get whether a level reaches back to an x value.
+     * @param[in] level The level.
+     * @param[in] x The x value.
+     * @return True if no older point was dropped from the level.
+     */
+    static bool reaches(const Level& level, const double x);
+
+    /**
+     * @brief Find the raw points inside the view window again.
+     */
+    void updateWindow();
+
+    /**
+     * @brief Pick the level for the view window and bring the decimated
+     *        points up to date with it.
+     */
+    void decimate();
+
+    /**
+     * @brief Sort a range of points of the decimated level into columns.
+     * @param[in] start The point index of the first point.
+     * @param[in] end The point index after the last point.
+     * @param[out] columns The columns are appended here.
+     */
+    void binPoints(const size_t start, const size_t end, std::deque<Column>& columns) const;
+
+    /**
+     * @brief Get the lowest and highest raw y value of a range of points of
+     *        the decimated level.
+     * @param[in] start The point index of the first point.
+     * @param[in] end The point index after the last point. Greater than start.
+     * @param[out] low The lowest y value.
+     * @param[out] high The highest y value.
+     */
+    void findExtremes(const size_t start, const size_t end, double& low, double& high) const;
+
+    /// The raw points, followed by the summary levels.
+    std::vector<Level> m_levels;
+
+    /// The point index of the first raw point in the view window.
+    size_t m_first;
+
+    /// The number of raw points in the view window.
+    size_t m_windowCount;
+
+    /// The lowest x value shown.
+    double m_xMin;
+
+    /// The highest x value shown.
+    double m_xMax;
+
+    /// The y value scaler.
+    double m_scale;
+
+    /// The y value shift.
+    double m_shift;
+
+    /// The number of pixel columns or 0 to only serve raw points.
+    int m_resolution;
+
+    /// True if the decimated points are served.
+    bool m_decimated;
+
+    /// The level the columns were binned from.
+    size_t m_columnLevel;
+
+    /// The x width of a column at the current zoom level.
+    double m_columnWidth;
+
+    /// The cached columns, covering the view window.
+    std::deque<Column> m_columns;
+
+    /// The decimated points of the view window.
+    std::vector<QPointF> m_decimatedPoints;
+
+    /// The decimated points served before the last update.
+    std::vector<QPointF> m_previousPoints;
+
+    /// The append count of the first raw point served.
+    uint64_t m_servedFirst;
+
+    /// The number of raw points served after the last update.
+    size_t m_servedCount;
+
+    /// The number of leading served points unchanged by the last update.
+    size_t m_stableCount;
+
+    /// The cached bounds of the served points.
+    mutable QRectF m_bounds;
+
+    /// True if m_bounds is up to date.
+    mutable bool m_boundsValid;
+
+}; // End class PlotSeries
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,32 @@
+#ifndef __POWER_OF_TWO_H__
+#define __POWER_OF_TWO_H__
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Round a ring capacity up to the next power of two, so positions map
+ *        onto slots with a mask.
+ * @remarks Stops at the highest power of two a size_t holds, so a huge
+ *          request can't loop forever. Callers cap their capacities well
+ *          below that.
+ * @param[in] value The requested capacity.
+ * @param[in] minimum The smallest capacity to return. A power of two.
+ * @return The rounded capacity.
+ */
+inline size_t roundUpPowerOfTwo(const size_t value, const size_t minimum = 1)
+{
+    size_t power = minimum;
+    while (power < value && power <= (SIZE_MAX >> 1))
+    {
+        power <<= 1;
+    }
+    return power;
+}
+
+#endif
+
+/**
+ * @}
+ */
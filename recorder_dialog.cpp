@@ -1,11 +1,12 @@
 #include "recorder_dialog.h"
 #include "dds_data.h"
+#include "change_notifier.h"
+#include "sample_columns.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QTextCodec>
 #include <QSettings>
-#include <QTime>
 
 
 //------------------------------------------------------------------------------
@@ -15,9 +16,9 @@ RecorderDialog::RecorderDialog(const QString& topicName,
                                QDialog(parent),
                                m_topicMembers(members),
                                m_topicName(topicName),
-                               m_latestTimestamp("00:00:00.000"),
+                               m_latestSequence(0),
                                m_delimiter(","),
-                               m_updateTimer(this),
+                               m_recording(false),
                                m_rowCount(0)
 {
     setupUi(this);
@@ -36,19 +37,12 @@ RecorderDialog::RecorderDialog(const QString& topicName,
 
     recordingStatusLabel->setVisible(false);
     stopButton->setVisible(false);
-
-    connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(dumpData()));
-    m_updateTimer.setInterval(UPDATE_RATE);
 }
 
 
 //------------------------------------------------------------------------------
 RecorderDialog::~RecorderDialog()
 {
-    if (m_updateTimer.isActive())
-    {
-        m_updateTimer.stop();
-    }
     if (m_outputFile.isOpen())
     {
         m_outputFile.close();
@@ -59,7 +53,7 @@ RecorderDialog::~RecorderDialog()
 //------------------------------------------------------------------------------
 bool RecorderDialog::isRecording() const
 {
-    return m_updateTimer.isActive();
+    return m_recording;
 }
 
 
@@ -156,12 +150,13 @@ void RecorderDialog::on_recordButton_clicked()
     m_outputStream.setRealNumberNotation(QTextStream::FixedNotation);
     m_outputStream.setRealNumberPrecision(6);
 
-    // Add the header to the data file
+    // Add the header to the data file and resolve the member paths
     m_outputStream << "Time";
     for (int i = 0; i < m_topicMembers.count(); i++)
     {
         m_outputStream << m_delimiter << m_topicMembers.at(i);
     }
+    m_memberPaths = CommonData::resolveMembers(m_topicName, m_topicMembers);
     m_outputStream << "\n";
 
 
@@ -175,12 +170,20 @@ void RecorderDialog::on_recordButton_clicked()
     closeButton->setVisible(false);
 
 
-    // Only record data with a timestamp after the current time
-    m_latestTimestamp = QTime::currentTime().toString("HH:mm:ss.zzz");
+    // Only record samples received from now on
+    m_history = CommonData::getHistory(m_topicName);
+    m_latestSequence = m_history->latestSequence();
     m_rowCount = 0;
 
     dumpData();
-    m_updateTimer.start();
+
+    // New samples are written as the notifier reports them
+    m_recording = true;
+    if (CommonData::m_changeNotifier)
+    {
+        connect(CommonData::m_changeNotifier.get(), SIGNAL(topicChanged(const QString&)),
+                this, SLOT(topicChanged(const QString&)));
+    }
 
 } // End RecorderDialog::on_recordButton_clicked
 
@@ -188,7 +191,12 @@ void RecorderDialog::on_recordButton_clicked()
 //------------------------------------------------------------------------------
 void RecorderDialog::on_stopButton_clicked()
 {
-    m_updateTimer.stop();
+    if (CommonData::m_changeNotifier)
+    {
+        disconnect(CommonData::m_changeNotifier.get(), SIGNAL(topicChanged(const QString&)),
+                   this, SLOT(topicChanged(const QString&)));
+    }
+    m_recording = false;
     m_outputFile.close();
 
     recordingStatusLabel->setVisible(false);
@@ -201,32 +209,33 @@ void RecorderDialog::on_stopButton_clicked()
 }
 
 
+//------------------------------------------------------------------------------
+void RecorderDialog::topicChanged(const QString& topicName)
+{
+    if (topicName == m_topicName)
+    {
+        dumpData();
+    }
+}
+
+
 //------------------------------------------------------------------------------
 void RecorderDialog::dumpData()
 {
-    QStringList sampleNames = CommonData::getSampleList(m_topicName);
+    // Read every member of the samples stored since the last update in one
+    // pass, oldest first
+    const SampleColumns data = m_history->readColumns(
+        m_memberPaths, m_latestSequence + 1, m_history->latestSequence());
 
-    // Loop through all samples for this topic
-    for (int i = sampleNames.count() - 1; i >= 0; i--)
+    for (size_t row = 0; row < data.size(); row++)
     {
-        // Skip previously read samples
-        if (sampleNames.at(i) <= m_latestTimestamp)
-        {
-            continue;
-        }
-
         // Insert the timestamp
-        m_outputStream << sampleNames.at(i);
+        m_outputStream << CommonData::formatTime(data.info[row].sourceTime);
 
         // Insert the values for each member variable
-        for (int ii = 0; ii < m_topicMembers.count(); ii++)
+        for (const SampleColumn& column : data.columns)
         {
-            QVariant memberValue = CommonData::readValue(
-                m_topicName,
-                m_topicMembers.at(ii),
-                i);
-
-            m_outputStream << m_delimiter << memberValue.toString();
+            m_outputStream << m_delimiter << column.toString(row);
         }
 
         m_outputStream << "\n";
@@ -237,26 +246,10 @@ void RecorderDialog::dumpData()
     m_outputStream.flush();
 
 
-    // Update the timestamp to the latest sample
-    if (sampleNames.count() > 0)
-    {
-        m_latestTimestamp = sampleNames.at(0);
-    }
-
-
-    // If midnight rolled by, reset the latest received sample time
-    QTime now = QTime::currentTime();
-    if (now.hour() == 0 &&
-        now.minute() == 0 &&
-        now.second() == 0 &&
-        m_latestTimestamp != "00:00:00.000")
+    // Update the sequence number to the latest sample
+    if (data.size() > 0)
     {
-        m_latestTimestamp = "00:00:00.000";
-
-        // Reset the samples, so we don't record samples from the previous day.
-        // Doing this isn't ideal, but it shouldn't happen unless someone is
-        // recording all night.
-        CommonData::clearSamples(m_topicName);
+        m_latestSequence = data.info.back().sequence;
     }
 
     rowCountLabel->setText(QString::number(m_rowCount));
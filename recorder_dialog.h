@@ -5,9 +5,14 @@
 #include <QStringList>
 #include <QString>
 #include <QDialog>
-#include <QTimer>
 #include <QFile>
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "member_path.h"
+#include "topic_history.h"
 #include "ui_recorder_dialog.h"
 
 
@@ -69,6 +74,12 @@ private slots:
      */
     void dumpData();
 
+    /**
+     * @brief Dump the new samples when the recorded topic changed.
+     * @param[in] topicName The name of the changed topic.
+     */
+    void topicChanged(const QString& topicName);
+
 private:
 
     /// IDs for delimiter selections.
@@ -82,11 +93,17 @@ private:
     /// Stores the topic member names to record.
     QStringList m_topicMembers;
 
+    /// Stores the resolved paths of the topic members to record.
+    std::vector<MemberPath> m_memberPaths;
+
     /// Stores the target topic member to record.
     QString m_topicName;
 
-    /// Record data after this timestamp.
-    QString m_latestTimestamp;
+    /// The sample history of the recorded topic.
+    std::shared_ptr<TopicHistory> m_history;
+
+    /// Record samples with a higher sequence number than this.
+    uint64_t m_latestSequence;
 
     /// Separate data rows with this delimiter.
     QString m_delimiter;
@@ -97,15 +114,12 @@ private:
     /// Write to this output file stream object.
     QTextStream m_outputStream;
 
-    /// The timer to check for new data.
-    QTimer m_updateTimer;
+    /// True while samples are written to the file.
+    bool m_recording;
 
     /// Counts the number of rows recorded.
     unsigned int m_rowCount;
 
-    /// The data dump rate in ms.
-    static const int UPDATE_RATE = 250;
-
 }; // End RecorderDialog
 
 #endif
@@ -0,0 +1,189 @@
+#include "sample_columns.h"
+#include "open_dynamic_data.h"
+
+#include <QVariant>
+
+
+//------------------------------------------------------------------------------
+SampleColumn::SampleColumn(const MemberPath& memberPath) :
+                           path(memberPath),
+                           kind(memberPath.getKind()),
+                           type(NONE)
+{
+    switch (kind)
+    {
+    case CORBA::tk_float:
+    case CORBA::tk_double:
+        type = DOUBLE;
+        break;
+    case CORBA::tk_long:
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+    case CORBA::tk_ulong:
+    case CORBA::tk_boolean:
+    case CORBA::tk_enum:
+    case CORBA::tk_char:
+    case CORBA::tk_wchar:
+    case CORBA::tk_octet:
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+        type = INT64;
+        break;
+    case CORBA::tk_string:
+        type = STRING;
+        break;
+    default:
+        break;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void SampleColumn::append(const OpenDynamicData* sample)
+{
+    bool found = false;
+    switch (type)
+    {
+    case DOUBLE:
+    {
+        double value = 0;
+        found = sample && sample->getValue(path, value);
+        doubles.push_back(value);
+        break;
+    }
+    case INT64:
+    {
+        int64_t value = 0;
+        found = sample && sample->getValue(path, value);
+        integers.push_back(value);
+        break;
+    }
+    case STRING:
+    {
+        const char* value = nullptr;
+        found = sample && sample->getStringValue(path, value);
+        strings.push_back(value);
+        break;
+    }
+    default:
+        break;
+    }
+
+    valid.push_back(found ? 1 : 0);
+}
+
+
+//------------------------------------------------------------------------------
+void SampleColumn::clear()
+{
+    doubles.clear();
+    integers.clear();
+    strings.clear();
+    valid.clear();
+}
+
+
+//------------------------------------------------------------------------------
+double SampleColumn::toDouble(const size_t row) const
+{
+    if (row >= valid.size() || !valid[row])
+    {
+        return 0;
+    }
+
+    switch (type)
+    {
+    case DOUBLE: return doubles[row];
+    case INT64:
+        return kind == CORBA::tk_ulonglong ?
+            static_cast<double>(static_cast<uint64_t>(integers[row])) :
+            static_cast<double>(integers[row]);
+    case STRING: return QString::fromUtf8(strings[row]).toDouble();
+    default: return 0;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+QString SampleColumn::toString(const size_t row) const
+{
+    if (row >= valid.size() || !valid[row])
+    {
+        return "NULL";
+    }
+
+    switch (type)
+    {
+    case DOUBLE:
+        // Go through QVariant so floats print with their own precision
+        return kind == CORBA::tk_float ?
+            QVariant(static_cast<float>(doubles[row])).toString() :
+            QVariant(doubles[row]).toString();
+    case INT64:
+        return kind == CORBA::tk_ulonglong ?
+            QString::number(static_cast<quint64>(integers[row])) :
+            QString::number(static_cast<qint64>(integers[row]));
+    case STRING:
+        return QString::fromUtf8(strings[row]);
+    default:
+        return "NULL";
+    }
+
+} // End SampleColumn::toString
+
+
+//------------------------------------------------------------------------------
+SampleColumns::SampleColumns(const std::vector<MemberPath>& memberPaths)
+{
+    columns.reserve(memberPaths.size());
+    for (const MemberPath& memberPath : memberPaths)
+    {
+        columns.emplace_back(memberPath);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void SampleColumns::reserve(const size_t count)
+{
+    info.reserve(count);
+    m_records.reserve(count);
+    for (SampleColumn& column : columns)
+    {
+        switch (column.type)
+        {
+        case SampleColumn::DOUBLE: column.doubles.reserve(count); break;
+        case SampleColumn::INT64: column.integers.reserve(count); break;
+        case SampleColumn::STRING: column.strings.reserve(count); break;
+        default: break;
+        }
+        column.valid.reserve(count);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void SampleColumns::append(const std::shared_ptr<const SampleRecord>& record)
+{
+    info.push_back(record->info);
+
+    const OpenDynamicData* sample = record->sample.get();
+    for (SampleColumn& column : columns)
+    {
+        column.append(sample);
+    }
+
+    m_records.push_back(record);
+}
+
+
+//------------------------------------------------------------------------------
+size_t SampleColumns::size() const
+{
+    return info.size();
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,143 @@
+#ifndef __SAMPLE_COLUMNS_H__
+#define __SAMPLE_COLUMNS_H__
+
+#include "member_path.h"
+#include "topic_history.h"
+
+#include <QString>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+/**
+ * @brief The values of one member across a range of samples.
+ *
+ * @details Values are stored in a contiguous array of the widest type of the
+ *          member kind. Floating point members go to doubles, integer, enum,
+ *          boolean and character members to integers and strings to string
+ *          views. Only the array of the column type is filled.
+ */
+class SampleColumn
+{
+public:
+
+    /// The storage type of a column.
+    enum Type
+    {
+        NONE,
+        DOUBLE,
+        INT64,
+        STRING
+    };
+
+    /**
+     * @brief Constructor for a column.
+     * @param[in] memberPath The member read into this column.
+     */
+    explicit SampleColumn(const MemberPath& memberPath);
+
+    /**
+     * @brief Read the member of a sample and append it.
+     * @param[in] sample The data sample. May be nullptr.
+     */
+    void append(const OpenDynamicData* sample);
+
+    /**
+     * @brief Remove all values, keeping the capacity.
+     */
+    void clear();
+
+    /**
+     * @brief Get a value as a double.
+     * @param[in] row The sample row.
+     * @return The value or 0 for missing values and non-numeric strings.
+     */
+    double toDouble(const size_t row) const;
+
+    /**
+     * @brief Format a value for display.
+     * @param[in] row The sample row.
+     * @return The value as CommonData::readValue() would format it.
+     */
+    QString toString(const size_t row) const;
+
+    /// The member read into this column.
+    MemberPath path;
+
+    /// The type kind of the member.
+    CORBA::TCKind kind;
+
+    /// The storage type of this column.
+    Type type;
+
+    /// The values of DOUBLE columns.
+    std::vector<double> doubles;
+
+    /// The values of INT64 columns.
+    std::vector<int64_t> integers;
+
+    /// The values of STRING columns. They point into the samples held by
+    /// the owning SampleColumns.
+    std::vector<const char*> strings;
+
+    /// Nonzero where the member exists in the sample.
+    std::vector<uint8_t> valid;
+
+}; // End class SampleColumn
+
+
+/**
+ * @brief A batch of member values read from a range of samples.
+ *
+ * @details Built by TopicHistory::readColumns(), which walks the history once
+ *          and reads every requested member of each sample. The records are
+ *          kept so the string views stay valid for the life of the batch.
+ */
+class SampleColumns
+{
+public:
+
+    /**
+     * @brief Constructor for an empty batch.
+     * @param[in] memberPaths The members to read, one column each.
+     */
+    explicit SampleColumns(const std::vector<MemberPath>& memberPaths = {});
+
+    /**
+     * @brief Reserve room for a number of samples.
+     * @param[in] count The expected number of samples.
+     */
+    void reserve(const size_t count);
+
+    /**
+     * @brief Read all columns of a sample and append them as a row.
+     * @param[in] record The stored sample.
+     */
+    void append(const std::shared_ptr<const SampleRecord>& record);
+
+    /**
+     * @brief Get the number of rows.
+     * @return The sample count.
+     */
+    size_t size() const;
+
+    /// The bookkeeping of each row, oldest first.
+    std::vector<SampleInfo> info;
+
+    /// The member columns, in the order they were requested.
+    std::vector<SampleColumn> columns;
+
+private:
+
+    /// Keeps the samples of the string views alive.
+    std::vector<std::shared_ptr<const SampleRecord>> m_records;
+
+}; // End class SampleColumns
+
+#endif
+
+/**
+ * @}
+ */
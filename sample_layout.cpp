@@ -0,0 +1,600 @@
+#include "sample_layout.h"
+#include "open_dynamic_data.h"
+#include "decode_plan.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+
+namespace
+{
+    /// Protects the layout cache.
+    std::mutex layoutMutex;
+
+    /// Stores the shared layouts by type code.
+    std::map<const CORBA::TypeCode*, std::shared_ptr<const SampleLayout>> layoutCache;
+
+    /// Round an offset up to the next multiple of an alignment.
+    size_t alignUp(const size_t offset, const size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const SampleLayout> SampleLayout::get(const CORBA::TypeCode* typeCode)
+{
+    if (!typeCode)
+    {
+        std::cerr << "Bad typecode received in SampleLayout::get()" << std::endl;
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> locker(layoutMutex);
+    std::shared_ptr<const SampleLayout>& layout = layoutCache[typeCode];
+    if (!layout)
+    {
+        layout = std::make_shared<const SampleLayout>(typeCode);
+    }
+    return layout;
+}
+
+
+//------------------------------------------------------------------------------
+void SampleLayout::clearCache()
+{
+    std::lock_guard<std::mutex> locker(layoutMutex);
+    layoutCache.clear();
+}
+
+
+//------------------------------------------------------------------------------
+SampleLayout::SampleLayout(const CORBA::TypeCode* typeCode) :
+                           m_typeCode(CORBA::TypeCode::_duplicate(const_cast<CORBA::TypeCode*>(typeCode)))
+{
+    build(typeCode, "EMPTY_NAME", m_root);
+}
+
+
+//------------------------------------------------------------------------------
+const SampleLayout::Node& SampleLayout::root() const
+{
+    return m_root;
+}
+
+
+//------------------------------------------------------------------------------
+size_t SampleLayout::primitiveSize(const CORBA::TCKind kind)
+{
+    switch (kind)
+    {
+    case CORBA::tk_char:
+    case CORBA::tk_octet:
+        return 1;
+    case CORBA::tk_boolean:
+        return sizeof(ACE_CDR::Boolean);
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+        return 2;
+    case CORBA::tk_wchar:
+        return sizeof(ACE_CDR::WChar);
+    case CORBA::tk_long:
+    case CORBA::tk_ulong:
+    case CORBA::tk_enum:
+    case CORBA::tk_float:
+        return 4;
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+    case CORBA::tk_double:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void SampleLayout::build(const CORBA::TypeCode* typeCode,
+                         const std::string& name,
+                         Node& node)
+{
+    node.name = name;
+    node.typeCode = typeCode;
+    node.kind = typeCode->kind();
+    node.offset = 0;
+    node.size = 0;
+    node.alignment = 1;
+    node.length = 0;
+    node.stride = 0;
+    node.containsComplexTypes = !OpenDynamicData::isPrimitiveKind(node.kind);
+
+    switch (node.kind)
+    {
+    case CORBA::tk_struct:
+    {
+        size_t offset = 0;
+        const CORBA::ULong memberCount = typeCode->member_count();
+        for (CORBA::ULong i = 0; i < memberCount; i++)
+        {
+            CORBA::TypeCode_ptr memberType = typeCode->member_type(i);
+            if (!memberType)
+            {
+                std::cerr << "Invalid member type on ["
+                          << i
+                          << "] within "
+                          << typeCode->name()
+                          << std::endl;
+
+                continue;
+            }
+
+            // Follow the alias trail until we have the true type
+            while (memberType->kind() == CORBA::tk_alias)
+            {
+                memberType = TAO::unaliased_typecode(memberType);
+            }
+
+            node.members.emplace_back();
+            Node& member = node.members.back();
+            build(memberType, typeCode->member_name(i), member);
+
+            offset = alignUp(offset, member.alignment);
+            member.offset = offset;
+            offset += member.size;
+            node.alignment = std::max(node.alignment, member.alignment);
+        }
+
+        node.length = node.members.size();
+        node.size = alignUp(offset, node.alignment);
+        break;
+    }
+
+    case CORBA::tk_array:
+    case CORBA::tk_sequence:
+    {
+        // Get the true type for this array/sequence
+        CORBA::TypeCode_ptr contentType = typeCode->content_type();
+
+        // Follow the alias trail until we have the true type
+        while (contentType->kind() == CORBA::tk_alias)
+        {
+            contentType = TAO::unaliased_typecode(contentType);
+        }
+
+        node.members.emplace_back();
+        Node& element = node.members.back();
+        build(contentType, "", element);
+
+        // Element sizes are already rounded up to their alignment
+        node.stride = element.size;
+        node.containsComplexTypes = !OpenDynamicData::isPrimitiveKind(element.kind);
+
+        if (node.kind == CORBA::tk_array)
+        {
+            // Arrays are stored inline
+            node.length = typeCode->length();
+            node.size = node.stride * node.length;
+            node.alignment = element.alignment;
+        }
+        else
+        {
+            // Sequences only keep a handle to their element block
+            node.size = sizeof(uint32_t);
+            node.alignment = sizeof(uint32_t);
+        }
+        break;
+    }
+
+    case CORBA::tk_string:
+        // Strings only keep a handle into the string arena
+        node.size = sizeof(uint32_t);
+        node.alignment = sizeof(uint32_t);
+        break;
+
+    case CORBA::tk_wstring: // TODO?
+    case CORBA::tk_union: // TODO?
+    default:
+        node.size = primitiveSize(node.kind);
+        node.alignment = std::max<size_t>(node.size, 1);
+        break;
+    }
+
+} // End SampleLayout::build
+
+
+//------------------------------------------------------------------------------
+SampleStorage::SampleStorage(const std::shared_ptr<const SampleLayout>& layout) :
+                             m_layout(layout),
+                             m_blockCount(1),
+                             m_stringCount(0),
+                             m_payloadKind(OpenDDS::DCPS::Encoding::KIND_XCDR1),
+                             m_payloadEndianness(OpenDDS::DCPS::ENDIAN_NATIVE),
+                             m_decoded(true),
+                             m_charged(0)
+{
+    m_blocks.resize(1);
+    m_blocks[0].bytes.assign(m_layout->root().size, 0);
+    m_blocks[0].length = 0;
+}
+
+
+//------------------------------------------------------------------------------
+const std::shared_ptr<const SampleLayout>& SampleStorage::layout() const
+{
+    return m_layout;
+}
+
+
+//------------------------------------------------------------------------------
+void SampleStorage::reset()
+{
+    std::fill(m_blocks[0].bytes.begin(), m_blocks[0].bytes.end(), 0);
+    for (size_t i = 0; i < m_blockCount; i++)
+    {
+        m_blocks[i].blocks.clear();
+        m_blocks[i].strings.clear();
+    }
+    m_blockCount = 1;
+    m_freeBlocks.clear();
+    m_stringCount = 0;
+    m_freeStrings.clear();
+    m_payload.clear();
+    m_decoded.store(true, std::memory_order_release);
+    setCharge(nullptr);
+}
+
+
+//------------------------------------------------------------------------------
+void SampleStorage::copyFrom(SampleStorage& other)
+{
+    // Don't copy a half written sample
+    std::lock_guard<std::mutex> locker(other.m_decodeMutex);
+
+    m_blocks = other.m_blocks;
+    m_blockCount = other.m_blockCount;
+    m_freeBlocks = other.m_freeBlocks;
+    m_strings = other.m_strings;
+    m_stringCount = other.m_stringCount;
+    m_freeStrings = other.m_freeStrings;
+    m_plan = other.m_plan;
+    m_payload = other.m_payload;
+    m_payloadKind = other.m_payloadKind;
+    m_payloadEndianness = other.m_payloadEndianness;
+    m_decoded.store(other.isDecoded(), std::memory_order_release);
+}
+
+
+//------------------------------------------------------------------------------
+void SampleStorage::setPayload(const std::shared_ptr<const DecodePlan>& plan,
+                               const ACE_Message_Block& payload,
+                               const OpenDDS::DCPS::Encoding::Kind encodingKind,
+                               const OpenDDS::DCPS::Endianness endianness)
+{
+    // Copy the whole chain into one contiguous buffer. The alignment of the
+    // stream is relative to its first byte, so offsets are preserved.
+    m_payload.clear();
+    for (const ACE_Message_Block* block = &payload; block; block = block->cont())
+    {
+        m_payload.insert(m_payload.end(), block->rd_ptr(), block->rd_ptr() + block->length());
+    }
+
+    m_plan = plan;
+    m_payloadKind = encodingKind;
+    m_payloadEndianness = endianness;
+    m_decoded.store(false, std::memory_order_release);
+}
+
+
+//------------------------------------------------------------------------------
+bool SampleStorage::getPayload(const char*& data,
+                               size_t& length,
+                               OpenDDS::DCPS::Encoding::Kind& encodingKind,
+                               OpenDDS::DCPS::Endianness& endianness) const
+{
+    if (m_payload.empty())
+    {
+        return false;
+    }
+
+    data = m_payload.data();
+    length = m_payload.size();
+    encodingKind = m_payloadKind;
+    endianness = m_payloadEndianness;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+bool SampleStorage::decode()
+{
+    std::lock_guard<std::mutex> locker(m_decodeMutex);
+    if (isDecoded())
+    {
+        return true;
+    }
+
+    // The sample was measured when it was stored, before the decode
+    const size_t sizeBefore = byteSize();
+
+    bool pass = false;
+    if (m_plan)
+    {
+        ACE_Message_Block block(m_payload.data(), m_payload.size());
+        block.wr_ptr(m_payload.size());
+        OpenDDS::DCPS::Serializer stream(&block, m_payloadKind, m_payloadEndianness);
+        pass = m_plan->execute(stream, *this);
+    }
+
+    // Failed samples keep whatever was decoded, so don't retry them
+    m_decoded.store(true, std::memory_order_release);
+
+    const size_t sizeAfter = byteSize();
+    if (sizeAfter > sizeBefore)
+    {
+        charge(sizeAfter - sizeBefore);
+    }
+
+    if (!pass)
+    {
+        std::cerr << "SampleStorage::decode: "
+                  << "Failed to decode the sample payload"
+                  << std::endl;
+    }
+
+    return pass;
+
+} // End SampleStorage::decode
+
+
+//------------------------------------------------------------------------------
+const char* SampleStorage::peekAddress(const size_t offset, const size_t size) const
+{
+    size_t payloadOffset = 0;
+    if (!m_plan ||
+        !m_plan->getFixedOffset(offset, payloadOffset) ||
+        payloadOffset + size > m_payload.size())
+    {
+        return nullptr;
+    }
+
+    return m_payload.data() + payloadOffset;
+}
+
+
+//------------------------------------------------------------------------------
+void SampleStorage::copyPayloadValue(const char* source, char* dest, const size_t size) const
+{
+    if (m_payloadEndianness == OpenDDS::DCPS::ENDIAN_NATIVE)
+    {
+        memcpy(dest, source, size);
+        return;
+    }
+
+    switch (size)
+    {
+    case 2: ACE_CDR::swap_2(source, dest); break;
+    case 4: ACE_CDR::swap_4(source, dest); break;
+    case 8: ACE_CDR::swap_8(source, dest); break;
+    default: memcpy(dest, source, size); break;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+char* SampleStorage::data(const uint32_t block)
+{
+    return m_blocks[block].bytes.data();
+}
+
+
+//------------------------------------------------------------------------------
+const char* SampleStorage::data(const uint32_t block) const
+{
+    return m_blocks[block].bytes.data();
+}
+
+
+//------------------------------------------------------------------------------
+size_t SampleStorage::byteSize() const
+{
+    size_t bytes = sizeof(SampleStorage) + m_payload.capacity();
+
+    bytes += m_blocks.capacity() * sizeof(Block);
+    for (const Block& block : m_blocks)
+    {
+        bytes += block.bytes.capacity() +
+                 (block.blocks.capacity() + block.strings.capacity()) * sizeof(uint32_t);
+    }
+    bytes += (m_freeBlocks.capacity() + m_freeStrings.capacity()) * sizeof(uint32_t);
+
+    bytes += m_strings.capacity() * sizeof(std::string);
+    for (const std::string& value : m_strings)
+    {
+        // Short strings live inside the string object itself
+        if (value.capacity() >= sizeof(std::string))
+        {
+            bytes += value.capacity() + 1;
+        }
+    }
+
+    return bytes;
+}
+
+
+//------------------------------------------------------------------------------
+size_t SampleStorage::setCharge(const std::function<void(const size_t)>& charge)
+{
+    std::lock_guard<std::mutex> locker(m_chargeMutex);
+    const size_t charged = m_charged;
+    m_charge = charge;
+    m_charged = 0;
+    return charged;
+}
+
+
+//------------------------------------------------------------------------------
+void SampleStorage::charge(const size_t bytes)
+{
+    std::lock_guard<std::mutex> locker(m_chargeMutex);
+    if (m_charge)
+    {
+        m_charge(bytes);
+        m_charged += bytes;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+std::recursive_mutex& SampleStorage::viewMutex() const
+{
+    return m_viewMutex;
+}
+
+
+//------------------------------------------------------------------------------
+uint32_t SampleStorage::sequenceBlock(const uint32_t block, const size_t offset) const
+{
+    return load<uint32_t>(block, offset);
+}
+
+
+//------------------------------------------------------------------------------
+size_t SampleStorage::sequenceLength(const uint32_t block, const size_t offset) const
+{
+    const uint32_t handle = sequenceBlock(block, offset);
+    return handle ? m_blocks[handle].length : 0;
+}
+
+
+//------------------------------------------------------------------------------
+uint32_t SampleStorage::resizeSequence(const uint32_t block,
+                                       const size_t offset,
+                                       const size_t length,
+                                       const size_t stride)
+{
+    uint32_t handle = sequenceBlock(block, offset);
+    if (handle != 0)
+    {
+        // The old elements go away, along with anything they point to
+        releaseContents(handle);
+    }
+
+    if (length == 0)
+    {
+        if (handle != 0)
+        {
+            std::vector<uint32_t>& siblings = m_blocks[block].blocks;
+            siblings.erase(std::find(siblings.begin(), siblings.end(), handle));
+            m_freeBlocks.push_back(handle);
+        }
+
+        store<uint32_t>(block, offset, 0);
+        return 0;
+    }
+
+    if (handle == 0)
+    {
+        handle = allocateBlock(block);
+        store<uint32_t>(block, offset, handle);
+    }
+
+    Block& elements = m_blocks[handle];
+    elements.bytes.assign(length * stride, 0);
+    elements.length = length;
+    return handle;
+
+} // End SampleStorage::resizeSequence
+
+
+//------------------------------------------------------------------------------
+uint32_t SampleStorage::allocateBlock(const uint32_t parent)
+{
+    uint32_t handle = 0;
+    if (!m_freeBlocks.empty())
+    {
+        handle = m_freeBlocks.back();
+        m_freeBlocks.pop_back();
+    }
+    else
+    {
+        // Reuse a block beyond the count to keep its capacity
+        if (m_blockCount == m_blocks.size())
+        {
+            m_blocks.emplace_back();
+        }
+
+        handle = static_cast<uint32_t>(m_blockCount++);
+    }
+
+    m_blocks[parent].blocks.push_back(handle);
+    return handle;
+}
+
+
+//------------------------------------------------------------------------------
+void SampleStorage::releaseContents(const uint32_t handle)
+{
+    // Nesting follows the type, so the recursion is as deep as the type
+    for (const uint32_t child : m_blocks[handle].blocks)
+    {
+        releaseContents(child);
+        m_freeBlocks.push_back(child);
+    }
+    m_blocks[handle].blocks.clear();
+
+    m_freeStrings.insert(m_freeStrings.end(),
+                         m_blocks[handle].strings.begin(),
+                         m_blocks[handle].strings.end());
+    m_blocks[handle].strings.clear();
+}
+
+
+//------------------------------------------------------------------------------
+const char* SampleStorage::getString(const uint32_t block, const size_t offset) const
+{
+    const uint32_t handle = load<uint32_t>(block, offset);
+    return handle ? m_strings[handle - 1].c_str() : "";
+}
+
+
+//------------------------------------------------------------------------------
+std::string& SampleStorage::stringSlot(const uint32_t block, const size_t offset)
+{
+    uint32_t handle = load<uint32_t>(block, offset);
+    if (handle == 0)
+    {
+        if (!m_freeStrings.empty())
+        {
+            handle = m_freeStrings.back();
+            m_freeStrings.pop_back();
+            m_strings[handle - 1].clear();
+        }
+        else
+        {
+            // Reuse a released string to keep its capacity
+            if (m_stringCount == m_strings.size())
+            {
+                m_strings.emplace_back();
+            }
+            else
+            {
+                m_strings[m_stringCount].clear();
+            }
+
+            handle = static_cast<uint32_t>(++m_stringCount);
+        }
+
+        m_blocks[block].strings.push_back(handle);
+        store<uint32_t>(block, offset, handle);
+    }
+
+    return m_strings[handle - 1];
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,456 @@
+#ifndef __SAMPLE_LAYOUT_H__
+#define __SAMPLE_LAYOUT_H__
+
+#include <dds/DCPS/Serializer.h>
+#include <tao/AnyTypeCode/TypeCode.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class DecodePlan;
+
+
+/**
+ * @brief Per-type table of member offsets for flat sample storage.
+ *
+ * @details Every primitive, string handle and sequence handle of a topic type
+ *          is given a fixed byte offset within a single buffer. Arrays and
+ *          nested structs are stored inline. Strings and sequences only keep a
+ *          32 bit handle inline and live in the side arena of SampleStorage.
+ *          The layout is built once per type code and shared by all samples.
+ */
+class SampleLayout
+{
+public:
+
+    /// Describes where a single member lives within its enclosing block.
+    struct Node
+    {
+        /// The member name, or empty for array/sequence elements.
+        std::string name;
+
+        /// The unaliased type code for this member.
+        const CORBA::TypeCode* typeCode;
+
+        /// The type kind for this member.
+        CORBA::TCKind kind;
+
+        /// The byte offset of this member within the enclosing block.
+        size_t offset;
+
+        /// The number of bytes this member occupies within the block.
+        size_t size;
+
+        /// The alignment of this member within the block.
+        size_t alignment;
+
+        /// The array length, or the struct member count.
+        size_t length;
+
+        /// The distance in bytes between array or sequence elements.
+        size_t stride;
+
+        /// True if this array/sequence holds non-primitive elements.
+        bool containsComplexTypes;
+
+        /// The struct members, or the single element for arrays/sequences.
+        std::vector<Node> members;
+    };
+
+    /**
+     * @brief Get the shared layout for a type code.
+     * @remarks Layouts are cached by type code pointer. Each layout holds a
+     *          reference to its type code, so the pointer can't be reused
+     *          while it is cached.
+     * @param[in] typeCode The type definition pointer for the topic.
+     * @return The layout or nullptr if the type code is invalid.
+     */
+    static std::shared_ptr<const SampleLayout> get(const CORBA::TypeCode* typeCode);
+
+    /**
+     * @brief Drop all cached layouts.
+     */
+    static void clearCache();
+
+    /**
+     * @brief Constructor for the sample layout.
+     * @param[in] typeCode Compute the layout for this type.
+     */
+    explicit SampleLayout(const CORBA::TypeCode* typeCode);
+
+    /**
+     * @brief Get the layout of the top level struct.
+     * @return The root layout node.
+     */
+    const Node& root() const;
+
+    /**
+     * @brief Get whether a type kind is stored as a fixed size value.
+     * @param[in] kind The type kind to check.
+     * @return The value size in bytes, or 0 for non-primitive kinds.
+     */
+    static size_t primitiveSize(const CORBA::TCKind kind);
+
+private:
+
+    /**
+     * @brief Recursively compute the layout for a member.
+     * @param[in] typeCode The unaliased type of the member.
+     * @param[in] name The name of the member.
+     * @param[out] node Store the layout here. The offset is left at 0.
+     */
+    static void build(const CORBA::TypeCode* typeCode,
+                      const std::string& name,
+                      Node& node);
+
+    /// Keeps the type code (and every member type code) alive.
+    CORBA::TypeCode_var m_typeCode;
+
+    /// The layout of the top level struct.
+    Node m_root;
+
+}; // End class SampleLayout
+
+
+/**
+ * @brief Flat storage for the values of a single sample.
+ *
+ * @details Block 0 is the top level struct, sized by SampleLayout. Every
+ *          sequence owns one additional block holding its elements. Strings
+ *          live in a separate table. Both tables keep their capacity on
+ *          reset(), so a recycled storage decodes without reallocating.
+ *          A handle of 0 always means "empty", so a zeroed block is a valid
+ *          default sample.
+ *
+ *          A storage may also hold a serialized payload that is only decoded
+ *          when a member value is first needed. Until then, members at a fixed
+ *          CDR position can be read straight from the payload with peek().
+ */
+class SampleStorage
+{
+public:
+
+    /**
+     * @brief Constructor for the sample storage.
+     * @param[in] layout The layout of the sample type.
+     */
+    explicit SampleStorage(const std::shared_ptr<const SampleLayout>& layout);
+
+    /**
+     * @brief Get the layout of the sample type.
+     * @return The sample layout.
+     */
+    const std::shared_ptr<const SampleLayout>& layout() const;
+
+    /**
+     * @brief Return the storage to a default (zeroed) sample.
+     * @remarks All sequence blocks, strings and the payload are released for
+     *          reuse.
+     */
+    void reset();
+
+    /**
+     * @brief Copy the values from another storage of the same layout.
+     * @remarks A pending payload is copied without being decoded.
+     * @param[in] other Copy the values from this storage.
+     */
+    void copyFrom(SampleStorage& other);
+
+    /**
+     * @brief Get the bytes of a block.
+     * @param[in] block The block handle. 0 is the top level struct.
+     * @return A pointer to the first byte of the block.
+     */
+    char* data(const uint32_t block);
+
+    /**
+     * @brief Get the bytes of a block.
+     * @param[in] block The block handle. 0 is the top level struct.
+     * @return A pointer to the first byte of the block.
+     */
+    const char* data(const uint32_t block) const;
+
+    /**
+     * @brief Get the number of heap bytes held by this storage.
+     * @remarks Counts allocated capacity, including blocks and strings kept
+     *          for reuse, since that's what the storage actually holds on to.
+     * @return The size in bytes.
+     */
+    size_t byteSize() const;
+
+    /**
+     * @brief Report later growth of this sample to whoever stores it.
+     * @details Decoding the payload and building member views grow a sample
+     *          after it was measured and stored. Each growth is passed to this
+     *          function until it's detached.
+     * @remarks Thread safe.
+     * @param[in] charge Called with each growth in bytes, or empty to detach.
+     * @return The bytes passed to the previous function.
+     */
+    size_t setCharge(const std::function<void(const size_t)>& charge);
+
+    /**
+     * @brief Pass growth of this sample on to the charge function, if any.
+     * @remarks Thread safe.
+     * @param[in] bytes The number of bytes the sample grew by.
+     */
+    void charge(const size_t bytes);
+
+    /**
+     * @brief Get the lock that guards the member views of this sample.
+     * @remarks OpenDynamicData creates its child views on first access from
+     *          const accessors that any thread may call, so the views of a
+     *          sample are only created or dropped under this lock. It's
+     *          recursive so a view can walk its children while holding it.
+     * @return The member view lock.
+     */
+    std::recursive_mutex& viewMutex() const;
+
+    /**
+     * @brief Get the element count of a sequence.
+     * @param[in] block The block holding the sequence handle.
+     * @param[in] offset The offset of the sequence handle within the block.
+     * @return The number of sequence elements.
+     */
+    size_t sequenceLength(const uint32_t block, const size_t offset) const;
+
+    /**
+     * @brief Get the block holding the elements of a sequence.
+     * @param[in] block The block holding the sequence handle.
+     * @param[in] offset The offset of the sequence handle within the block.
+     * @return The element block handle or 0 if the sequence is empty.
+     */
+    uint32_t sequenceBlock(const uint32_t block, const size_t offset) const;
+
+    /**
+     * @brief Set the element count of a sequence.
+     * @remarks All elements are reset to their default value. Sequences and
+     *          strings nested in the old elements are released for reuse.
+     * @param[in] block The block holding the sequence handle.
+     * @param[in] offset The offset of the sequence handle within the block.
+     * @param[in] length The new number of elements.
+     * @param[in] stride The size of each element in bytes.
+     * @return The element block handle or 0 if the sequence is empty.
+     */
+    uint32_t resizeSequence(const uint32_t block,
+                            const size_t offset,
+                            const size_t length,
+                            const size_t stride);
+
+    /**
+     * @brief Get the value of a string member.
+     * @param[in] block The block holding the string handle.
+     * @param[in] offset The offset of the string handle within the block.
+     * @return The string value. Never null.
+     */
+    const char* getString(const uint32_t block, const size_t offset) const;
+
+    /**
+     * @brief Get writable access to a string member.
+     * @param[in] block The block holding the string handle.
+     * @param[in] offset The offset of the string handle within the block.
+     * @return The string object for this member.
+     */
+    std::string& stringSlot(const uint32_t block, const size_t offset);
+
+    /**
+     * @brief Keep a serialized payload to be decoded on first access.
+     * @remarks The payload is copied, so the message block may be released.
+     * @param[in] plan The decode plan for the sample type.
+     * @param[in] payload The serialized sample. May be a chain of blocks.
+     * @param[in] encodingKind The encoding kind of the payload.
+     * @param[in] endianness The byte order of the payload.
+     */
+    void setPayload(const std::shared_ptr<const DecodePlan>& plan,
+                    const ACE_Message_Block& payload,
+                    const OpenDDS::DCPS::Encoding::Kind encodingKind,
+                    const OpenDDS::DCPS::Endianness endianness);
+
+    /**
+     * @brief Get the retained serialized payload.
+     * @param[out] data The first byte of the payload.
+     * @param[out] length The payload length in bytes.
+     * @param[out] encodingKind The encoding kind of the payload.
+     * @param[out] endianness The byte order of the payload.
+     * @return False if the storage holds no payload.
+     */
+    bool getPayload(const char*& data,
+                    size_t& length,
+                    OpenDDS::DCPS::Encoding::Kind& encodingKind,
+                    OpenDDS::DCPS::Endianness& endianness) const;
+
+    /**
+     * @brief Get whether the member values are ready to be read.
+     * @return False if a pending payload still has to be decoded.
+     */
+    bool isDecoded() const
+    {
+        return m_decoded.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Decode the pending payload into the member values.
+     * @remarks Does nothing if the payload was already decoded.
+     * @return True if the operation was successful; false otherwise.
+     */
+    bool decode();
+
+    /**
+     * @brief Read a fixed size top level value straight from the payload.
+     * @remarks Only succeeds while the payload is pending and the member sits
+     *          at a fixed position in the CDR stream.
+     * @param[in] offset The offset of the value within block 0.
+     * @param[out] value Store the value here.
+     * @return True if the value was read; false otherwise.
+     */
+    template<class V>
+    bool peek(const size_t offset, V& value) const
+    {
+        const char* source = peekAddress(offset, sizeof(V));
+        if (!source)
+        {
+            return false;
+        }
+
+        copyPayloadValue(source, reinterpret_cast<char*>(&value), sizeof(V));
+        return true;
+    }
+
+    /**
+     * @brief Read a fixed size value.
+     * @param[in] block The block holding the value.
+     * @param[in] offset The offset of the value within the block.
+     * @return The value.
+     */
+    template<class V>
+    V load(const uint32_t block, const size_t offset) const
+    {
+        V value;
+        memcpy(&value, m_blocks[block].bytes.data() + offset, sizeof(V));
+        return value;
+    }
+
+    /**
+     * @brief Write a fixed size value.
+     * @param[in] block The block holding the value.
+     * @param[in] offset The offset of the value within the block.
+     * @param[in] value The new value.
+     */
+    template<class V>
+    void store(const uint32_t block, const size_t offset, const V& value)
+    {
+        memcpy(m_blocks[block].bytes.data() + offset, &value, sizeof(V));
+    }
+
+private:
+
+    /**
+     * @brief Find a fixed position top level value in the pending payload.
+     * @param[in] offset The offset of the value within block 0.
+     * @param[in] size The size of the value in bytes.
+     * @return A pointer into the payload or nullptr if it isn't available.
+     */
+    const char* peekAddress(const size_t offset, const size_t size) const;
+
+    /**
+     * @brief Copy a value out of the payload, swapping its byte order if needed.
+     * @param[in] source The value within the payload.
+     * @param[out] dest Store the value here.
+     * @param[in] size The size of the value in bytes.
+     */
+    void copyPayloadValue(const char* source, char* dest, const size_t size) const;
+
+    /**
+     * @brief Allocate a sequence block, preferring a released one.
+     * @param[in] parent The block that will hold the sequence handle.
+     * @return The new block handle.
+     */
+    uint32_t allocateBlock(const uint32_t parent);
+
+    /**
+     * @brief Release the sequence blocks and strings held by a block.
+     * @remarks Nested sequences are released with their elements.
+     * @param[in] handle The block whose contents are released.
+     */
+    void releaseContents(const uint32_t handle);
+
+    /// A contiguous run of member values.
+    struct Block
+    {
+        /// The member values.
+        std::vector<char> bytes;
+
+        /// The number of elements for sequence blocks.
+        size_t length;
+
+        /// The sequence blocks whose handles live in this block.
+        std::vector<uint32_t> blocks;
+
+        /// The strings whose handles live in this block.
+        std::vector<uint32_t> strings;
+    };
+
+    /// The layout of the sample type.
+    std::shared_ptr<const SampleLayout> m_layout;
+
+    /// Block 0 is the top level struct; the rest belong to sequences.
+    std::vector<Block> m_blocks;
+
+    /// The number of blocks in use. The rest are kept for reuse.
+    size_t m_blockCount;
+
+    /// Blocks below m_blockCount that were released by a resize.
+    std::vector<uint32_t> m_freeBlocks;
+
+    /// The string arena. String handle N refers to entry N - 1.
+    std::vector<std::string> m_strings;
+
+    /// The number of strings in use. The rest are kept for reuse.
+    size_t m_stringCount;
+
+    /// String handles below m_stringCount that were released by a resize.
+    std::vector<uint32_t> m_freeStrings;
+
+    /// The plan that decodes the pending payload.
+    std::shared_ptr<const DecodePlan> m_plan;
+
+    /// The serialized sample.
+    std::vector<char> m_payload;
+
+    /// The encoding kind of the payload.
+    OpenDDS::DCPS::Encoding::Kind m_payloadKind;
+
+    /// The byte order of the payload.
+    OpenDDS::DCPS::Endianness m_payloadEndianness;
+
+    /// False while the payload still has to be decoded.
+    std::atomic<bool> m_decoded;
+
+    /// Makes sure only one thread decodes the payload.
+    std::mutex m_decodeMutex;
+
+    /// Guards the member views that OpenDynamicData creates on demand.
+    mutable std::recursive_mutex m_viewMutex;
+
+    /// Receives the growth of the sample while it's stored.
+    std::function<void(const size_t)> m_charge;
+
+    /// The bytes passed to m_charge so far.
+    size_t m_charged;
+
+    /// Protects m_charge and m_charged.
+    std::mutex m_chargeMutex;
+
+}; // End class SampleStorage
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,288 @@
+#include "sample_pipeline.h"
+#include "config_reader.h"
+#include "open_dynamic_data.h"
+#include "topic_monitor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+
+//------------------------------------------------------------------------------
+SamplePipeline::Worker::Worker(const size_t queueDepth) :
+                               queue(queueDepth),
+                               sleeping(false),
+                               blocked(0)
+{}
+
+
+//------------------------------------------------------------------------------
+SamplePipeline::SamplePipeline(const size_t workerCount,
+                               const size_t queueDepth,
+                               const OverflowPolicy policy) :
+                               m_policy(policy),
+                               m_stopping(false),
+                               m_nextWorker(0),
+                               m_maxQueueDepth(0),
+                               m_dropped(0),
+                               m_processed(0)
+{
+    const size_t count = std::max<size_t>(workerCount, 1);
+    m_workers.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_workers.emplace_back(new Worker(queueDepth));
+    }
+
+    // Start the threads once every worker exists
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        Worker* workerPtr = worker.get();
+        worker->thread = std::thread([this, workerPtr]() { run(*workerPtr); });
+    }
+}
+
+
+//------------------------------------------------------------------------------
+SamplePipeline::~SamplePipeline()
+{
+    m_stopping = true;
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        {
+            std::lock_guard<std::mutex> locker(worker->mutex);
+            worker->wake.notify_one();
+            worker->room.notify_all();
+        }
+
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+std::unique_ptr<SamplePipeline> SamplePipeline::createFromEnvironment()
+{
+    // Leave cores for the DDS receive threads and the GUI
+    const size_t cores = std::thread::hardware_concurrency();
+    size_t workerCount = std::min<size_t>(std::max<size_t>(cores / 2, 1), 4);
+    size_t queueDepth = DEFAULT_QUEUE_DEPTH;
+    OverflowPolicy policy = DROP_OLDEST;
+
+    uint64_t workers = 0;
+    if (ConfigReader::readNumber("DDS_MONITOR_WORKERS", workers) && workers > 0)
+    {
+        if (workers <= MAX_WORKERS)
+        {
+            workerCount = static_cast<size_t>(workers);
+        }
+        else
+        {
+            ConfigReader::reportInvalid("DDS_MONITOR_WORKERS", std::to_string(workers));
+        }
+    }
+
+    // The queue rounds its capacity up to a power of two and allocates it
+    // all at once, so a huge depth can't be honored
+    uint64_t depth = 0;
+    if (ConfigReader::readNumber("DDS_MONITOR_QUEUE_DEPTH", depth) && depth > 0)
+    {
+        if (depth <= MAX_QUEUE_DEPTH)
+        {
+            queueDepth = static_cast<size_t>(depth);
+        }
+        else
+        {
+            ConfigReader::reportInvalid("DDS_MONITOR_QUEUE_DEPTH", std::to_string(depth));
+        }
+    }
+
+    std::string policyValue;
+    if (ConfigReader::readText("DDS_MONITOR_QUEUE_POLICY", policyValue))
+    {
+        std::transform(policyValue.begin(), policyValue.end(), policyValue.begin(), ::tolower);
+        if (policyValue == "block")
+        {
+            policy = BLOCK;
+        }
+        else if (policyValue != "drop_oldest")
+        {
+            ConfigReader::reportInvalid("DDS_MONITOR_QUEUE_POLICY", policyValue);
+        }
+    }
+
+    return std::make_unique<SamplePipeline>(workerCount, queueDepth, policy);
+
+} // End SamplePipeline::createFromEnvironment
+
+
+//------------------------------------------------------------------------------
+size_t SamplePipeline::assignWorker()
+{
+    return m_nextWorker++ % m_workers.size();
+}
+
+
+//------------------------------------------------------------------------------
+bool SamplePipeline::push(const size_t worker, SampleJob job)
+{
+    Worker& target = *m_workers[worker % m_workers.size()];
+    bool dropped = false;
+
+    while (!target.queue.push(job))
+    {
+        if (m_stopping)
+        {
+            drop(job);
+            return false;
+        }
+
+        if (m_policy == DROP_OLDEST)
+        {
+            // Make room by giving up the oldest sample of this worker
+            SampleJob oldest;
+            if (target.queue.pop(oldest))
+            {
+                drop(oldest);
+                dropped = true;
+            }
+        }
+        else
+        {
+            // Hold the receive thread until the worker pops a job. The
+            // timeout covers a missed wake up.
+            std::unique_lock<std::mutex> locker(target.mutex);
+            ++target.blocked;
+            if (target.queue.size() >= target.queue.capacity() && !m_stopping)
+            {
+                target.room.wait_for(locker, std::chrono::milliseconds(10));
+            }
+            --target.blocked;
+        }
+    }
+
+    const size_t depth = target.queue.size();
+    size_t maxDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+    while (depth > maxDepth &&
+           !m_maxQueueDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed))
+    {
+    }
+
+    if (target.sleeping)
+    {
+        std::lock_guard<std::mutex> locker(target.mutex);
+        target.wake.notify_one();
+    }
+
+    return !dropped;
+
+} // End SamplePipeline::push
+
+
+//------------------------------------------------------------------------------
+void SamplePipeline::run(Worker& worker)
+{
+    SampleJob job;
+    while (!m_stopping)
+    {
+        if (worker.queue.pop(job))
+        {
+            // There's room now, so let a blocked receive thread go first
+            if (worker.blocked)
+            {
+                std::lock_guard<std::mutex> locker(worker.mutex);
+                worker.room.notify_all();
+            }
+
+            job.monitor->processSample(std::move(job.sample), job.sourceTime, job.receiveTime, job.writer);
+            job = SampleJob();
+            ++m_processed;
+            continue;
+        }
+
+        // Sleep until a job is pushed. The timeout covers a missed wake up.
+        std::unique_lock<std::mutex> locker(worker.mutex);
+        worker.sleeping = true;
+        if (worker.queue.size() == 0 && !m_stopping)
+        {
+            worker.wake.wait_for(locker, std::chrono::milliseconds(10));
+        }
+        worker.sleeping = false;
+    }
+
+    // Let the pending samples go
+    while (worker.queue.pop(job))
+    {
+        drop(job);
+    }
+
+} // End SamplePipeline::run
+
+
+//------------------------------------------------------------------------------
+void SamplePipeline::drop(SampleJob& job)
+{
+    ++m_dropped;
+    if (job.monitor)
+    {
+        job.monitor->dropSample(std::move(job.sample));
+    }
+    job = SampleJob();
+}
+
+
+//------------------------------------------------------------------------------
+size_t SamplePipeline::workerCount() const
+{
+    return m_workers.size();
+}
+
+
+//------------------------------------------------------------------------------
+size_t SamplePipeline::queueCapacity() const
+{
+    return m_workers.front()->queue.capacity();
+}
+
+
+//------------------------------------------------------------------------------
+size_t SamplePipeline::queueDepth(const size_t worker) const
+{
+    return m_workers[worker % m_workers.size()]->queue.size();
+}
+
+
+//------------------------------------------------------------------------------
+size_t SamplePipeline::maxQueueDepth() const
+{
+    return m_maxQueueDepth;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SamplePipeline::droppedCount() const
+{
+    return m_dropped;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SamplePipeline::processedCount() const
+{
+    return m_processed;
+}
+
+
+//------------------------------------------------------------------------------
+SamplePipeline::OverflowPolicy SamplePipeline::overflowPolicy() const
+{
+    return m_policy;
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,228 @@
+#ifndef __SAMPLE_PIPELINE_H__
+#define __SAMPLE_PIPELINE_H__
+
+#include "bounded_queue.h"
+
+#include <dds/DCPS/RcHandle_T.h>
+#include <dds/DdsDcpsCoreC.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class OpenDynamicData;
+class TopicMonitor;
+
+
+/**
+ * @brief A received sample waiting to be filtered and stored.
+ */
+struct SampleJob
+{
+    /// The monitor of the topic the sample belongs to.
+    OpenDDS::DCPS::RcHandle<TopicMonitor> monitor;
+
+    /// The sample with its retained payload.
+    std::shared_ptr<OpenDynamicData> sample;
+
+    /// The source timestamp in nanoseconds since the epoch.
+    int64_t sourceTime;
+
+    /// The receive timestamp in nanoseconds since the epoch.
+    int64_t receiveTime;
+
+    /// The writer id of the sample in the topic history.
+    uint32_t writer;
+};
+
+
+/**
+ * @brief Worker threads that filter and store samples off the DDS threads.
+ *
+ * @details The recorder callbacks only copy the payload and push a SampleJob.
+ *          Each topic is pinned to one worker with its own bounded queue, so
+ *          samples of a topic are always stored in arrival order. When a queue
+ *          is full the oldest job is dropped, or the receive thread waits for
+ *          room, depending on the overflow policy.
+ */
+class SamplePipeline
+{
+public:
+
+    /// What to do when a worker queue is full.
+    enum OverflowPolicy
+    {
+        DROP_OLDEST, ///< Discard the oldest queued sample.
+        BLOCK        ///< Make the receive thread wait for room.
+    };
+
+    /**
+     * @brief Constructor for the sample pipeline.
+     * @param[in] workerCount The number of worker threads.
+     * @param[in] queueDepth The capacity of each worker queue.
+     * @param[in] policy The overflow policy for full queues.
+     */
+    SamplePipeline(const size_t workerCount,
+                   const size_t queueDepth,
+                   const OverflowPolicy policy);
+
+    /**
+     * @brief Destructor for the sample pipeline. Stops the worker threads.
+     * @remarks Jobs still queued are discarded.
+     */
+    ~SamplePipeline();
+
+    /**
+     * @brief Create the pipeline from the environment settings.
+     * @details $DDS_MONITOR_WORKERS sets the worker count,
+     *          $DDS_MONITOR_QUEUE_DEPTH the queue capacity and
+     *          $DDS_MONITOR_QUEUE_POLICY either "drop_oldest" or "block".
+     *          Counts above MAX_WORKERS or MAX_QUEUE_DEPTH are rejected.
+     *          See ConfigReader for how malformed values are handled.
+     * @return The new pipeline.
+     */
+    static std::unique_ptr<SamplePipeline> createFromEnvironment();
+
+    /**
+     * @brief Pick the worker for a new topic.
+     * @return The worker index. Topics are spread round-robin.
+     */
+    size_t assignWorker();
+
+    /**
+     * @brief Hand a sample to a worker.
+     * @param[in] worker The worker index from assignWorker().
+     * @param[in] job The sample to process.
+     * @return False if an older sample had to be dropped to make room.
+     */
+    bool push(const size_t worker, SampleJob job);
+
+    /**
+     * @brief Get the number of worker threads.
+     * @return The worker count.
+     */
+    size_t workerCount() const;
+
+    /**
+     * @brief Get the capacity of each worker queue.
+     * @return The queue capacity.
+     */
+    size_t queueCapacity() const;
+
+    /**
+     * @brief Get the number of jobs waiting for a worker.
+     * @param[in] worker The worker index.
+     * @return The approximate queue depth.
+     */
+    size_t queueDepth(const size_t worker) const;
+
+    /**
+     * @brief Get the highest queue depth seen by any worker.
+     * @return The high water mark.
+     */
+    size_t maxQueueDepth() const;
+
+    /**
+     * @brief Get the number of samples dropped because a queue was full.
+     * @return The drop count.
+     */
+    uint64_t droppedCount() const;
+
+    /**
+     * @brief Get the number of samples the workers have processed.
+     * @return The processed count.
+     */
+    uint64_t processedCount() const;
+
+    /**
+     * @brief Get the overflow policy.
+     * @return The overflow policy.
+     */
+    OverflowPolicy overflowPolicy() const;
+
+    /// The default capacity of each worker queue.
+    static const size_t DEFAULT_QUEUE_DEPTH = 4096;
+
+    /// The most worker threads $DDS_MONITOR_WORKERS may ask for.
+    static const size_t MAX_WORKERS = 64;
+
+    /// The largest queue capacity $DDS_MONITOR_QUEUE_DEPTH may ask for.
+    static const size_t MAX_QUEUE_DEPTH = 1 << 20;
+
+private:
+
+    /// One worker thread with its queue.
+    struct Worker
+    {
+        /**
+         * @brief Constructor for a worker.
+         * @param[in] queueDepth The capacity of the queue.
+         */
+        explicit Worker(const size_t queueDepth);
+
+        /// The jobs for the topics pinned to this worker.
+        BoundedQueue<SampleJob> queue;
+
+        /// True while the thread waits for work.
+        std::atomic<bool> sleeping;
+
+        /// The number of receive threads waiting for room in the queue.
+        std::atomic<size_t> blocked;
+
+        /// Guards the wake up of a sleeping worker or a blocked receive thread.
+        std::mutex mutex;
+
+        /// Wakes the worker when a job is pushed.
+        std::condition_variable wake;
+
+        /// Wakes the blocked receive threads when a job is popped.
+        std::condition_variable room;
+
+        /// The worker thread.
+        std::thread thread;
+    };
+
+    /**
+     * @brief The loop of a worker thread.
+     * @param[in] worker The worker to serve.
+     */
+    void run(Worker& worker);
+
+    /**
+     * @brief Hand a dropped job back to its topic monitor.
+     * @param[in] job The job that was dropped.
+     */
+    void drop(SampleJob& job);
+
+    /// The workers.
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    /// The overflow policy for full queues.
+    const OverflowPolicy m_policy;
+
+    /// Set to stop the worker threads.
+    std::atomic<bool> m_stopping;
+
+    /// The next worker for assignWorker().
+    std::atomic<size_t> m_nextWorker;
+
+    /// The highest queue depth seen.
+    std::atomic<size_t> m_maxQueueDepth;
+
+    /// The number of dropped samples.
+    std::atomic<uint64_t> m_dropped;
+
+    /// The number of processed samples.
+    std::atomic<uint64_t> m_processed;
+
+}; // End class SamplePipeline
+
+#endif
+
+/**
+ * @}
+ */
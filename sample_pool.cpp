@@ -0,0 +1,148 @@
+#include "sample_pool.h"
+#include "history_budget.h"
+#include "open_dynamic_data.h"
+
+
+//------------------------------------------------------------------------------
+SamplePool::SamplePool(const CORBA::TypeCode* typeCode,
+                       const OpenDDS::DCPS::Encoding::Kind encodingKind,
+                       const OpenDDS::DCPS::Extensibility extensibility,
+                       const std::shared_ptr<HistoryBudget>& budget,
+                       const size_t capacity) :
+                       m_typeCode(typeCode),
+                       m_encodingKind(encodingKind),
+                       m_extensibility(extensibility),
+                       m_budget(budget),
+                       m_capacity(capacity),
+                       m_idleBytes(0),
+                       m_hits(0),
+                       m_misses(0)
+{
+    m_idleSamples.reserve(m_capacity);
+}
+
+
+//------------------------------------------------------------------------------
+SamplePool::~SamplePool()
+{
+    if (m_budget)
+    {
+        m_budget->credit(m_idleBytes);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> SamplePool::acquire()
+{
+    IdleSample idle;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        if (!m_idleSamples.empty())
+        {
+            idle = std::move(m_idleSamples.back());
+            m_idleSamples.pop_back();
+            m_idleBytes -= idle.byteSize;
+        }
+    }
+
+    if (idle.sample)
+    {
+        // The history charges the sample again when it's stored
+        if (m_budget)
+        {
+            m_budget->credit(idle.byteSize);
+        }
+
+        ++m_hits;
+        return handOut(idle.sample.release());
+    }
+
+    ++m_misses;
+    std::shared_ptr<OpenDynamicData> sample = handOut(
+        new OpenDynamicData(m_typeCode, m_encodingKind, m_extensibility));
+    sample->populate();
+    return sample;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> SamplePool::handOut(OpenDynamicData* sample)
+{
+    const std::weak_ptr<SamplePool> pool = weak_from_this();
+    return std::shared_ptr<OpenDynamicData>(sample, [pool](OpenDynamicData* returned)
+    {
+        giveBack(pool, returned);
+    });
+}
+
+
+//------------------------------------------------------------------------------
+void SamplePool::giveBack(const std::weak_ptr<SamplePool>& weakPool, OpenDynamicData* sample)
+{
+    // Whatever isn't kept is deleted on the way out
+    std::unique_ptr<OpenDynamicData> owned(sample);
+    const std::shared_ptr<SamplePool> pool = weakPool.lock();
+
+    // This was the last reference to the sample itself, but member views
+    // held elsewhere still share its storage
+    if (!pool || !owned->recycle())
+    {
+        return;
+    }
+
+    const size_t byteSize = owned->getByteSize();
+    {
+        std::lock_guard<std::mutex> locker(pool->m_mutex);
+        if (pool->m_idleSamples.size() >= pool->m_capacity)
+        {
+            return;
+        }
+
+        IdleSample idle;
+        idle.sample = std::move(owned);
+        idle.byteSize = byteSize;
+        pool->m_idleSamples.push_back(std::move(idle));
+        pool->m_idleBytes += byteSize;
+    }
+
+    if (pool->m_budget)
+    {
+        pool->m_budget->charge(byteSize);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SamplePool::hits() const
+{
+    return m_hits;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SamplePool::misses() const
+{
+    return m_misses;
+}
+
+
+//------------------------------------------------------------------------------
+size_t SamplePool::idleCount() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return m_idleSamples.size();
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SamplePool::idleBytes() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return m_idleBytes;
+}
+
+
+/**
+ * @}
+ */
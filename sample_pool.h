@@ -0,0 +1,151 @@
+#ifndef __SAMPLE_POOL_H__
+#define __SAMPLE_POOL_H__
+
+#include <dds/DCPS/Serializer.h>
+#include <dds/DCPS/TypeSupportImpl.h>
+#include <tao/AnyTypeCode/TypeCode.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class HistoryBudget;
+class OpenDynamicData;
+
+
+/**
+ * @brief Per-topic pool of reusable samples.
+ *
+ * @details Samples handed out by acquire() come back to the pool on their own
+ *          when the last reference to them is dropped, wherever that happens.
+ *          They are reset in place and handed out again, so the sample
+ *          storage, string arena and sequence blocks are reused for the next
+ *          decode.
+ *
+ *          Idle samples still hold memory, so their bytes are charged to the
+ *          history budget until they are handed out again.
+ */
+class SamplePool : public std::enable_shared_from_this<SamplePool>
+{
+public:
+
+    /**
+     * @brief Constructor for the sample pool.
+     * @param[in] typeCode The type definition pointer for the topic.
+     * @param[in] encodingKind The encoding kind for this type. XCDR1 or XCDR2
+     * @param[in] extensibility The extensibility of the topic type.
+     * @param[in] budget The budget idle samples are charged to, or nullptr.
+     * @param[in] capacity The maximum number of idle samples to keep.
+     */
+    SamplePool(const CORBA::TypeCode* typeCode,
+               const OpenDDS::DCPS::Encoding::Kind encodingKind,
+               const OpenDDS::DCPS::Extensibility extensibility,
+               const std::shared_ptr<HistoryBudget>& budget,
+               const size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Destructor for the sample pool.
+     */
+    ~SamplePool();
+
+    /**
+     * @brief Get a default sample, reusing an idle one if possible.
+     * @remarks The pool must be owned by a shared_ptr.
+     * @return The sample. It returns to the pool when its last reference is
+     *         dropped.
+     */
+    std::shared_ptr<OpenDynamicData> acquire();
+
+    /**
+     * @brief Get the number of acquire() calls served from the pool.
+     * @return The hit count.
+     */
+    uint64_t hits() const;
+
+    /**
+     * @brief Get the number of acquire() calls that had to allocate.
+     * @return The miss count.
+     */
+    uint64_t misses() const;
+
+    /**
+     * @brief Get the number of idle samples in the pool.
+     * @return The idle sample count.
+     */
+    size_t idleCount() const;
+
+    /**
+     * @brief Get the number of bytes held by the idle samples.
+     * @return The size in bytes.
+     */
+    uint64_t idleBytes() const;
+
+    /// The default maximum number of idle samples.
+    static const size_t DEFAULT_CAPACITY = 16;
+
+private:
+
+    /// A sample waiting to be handed out again.
+    struct IdleSample
+    {
+        /// The reset sample.
+        std::unique_ptr<OpenDynamicData> sample;
+
+        /// The bytes charged to the budget for it.
+        size_t byteSize;
+    };
+
+    /**
+     * @brief Take back a sample whose last reference was dropped.
+     * @remarks The shared_ptr deleter of every sample from acquire().
+     * @param[in] pool The pool the sample came from. May have expired.
+     * @param[in] sample The sample. Deleted if the pool can't keep it.
+     */
+    static void giveBack(const std::weak_ptr<SamplePool>& pool, OpenDynamicData* sample);
+
+    /**
+     * @brief Hand out a sample that's deleted or returned to this pool.
+     * @param[in] sample The sample to hand out.
+     * @return The owning pointer.
+     */
+    std::shared_ptr<OpenDynamicData> handOut(OpenDynamicData* sample);
+
+    /// The type definition pointer for the topic.
+    const CORBA::TypeCode* m_typeCode;
+
+    /// The encoding kind used for this type.
+    const OpenDDS::DCPS::Encoding::Kind m_encodingKind;
+
+    /// The extensibility of the topic type.
+    const OpenDDS::DCPS::Extensibility m_extensibility;
+
+    /// The budget idle samples are charged to, or nullptr for none.
+    const std::shared_ptr<HistoryBudget> m_budget;
+
+    /// The maximum number of idle samples.
+    const size_t m_capacity;
+
+    /// Samples ready to be handed out again.
+    std::vector<IdleSample> m_idleSamples;
+
+    /// The bytes held by the idle samples.
+    uint64_t m_idleBytes;
+
+    /// Protects m_idleSamples and m_idleBytes.
+    mutable std::mutex m_mutex;
+
+    /// The number of acquire() calls served from the pool.
+    std::atomic<uint64_t> m_hits;
+
+    /// The number of acquire() calls that had to allocate.
+    std::atomic<uint64_t> m_misses;
+
+}; // End class SamplePool
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,752 @@
+#include "spill_store.h"
+#include "config_reader.h"
+#include "open_dynamic_data.h"
+#include "sample_pool.h"
+
+#include <QCoreApplication>
+#include <QDir>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+
+//------------------------------------------------------------------------------
+SpillStore::SpillStore(const QString& directory,
+                       const uint64_t segmentBytes,
+                       const uint64_t maxBytes,
+                       const std::shared_ptr<const DecodePlan>& plan,
+                       const std::shared_ptr<SamplePool>& pool,
+                       const std::weak_ptr<SpillWriter>& writer) :
+                       m_directory(directory),
+                       m_segmentBytes(segmentBytes),
+                       m_maxBytes(maxBytes),
+                       m_plan(plan),
+                       m_pool(pool),
+                       m_writer(writer),
+                       m_nextSegment(0),
+                       m_writeOffset(0),
+                       m_pendingCount(0),
+                       m_pendingSequence(0),
+                       m_clearedSequence(0),
+                       m_count(0),
+                       m_bytes(0)
+{
+    QDir().mkpath(m_directory);
+}
+
+
+//------------------------------------------------------------------------------
+SpillStore::~SpillStore()
+{
+    clear(0);
+    QDir().rmdir(m_directory);
+}
+
+
+//------------------------------------------------------------------------------
+QString SpillStore::segmentPath(const uint64_t id, const char* extension) const
+{
+    return m_directory + "/" +
+           QString("%1").arg(static_cast<qulonglong>(id), 6, 10, QChar('0')) +
+           extension;
+}
+
+
+//------------------------------------------------------------------------------
+bool SpillStore::spill(const std::shared_ptr<const SampleRecord>& record)
+{
+    const std::shared_ptr<SpillWriter> writer = m_writer.lock();
+    if (!writer || !record || record->info.sequence <= m_clearedSequence)
+    {
+        return false;
+    }
+
+    // Readers find the sample here until the batch holding it is published
+    {
+        std::lock_guard<std::mutex> locker(m_queuedMutex);
+        m_queued[record->info.sequence] = record;
+    }
+
+    SpillJob job;
+    job.store = shared_from_this();
+    job.record = record;
+    if (!writer->push(std::move(job)))
+    {
+        release(record->info.sequence);
+        return false;
+    }
+
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+void SpillStore::release(const uint64_t sequence)
+{
+    std::lock_guard<std::mutex> locker(m_queuedMutex);
+    m_queued.erase(sequence);
+}
+
+
+//------------------------------------------------------------------------------
+bool SpillStore::append(const SampleRecord& record)
+{
+    const char* payload = nullptr;
+    size_t length = 0;
+    OpenDDS::DCPS::Encoding::Kind encodingKind;
+    OpenDDS::DCPS::Endianness endianness;
+    if (!record.sample ||
+        !record.sample->getPayload(payload, length, encodingKind, endianness))
+    {
+        release(record.info.sequence);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (record.info.sequence <= m_clearedSequence)
+    {
+        release(record.info.sequence);
+        return false;
+    }
+
+    // Seal the current segment once it's full
+    if (m_segments.empty() ||
+        (m_writeOffset > 0 && m_writeOffset + length > m_segmentBytes))
+    {
+        if (!openSegment())
+        {
+            release(record.info.sequence);
+            return false;
+        }
+    }
+
+    IndexEntry entry;
+    entry.sequence = record.info.sequence;
+    entry.sourceTime = record.info.sourceTime;
+    entry.receiveTime = record.info.receiveTime;
+    entry.offset = m_writeOffset;
+    entry.length = static_cast<uint32_t>(length);
+    entry.encodingKind = static_cast<uint8_t>(encodingKind);
+    entry.endianness = static_cast<uint8_t>(endianness);
+    entry.writer = record.info.writer <= 0xFFFF ?
+        static_cast<uint16_t>(record.info.writer) : 0;
+
+    if (m_dataFile.write(payload, length) != static_cast<qint64>(length) ||
+        m_indexFile.write(reinterpret_cast<const char*>(&entry), sizeof(entry)) !=
+        static_cast<qint64>(sizeof(entry)))
+    {
+        std::cerr << "SpillStore::append: "
+                  << "Failed to write to "
+                  << m_directory.toStdString()
+                  << std::endl;
+        release(record.info.sequence);
+        return false;
+    }
+
+    Segment& segment = m_segments.back();
+    if (segment.firstSequence == 0)
+    {
+        segment.firstSequence = entry.sequence;
+    }
+
+    m_writeOffset += length;
+    m_pendingSequence = entry.sequence;
+    m_pendingCount++;
+    return true;
+
+} // End SpillStore::append
+
+
+//------------------------------------------------------------------------------
+void SpillStore::flush()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    publish();
+}
+
+
+//------------------------------------------------------------------------------
+void SpillStore::publish()
+{
+    if (m_pendingCount == 0 || m_segments.empty())
+    {
+        return;
+    }
+
+    if (!m_dataFile.flush() || !m_indexFile.flush())
+    {
+        std::cerr << "SpillStore::publish: "
+                  << "Failed to flush "
+                  << m_directory.toStdString()
+                  << std::endl;
+    }
+
+    Segment& segment = m_segments.back();
+    const uint64_t addedBytes = (m_writeOffset - segment.dataBytes) +
+                                m_pendingCount * sizeof(IndexEntry);
+
+    segment.count += m_pendingCount;
+    segment.lastSequence = m_pendingSequence;
+    segment.dataBytes = m_writeOffset;
+    m_count += m_pendingCount;
+    m_bytes += addedBytes;
+    m_pendingCount = 0;
+
+    // The published samples are read from disk from now on
+    {
+        std::lock_guard<std::mutex> locker(m_queuedMutex);
+        m_queued.erase(m_queued.begin(), m_queued.upper_bound(m_pendingSequence));
+    }
+
+    // Keep the topic within its disk limit
+    while (m_bytes > m_maxBytes && m_segments.size() > 1)
+    {
+        dropOldestSegment();
+    }
+
+} // End SpillStore::publish
+
+
+//------------------------------------------------------------------------------
+bool SpillStore::openSegment()
+{
+    publish();
+    m_dataFile.close();
+    m_indexFile.close();
+
+    Segment segment;
+    segment.id = m_nextSegment++;
+    segment.firstSequence = 0;
+    segment.lastSequence = 0;
+    segment.count = 0;
+    segment.dataBytes = 0;
+
+    m_dataFile.setFileName(segmentPath(segment.id, ".dat"));
+    m_indexFile.setFileName(segmentPath(segment.id, ".idx"));
+    if (!m_dataFile.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        !m_indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        std::cerr << "SpillStore::openSegment: "
+                  << "Failed to create "
+                  << m_dataFile.fileName().toStdString()
+                  << std::endl;
+        m_dataFile.close();
+        m_indexFile.close();
+        return false;
+    }
+
+    m_segments.push_back(segment);
+    m_writeOffset = 0;
+    return true;
+
+} // End SpillStore::openSegment
+
+
+//------------------------------------------------------------------------------
+void SpillStore::dropOldestSegment()
+{
+    const Segment& segment = m_segments.front();
+    unmap(segment.id);
+    QFile::remove(segmentPath(segment.id, ".dat"));
+    QFile::remove(segmentPath(segment.id, ".idx"));
+
+    m_count -= segment.count;
+    m_bytes -= segment.dataBytes + segment.count * sizeof(IndexEntry);
+    m_segments.pop_front();
+}
+
+
+//------------------------------------------------------------------------------
+void SpillStore::clear(const uint64_t sequence)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_clearedSequence = std::max<uint64_t>(m_clearedSequence, sequence);
+
+    m_dataFile.close();
+    m_indexFile.close();
+    m_mappings.clear();
+    for (const Segment& segment : m_segments)
+    {
+        QFile::remove(segmentPath(segment.id, ".dat"));
+        QFile::remove(segmentPath(segment.id, ".idx"));
+    }
+
+    m_segments.clear();
+    m_writeOffset = 0;
+    m_pendingCount = 0;
+    m_count = 0;
+    m_bytes = 0;
+
+    std::lock_guard<std::mutex> queuedLocker(m_queuedMutex);
+    m_queued.erase(m_queued.begin(), m_queued.upper_bound(m_clearedSequence));
+}
+
+
+//------------------------------------------------------------------------------
+size_t SpillStore::size() const
+{
+    std::lock_guard<std::mutex> locker(m_queuedMutex);
+    return m_count + m_queued.size();
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SpillStore::byteSize() const
+{
+    return m_bytes;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SpillStore::oldestSequence() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    for (const Segment& segment : m_segments)
+    {
+        if (segment.count > 0)
+        {
+            return segment.firstSequence;
+        }
+    }
+
+    std::lock_guard<std::mutex> queuedLocker(m_queuedMutex);
+    return m_queued.empty() ? 0 : m_queued.begin()->first;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SpillStore::latestSequence() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    {
+        // Queued samples are always newer than the published ones
+        std::lock_guard<std::mutex> queuedLocker(m_queuedMutex);
+        if (!m_queued.empty())
+        {
+            return m_queued.rbegin()->first;
+        }
+    }
+
+    for (auto iter = m_segments.rbegin(); iter != m_segments.rend(); ++iter)
+    {
+        if (iter->count > 0)
+        {
+            return iter->lastSequence;
+        }
+    }
+
+    return 0;
+}
+
+
+//------------------------------------------------------------------------------
+void SpillStore::unmap(const uint64_t id) const
+{
+    for (auto iter = m_mappings.begin(); iter != m_mappings.end(); ++iter)
+    {
+        if (iter->id == id)
+        {
+            m_mappings.erase(iter);
+            return;
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+const SpillStore::Mapping* SpillStore::map(const Segment& segment) const
+{
+    if (segment.count == 0)
+    {
+        return nullptr;
+    }
+
+    for (auto iter = m_mappings.begin(); iter != m_mappings.end(); ++iter)
+    {
+        if (iter->id != segment.id)
+        {
+            continue;
+        }
+
+        // The segment being written may have grown since it was mapped
+        if (iter->count < segment.count)
+        {
+            m_mappings.erase(iter);
+            break;
+        }
+
+        m_mappings.splice(m_mappings.begin(), m_mappings, iter);
+        return &m_mappings.front();
+    }
+
+    Mapping mapping;
+    mapping.id = segment.id;
+    mapping.dataFile = std::make_unique<QFile>(segmentPath(segment.id, ".dat"));
+    mapping.indexFile = std::make_unique<QFile>(segmentPath(segment.id, ".idx"));
+    mapping.dataBytes = segment.dataBytes;
+    mapping.count = segment.count;
+    mapping.data = nullptr;
+    mapping.index = nullptr;
+
+    if (mapping.dataFile->open(QIODevice::ReadOnly) &&
+        mapping.indexFile->open(QIODevice::ReadOnly))
+    {
+        if (mapping.dataBytes > 0)
+        {
+            mapping.data = mapping.dataFile->map(0, mapping.dataBytes);
+        }
+        mapping.index = reinterpret_cast<const IndexEntry*>(
+            mapping.indexFile->map(0, mapping.count * sizeof(IndexEntry)));
+    }
+
+    if (!mapping.index || (mapping.dataBytes > 0 && !mapping.data))
+    {
+        std::cerr << "SpillStore::map: "
+                  << "Failed to map "
+                  << mapping.indexFile->fileName().toStdString()
+                  << std::endl;
+        return nullptr;
+    }
+
+    m_mappings.push_front(std::move(mapping));
+    while (m_mappings.size() > MAX_MAPPINGS)
+    {
+        m_mappings.pop_back();
+    }
+
+    return &m_mappings.front();
+
+} // End SpillStore::map
+
+
+//------------------------------------------------------------------------------
+const SpillStore::IndexEntry* SpillStore::find(const uint64_t sequence,
+                                               const Mapping*& mapping) const
+{
+    // There are only a handful of segments, newest first is the common case
+    auto segment = m_segments.rbegin();
+    while (segment != m_segments.rend() &&
+           (segment->count == 0 || segment->firstSequence > sequence))
+    {
+        ++segment;
+    }
+
+    if (segment == m_segments.rend() || sequence > segment->lastSequence)
+    {
+        return nullptr;
+    }
+
+    mapping = map(*segment);
+    if (!mapping)
+    {
+        return nullptr;
+    }
+
+    const IndexEntry* end = mapping->index + mapping->count;
+    const IndexEntry* entry = std::lower_bound(
+        mapping->index, end, sequence,
+        [](const IndexEntry& other, const uint64_t value) { return other.sequence < value; });
+
+    if (entry == end || entry->sequence != sequence)
+    {
+        return nullptr;
+    }
+
+    return entry;
+
+} // End SpillStore::find
+
+
+//------------------------------------------------------------------------------
+QList<SampleInfo> SpillStore::getSampleInfo(const uint64_t sequence,
+                                            const size_t count,
+                                            const uint32_t writer) const
+{
+    QList<SampleInfo> infoList;
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+
+    // The queued samples are newer than anything on disk
+    {
+        std::lock_guard<std::mutex> queuedLocker(m_queuedMutex);
+        auto iter = m_queued.upper_bound(sequence);
+        while (iter != m_queued.begin() && static_cast<size_t>(infoList.size()) < count)
+        {
+            --iter;
+            if (writer == 0 || iter->second->info.writer == writer)
+            {
+                infoList.append(iter->second->info);
+            }
+        }
+    }
+
+    for (auto segment = m_segments.rbegin();
+         segment != m_segments.rend() && static_cast<size_t>(infoList.size()) < count;
+         ++segment)
+    {
+        if (segment->count == 0 || segment->firstSequence > sequence)
+        {
+            continue;
+        }
+
+        const Mapping* mapping = map(*segment);
+        if (!mapping)
+        {
+            break;
+        }
+
+        const IndexEntry* entry = std::upper_bound(
+            mapping->index, mapping->index + mapping->count, sequence,
+            [](const uint64_t value, const IndexEntry& other) { return value < other.sequence; });
+
+        while (entry != mapping->index && static_cast<size_t>(infoList.size()) < count)
+        {
+            --entry;
+            if (writer != 0 && entry->writer != writer)
+            {
+                continue;
+            }
+
+            SampleInfo info;
+            info.sequence = entry->sequence;
+            info.sourceTime = entry->sourceTime;
+            info.receiveTime = entry->receiveTime;
+            info.byteSize = entry->length;
+            info.writer = entry->writer;
+            infoList.append(info);
+        }
+    }
+
+    return infoList;
+
+} // End SpillStore::getSampleInfo
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> SpillStore::getSample(const uint64_t sequence) const
+{
+    {
+        std::lock_guard<std::mutex> locker(m_queuedMutex);
+        const auto iter = m_queued.find(sequence);
+        if (iter != m_queued.end())
+        {
+            return iter->second->sample;
+        }
+    }
+
+    if (!m_pool || !m_plan)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+    const Mapping* mapping = nullptr;
+    const IndexEntry* entry = find(sequence, mapping);
+    if (!entry || entry->offset + entry->length > mapping->dataBytes)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<OpenDynamicData> sample = m_pool->acquire();
+    if (!sample)
+    {
+        return nullptr;
+    }
+
+    // The payload is copied, so the mapping may go away afterwards
+    char* payload = const_cast<char*>(reinterpret_cast<const char*>(mapping->data)) + entry->offset;
+    ACE_Message_Block block(payload, entry->length);
+    block.wr_ptr(entry->length);
+
+    if (!sample->setPayload(m_plan,
+                            block,
+                            static_cast<OpenDDS::DCPS::Encoding::Kind>(entry->encodingKind),
+                            static_cast<OpenDDS::DCPS::Endianness>(entry->endianness)))
+    {
+        return nullptr;
+    }
+
+    return sample;
+
+} // End SpillStore::getSample
+
+
+//------------------------------------------------------------------------------
+SpillWriter::SpillWriter(const QString& directory,
+                         const uint64_t topicBytes,
+                         const size_t queueDepth) :
+                         m_directory(directory),
+                         m_topicBytes(topicBytes),
+                         m_queue(queueDepth),
+                         m_stopping(false),
+                         m_sleeping(false),
+                         m_dropped(0),
+                         m_storeCount(0)
+{
+    QDir().mkpath(m_directory);
+    m_thread = std::thread([this]() { run(); });
+}
+
+
+//------------------------------------------------------------------------------
+SpillWriter::~SpillWriter()
+{
+    m_stopping = true;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_wake.notify_one();
+    }
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    // Let the pending samples go
+    SpillJob job;
+    while (m_queue.pop(job))
+    {
+        job = SpillJob();
+    }
+
+    QDir().rmdir(m_directory);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<SpillWriter> SpillWriter::createFromEnvironment()
+{
+    std::string root;
+    if (!ConfigReader::readText("DDS_MONITOR_SPILL_DIR", root))
+    {
+        return nullptr;
+    }
+
+    uint64_t topicBytes = DEFAULT_TOPIC_BYTES;
+    uint64_t limitMiB = 0;
+    if (ConfigReader::readNumber("DDS_MONITOR_SPILL_LIMIT", limitMiB) && limitMiB > 0)
+    {
+        // Anything larger wraps around when converted to bytes
+        if (limitMiB <= (UINT64_MAX >> 20))
+        {
+            topicBytes = limitMiB * 1024 * 1024;
+        }
+        else
+        {
+            ConfigReader::reportInvalid("DDS_MONITOR_SPILL_LIMIT", std::to_string(limitMiB));
+        }
+    }
+
+    // Each process gets its own directory, so monitors can share the root
+    const QString directory = QString::fromStdString(root) + "/ddsmon-" +
+                              QString::number(QCoreApplication::applicationPid());
+
+    return std::make_shared<SpillWriter>(directory, topicBytes, DEFAULT_QUEUE_DEPTH);
+
+} // End SpillWriter::createFromEnvironment
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<SpillStore> SpillWriter::createStore(const QString& topicName,
+                                                     const std::shared_ptr<const DecodePlan>& plan,
+                                                     const std::shared_ptr<SamplePool>& pool)
+{
+    // Topic names may hold characters that aren't valid in file names
+    QString safeName = topicName;
+    for (QChar& character : safeName)
+    {
+        if (!character.isLetterOrNumber() && character != '_' && character != '-')
+        {
+            character = '_';
+        }
+    }
+
+    const QString directory = m_directory + "/" +
+                              QString::number(m_storeCount++) + "-" + safeName;
+
+    const uint64_t segmentBytes = std::min(SpillStore::DEFAULT_SEGMENT_BYTES,
+                                           std::max<uint64_t>(m_topicBytes / 4, 1));
+
+    return std::make_shared<SpillStore>(
+        directory, segmentBytes, m_topicBytes, plan, pool, shared_from_this());
+}
+
+
+//------------------------------------------------------------------------------
+bool SpillWriter::push(SpillJob job)
+{
+    if (m_stopping || !m_queue.push(job))
+    {
+        ++m_dropped;
+        return false;
+    }
+
+    if (m_sleeping)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_wake.notify_one();
+    }
+
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t SpillWriter::droppedCount() const
+{
+    return m_dropped;
+}
+
+
+//------------------------------------------------------------------------------
+void SpillWriter::run()
+{
+    std::vector<std::shared_ptr<SpillStore>> written;
+    SpillJob job;
+
+    while (!m_stopping)
+    {
+        // Write a batch, then make it visible with one flush per topic
+        size_t batch = 0;
+        while (batch < 1024 && m_queue.pop(job))
+        {
+            if (job.store->append(*job.record) &&
+                std::find(written.begin(), written.end(), job.store) == written.end())
+            {
+                written.push_back(job.store);
+            }
+
+            job = SpillJob();
+            batch++;
+        }
+
+        for (const std::shared_ptr<SpillStore>& store : written)
+        {
+            store->flush();
+        }
+        written.clear();
+
+        if (batch > 0)
+        {
+            continue;
+        }
+
+        // Sleep until a job is pushed. The timeout covers a missed wake up.
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_sleeping = true;
+        if (m_queue.size() == 0 && !m_stopping)
+        {
+            m_wake.wait_for(locker, std::chrono::milliseconds(100));
+        }
+        m_sleeping = false;
+    }
+
+} // End SpillWriter::run
+
+
+/**
+ * @}
+ */
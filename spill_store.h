@@ -0,0 +1,469 @@
+#ifndef __SPILL_STORE_H__
+#define __SPILL_STORE_H__
+
+#include "bounded_queue.h"
+#include "topic_history.h"
+
+#include <dds/DCPS/Serializer.h>
+
+#include <QString>
+#include <QFile>
+#include <QList>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class DecodePlan;
+class OpenDynamicData;
+class SamplePool;
+class SpillWriter;
+
+
+/**
+ * @brief The on-disk history of a single topic.
+ *
+ * @details Samples evicted from the in-memory TopicHistory are appended to a
+ *          chain of segment files. Each segment has a data file that holds
+ *          the raw CDR payloads and an index file of fixed size entries with
+ *          the sequence number, timestamps and payload position of each
+ *          sample. Segments are mapped lazily when a page reads them, and
+ *          only a few stay mapped at a time. The oldest segments are deleted
+ *          once the topic goes over its disk limit.
+ *
+ *          Only the SpillWriter thread appends, so ingest is never held up
+ *          by disk access. Appends and reads share a mutex; appends only
+ *          fill the file buffers and the writer flushes them in batches.
+ *          Queued samples are held in memory and read from there until the
+ *          batch that wrote them is published.
+ */
+class SpillStore : public std::enable_shared_from_this<SpillStore>
+{
+public:
+
+    /**
+     * @brief Constructor for the spill store.
+     * @param[in] directory The directory for the segment files of this topic.
+     * @param[in] segmentBytes The size at which a segment is sealed.
+     * @param[in] maxBytes Delete the oldest segments beyond this size.
+     * @param[in] plan The decode plan for the topic type.
+     * @param[in] pool The sample pool used for samples read back.
+     * @param[in] writer The thread that appends the spilled samples.
+     */
+    SpillStore(const QString& directory,
+               const uint64_t segmentBytes,
+               const uint64_t maxBytes,
+               const std::shared_ptr<const DecodePlan>& plan,
+               const std::shared_ptr<SamplePool>& pool,
+               const std::weak_ptr<SpillWriter>& writer);
+
+    /**
+     * @brief Destructor for the spill store. Deletes the segment files.
+     */
+    ~SpillStore();
+
+    /**
+     * @brief Queue an evicted sample to be written by the spill writer.
+     * @remarks Never blocks for disk access. The sample stays readable
+     *          from memory until it's written and published, then goes back
+     *          to its pool once nothing else holds it.
+     * @param[in] record The evicted sample.
+     * @return False if the sample couldn't be queued.
+     */
+    bool spill(const std::shared_ptr<const SampleRecord>& record);
+
+    /**
+     * @brief Append an evicted sample.
+     * @remarks Only called from the spill writer thread.
+     * @param[in] record The sample to append.
+     * @return True if the sample was written; false otherwise.
+     */
+    bool append(const SampleRecord& record);
+
+    /**
+     * @brief Make the appended samples visible to readers.
+     * @remarks Only called from the spill writer thread.
+     */
+    void flush();
+
+    /**
+     * @brief Delete all spilled samples.
+     * @param[in] sequence Samples queued up to this sequence number are
+     *            discarded instead of appended.
+     */
+    void clear(const uint64_t sequence);
+
+    /**
+     * @brief Get the number of spilled samples, including queued ones.
+     * @return The sample count.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the number of bytes the segment files use on disk.
+     * @return The size in bytes.
+     */
+    uint64_t byteSize() const;
+
+    /**
+     * @brief Get the sequence number of the oldest spilled sample.
+     * @return The sequence number or 0 if nothing was spilled.
+     */
+    uint64_t oldestSequence() const;
+
+    /**
+     * @brief Get the sequence number of the newest spilled sample.
+     * @return The sequence number or 0 if nothing was spilled.
+     */
+    uint64_t latestSequence() const;
+
+    /**
+     * @brief Get the bookkeeping of spilled samples.
+     * @remarks The index only keeps 16 bit writer ids, so samples on disk
+     *          never match a writer id above that.
+     * @param[in] sequence Start at the newest sample up to this sequence.
+     * @param[in] count The maximum number of samples.
+     * @param[in] writer Only list samples of this writer id, or 0 for all.
+     * @return The sample info list. The newest is on the front.
+     */
+    QList<SampleInfo> getSampleInfo(const uint64_t sequence,
+                                    const size_t count,
+                                    const uint32_t writer = 0) const;
+
+    /**
+     * @brief Read a spilled sample back from disk.
+     * @details A sample that's still queued is returned from memory.
+     * @param[in] sequence The sequence number of the sample.
+     * @return The sample or nullptr if it isn't spilled.
+     */
+    std::shared_ptr<OpenDynamicData> getSample(const uint64_t sequence) const;
+
+    /// The default size at which a segment is sealed (64 MiB).
+    static const uint64_t DEFAULT_SEGMENT_BYTES = 64ull * 1024 * 1024;
+
+private:
+
+    /// An index file entry.
+    struct IndexEntry
+    {
+        /// The sequence number of the sample.
+        uint64_t sequence;
+
+        /// The source timestamp in nanoseconds since the epoch.
+        int64_t sourceTime;
+
+        /// The receive timestamp in nanoseconds since the epoch.
+        int64_t receiveTime;
+
+        /// The position of the payload within the data file.
+        uint64_t offset;
+
+        /// The payload length in bytes.
+        uint32_t length;
+
+        /// The encoding kind of the payload.
+        uint8_t encodingKind;
+
+        /// The byte order of the payload.
+        uint8_t endianness;
+
+        /// The writer id of the sample, or 0 if unknown or above 16 bits.
+        uint16_t writer;
+    };
+
+    /// A data file and index file pair.
+    struct Segment
+    {
+        /// The segment number, used for the file names.
+        uint64_t id;
+
+        /// The sequence number of the first sample.
+        uint64_t firstSequence;
+
+        /// The sequence number of the last published sample.
+        uint64_t lastSequence;
+
+        /// The number of published samples.
+        size_t count;
+
+        /// The published size of the data file.
+        uint64_t dataBytes;
+    };
+
+    /// A mapped segment.
+    struct Mapping
+    {
+        /// The segment number.
+        uint64_t id;
+
+        /// The data file.
+        std::unique_ptr<QFile> dataFile;
+
+        /// The index file.
+        std::unique_ptr<QFile> indexFile;
+
+        /// The mapped data file.
+        const uchar* data;
+
+        /// The mapped length of the data file.
+        uint64_t dataBytes;
+
+        /// The mapped index entries.
+        const IndexEntry* index;
+
+        /// The number of mapped index entries.
+        size_t count;
+    };
+
+    /**
+     * @brief Get the path of a segment file.
+     * @param[in] id The segment number.
+     * @param[in] extension The file extension.
+     * @return The file path.
+     */
+    QString segmentPath(const uint64_t id, const char* extension) const;
+
+    /**
+     * @brief Start a new segment for writing.
+     * @remarks Must be called with m_mutex held.
+     * @return True if the files were created; false otherwise.
+     */
+    bool openSegment();
+
+    /**
+     * @brief Write out the file buffers and publish the pending samples.
+     * @remarks Must be called with m_mutex held.
+     */
+    void publish();
+
+    /**
+     * @brief Stop holding a queued sample in memory.
+     * @param[in] sequence The sequence number of the sample.
+     */
+    void release(const uint64_t sequence);
+
+    /**
+     * @brief Remove a segment from the mapping cache.
+     * @remarks Must be called with m_mutex held.
+     * @param[in] id The segment number.
+     */
+    void unmap(const uint64_t id) const;
+
+    /**
+     * @brief Delete the oldest segment.
+     * @remarks Must be called with m_mutex held.
+     */
+    void dropOldestSegment();
+
+    /**
+     * @brief Map a segment for reading.
+     * @remarks Must be called with m_mutex held.
+     * @param[in] segment The segment to map.
+     * @return The mapping or nullptr if the files can't be mapped.
+     */
+    const Mapping* map(const Segment& segment) const;
+
+    /**
+     * @brief Find the index entry of a sample.
+     * @remarks Must be called with m_mutex held.
+     * @param[in] sequence The sequence number of the sample.
+     * @param[out] mapping The mapping holding the sample.
+     * @return The index entry or nullptr if the sample isn't spilled.
+     */
+    const IndexEntry* find(const uint64_t sequence, const Mapping*& mapping) const;
+
+    /// The directory of the segment files.
+    const QString m_directory;
+
+    /// The size at which a segment is sealed.
+    const uint64_t m_segmentBytes;
+
+    /// The oldest segments are deleted beyond this size.
+    const uint64_t m_maxBytes;
+
+    /// The decode plan for the topic type.
+    const std::shared_ptr<const DecodePlan> m_plan;
+
+    /// The sample pool used for samples read back.
+    const std::shared_ptr<SamplePool> m_pool;
+
+    /// The thread that appends the spilled samples.
+    const std::weak_ptr<SpillWriter> m_writer;
+
+    /// The segments, oldest first. The last one is being written.
+    std::deque<Segment> m_segments;
+
+    /// The segment number for the next segment.
+    uint64_t m_nextSegment;
+
+    /// The data file being written.
+    QFile m_dataFile;
+
+    /// The index file being written.
+    QFile m_indexFile;
+
+    /// The bytes written to the data file, including unpublished ones.
+    uint64_t m_writeOffset;
+
+    /// The written but unpublished index entries.
+    size_t m_pendingCount;
+
+    /// The sequence number of the last written sample.
+    uint64_t m_pendingSequence;
+
+    /// Queued samples up to this sequence number were cleared.
+    std::atomic<uint64_t> m_clearedSequence;
+
+    /// The number of published samples.
+    std::atomic<size_t> m_count;
+
+    /// The published size of all segments.
+    std::atomic<uint64_t> m_bytes;
+
+    /// The recently mapped segments, most recent first.
+    mutable std::list<Mapping> m_mappings;
+
+    /// Protects m_segments and m_mappings.
+    mutable std::mutex m_mutex;
+
+    /// The queued samples that aren't published yet, by sequence number.
+    std::map<uint64_t, std::shared_ptr<const SampleRecord>> m_queued;
+
+    /// Protects m_queued. Taken after m_mutex when both are held.
+    mutable std::mutex m_queuedMutex;
+
+    /// The maximum number of mapped segments.
+    static const size_t MAX_MAPPINGS = 4;
+
+}; // End class SpillStore
+
+
+/**
+ * @brief An evicted sample waiting to be spilled.
+ */
+struct SpillJob
+{
+    /// The spill store of the topic.
+    std::shared_ptr<SpillStore> store;
+
+    /// The evicted sample.
+    std::shared_ptr<const SampleRecord> record;
+};
+
+
+/**
+ * @brief The thread that writes evicted samples to the spill stores.
+ *
+ * @details Eviction only pushes a SpillJob. If the queue is full the sample
+ *          is not spilled, so a slow disk never holds up ingest.
+ */
+class SpillWriter : public std::enable_shared_from_this<SpillWriter>
+{
+public:
+
+    /**
+     * @brief Constructor for the spill writer.
+     * @param[in] directory The root directory for the spill files.
+     * @param[in] topicBytes The disk limit of each topic.
+     * @param[in] queueDepth The capacity of the job queue.
+     */
+    SpillWriter(const QString& directory,
+                const uint64_t topicBytes,
+                const size_t queueDepth);
+
+    /**
+     * @brief Destructor for the spill writer. Stops the thread.
+     * @remarks Release the spill stores first. The spill directory is only
+     *          removed once their segment files are gone.
+     */
+    ~SpillWriter();
+
+    /**
+     * @brief Create the spill writer from the environment settings.
+     * @details Spilling is enabled by $DDS_MONITOR_SPILL_DIR.
+     *          $DDS_MONITOR_SPILL_LIMIT sets the disk limit of each topic in
+     *          MiB.
+     * @return The new writer or nullptr if spilling is disabled.
+     */
+    static std::shared_ptr<SpillWriter> createFromEnvironment();
+
+    /**
+     * @brief Create the spill store for a topic.
+     * @param[in] topicName The name of the topic.
+     * @param[in] plan The decode plan for the topic type.
+     * @param[in] pool The sample pool of the topic.
+     * @return The spill store.
+     */
+    std::shared_ptr<SpillStore> createStore(const QString& topicName,
+                                            const std::shared_ptr<const DecodePlan>& plan,
+                                            const std::shared_ptr<SamplePool>& pool);
+
+    /**
+     * @brief Queue an evicted sample.
+     * @param[in] job The sample to spill.
+     * @return False if the queue was full and the sample was not spilled.
+     */
+    bool push(SpillJob job);
+
+    /**
+     * @brief Get the number of samples that couldn't be queued.
+     * @return The drop count.
+     */
+    uint64_t droppedCount() const;
+
+    /// The default disk limit of each topic (1 GiB).
+    static const uint64_t DEFAULT_TOPIC_BYTES = 1024ull * 1024 * 1024;
+
+    /// The default capacity of the job queue.
+    static const size_t DEFAULT_QUEUE_DEPTH = 16384;
+
+private:
+
+    /**
+     * @brief The loop of the writer thread.
+     */
+    void run();
+
+    /// The root directory for the spill files.
+    const QString m_directory;
+
+    /// The disk limit of each topic.
+    const uint64_t m_topicBytes;
+
+    /// The samples waiting to be written.
+    BoundedQueue<SpillJob> m_queue;
+
+    /// Set to stop the thread.
+    std::atomic<bool> m_stopping;
+
+    /// True while the thread waits for work.
+    std::atomic<bool> m_sleeping;
+
+    /// The number of samples that couldn't be queued.
+    std::atomic<uint64_t> m_dropped;
+
+    /// The number of stores created, used for unique directory names.
+    std::atomic<uint64_t> m_storeCount;
+
+    /// Guards the wake up of the sleeping thread.
+    std::mutex m_mutex;
+
+    /// Wakes the thread when a job is pushed.
+    std::condition_variable m_wake;
+
+    /// The writer thread.
+    std::thread m_thread;
+
+}; // End class SpillWriter
+
+#endif
+
+/**
+ * @}
+ */
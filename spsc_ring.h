@@ -0,0 +1,146 @@
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include "power_of_two.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * @brief Fixed capacity ring for a single producer and a single consumer.
+ *
+ * @details Neither side locks. The producer fills the slot from claim() in
+ *          place and makes it visible with publish(). The consumer reads the
+ *          slot from front() in place and hands it back with release(), or
+ *          copies everything out with drain(). The head and tail counters
+ *          are published with release stores, so the slot contents are
+ *          visible to the other side before its counter.
+ *
+ *          Slots are reused rather than reconstructed, so buffers inside them
+ *          keep their capacity. A full ring refuses new items and counts them
+ *          as dropped, which keeps the oldest items for the consumer.
+ */
+template<class T>
+class SpscRing
+{
+public:
+
+    /**
+     * @brief Constructor for the ring.
+     * @param[in] capacity The number of slots. Rounded up to a power of two.
+     */
+    explicit SpscRing(const size_t capacity) :
+                      m_slots(roundUpPowerOfTwo(capacity)),
+                      m_mask(m_slots.size() - 1),
+                      m_head(0),
+                      m_tail(0),
+                      m_droppedCount(0)
+    {}
+
+    /**
+     * @brief Get the next free slot.
+     * @remarks Producer side. Nothing is visible until publish() is called,
+     *          so a slot that can't be filled is simply not published.
+     * @return The slot to fill, or null if the ring is full. A full ring
+     *         counts the item as dropped.
+     */
+    T* claim()
+    {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+        {
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        return &m_slots[head & m_mask];
+    }
+
+    /**
+     * @brief Make the slot from the last claim() visible to the consumer.
+     * @remarks Producer side.
+     */
+    void publish()
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Get the oldest published slot.
+     * @remarks Consumer side. The slot stays valid until release().
+     * @return The slot, or null if the ring is empty.
+     */
+    T* front()
+    {
+        const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return &m_slots[tail & m_mask];
+    }
+
+    /**
+     * @brief Hand the slot from front() back to the producer.
+     * @remarks Consumer side.
+     */
+    void release()
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy every published item to a list and release them at once.
+     * @remarks Consumer side.
+     * @param[out] items The items are appended here, oldest first.
+     * @return The number of items appended.
+     */
+    size_t drain(std::vector<T>& items)
+    {
+        const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        for (uint64_t i = tail; i < head; i++)
+        {
+            items.push_back(m_slots[i & m_mask]);
+        }
+
+        m_tail.store(head, std::memory_order_release);
+        return static_cast<size_t>(head - tail);
+    }
+
+    /**
+     * @brief Get the number of items refused because the ring was full.
+     * @return The dropped item count.
+     */
+    uint64_t droppedCount() const
+    {
+        return m_droppedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    /// The slots of the ring.
+    std::vector<T> m_slots;
+
+    /// The ring size minus one.
+    const size_t m_mask;
+
+    /// The number of items ever published. Written by the producer.
+    std::atomic<uint64_t> m_head;
+
+    /// The number of items ever released. Written by the consumer.
+    std::atomic<uint64_t> m_tail;
+
+    /// The number of items refused because the ring was full.
+    std::atomic<uint64_t> m_droppedCount;
+
+}; // End class SpscRing
+
+#endif
+
+/**
+ * @}
+ */
@@ -1,4 +1,13 @@
 #include "table_page.h"
+#include "topic_history.h"
+#include "change_notifier.h"
+#include "field_statistics.h"
+#include "history_budget.h"
+#include "history_list_model.h"
+#include "instance_list_model.h"
+#include "instance_store.h"
+#include "spill_store.h"
+#include "topic_health.h"
 #include "dds_manager.h"
 #include "dynamic_meta_struct.h"
 #include "open_dynamic_data.h"
@@ -8,8 +17,12 @@
 #include "topic_monitor.h"
 #include "dds_data.h"
 #include "graph_page.h"
+#include "waterfall_page.h"
 #include "qos_dictionary.h"
 #include <QMessageBox>
+#include <QRegularExpression>
+#include <QLocale>
+#include <chrono>
 #include <iostream>
 #include <exception>
 
@@ -19,14 +32,15 @@ TablePage::TablePage(const QString& topicName,
                      QWidget *parent) :
                      QWidget(parent),
                      m_topicName(topicName),
-                     m_refreshTimer(this)
+                     m_history(CommonData::getHistory(topicName)),
+                     m_selectedSequence(0)
 {
     setupUi(this);
 
 //     QFont monoFont("Monospace", 10);
 //     monoFont.setStyleHint(QFont::Monospace);
 //     topicTableView->setFont(monoFont);
-//     historyTable->setFont(monoFont);
+//     historyView->setFont(monoFont);
 
     matchedPubTitleLabel->hide(); // Pub match count not supported yet
     matchedSubTitleLabel->hide(); // Sub match count not supported yet
@@ -34,7 +48,9 @@ TablePage::TablePage(const QString& topicName,
     revertButton->setEnabled(false);
     newPlotButton->setEnabled(false);
     attachPlotButton->setEnabled(false);
+    waterfallButton->setEnabled(false);
     recordButton->setEnabled(false);
+    resetStatsButton->setEnabled(false);
 
     // Create a data model for this topic
     m_tableModel = std::make_unique<TopicTableModel>(topicTableView, m_topicName);
@@ -42,12 +58,46 @@ TablePage::TablePage(const QString& topicName,
     //topicTableView->setColumnWidth(TopicTableModel::STATUS_COLUMN, 21);
     connect(m_tableModel.get(), SIGNAL(dataHasChanged()), this, SLOT(dataHasChanged()));
 
+    // Keep showing statistics that were turned on before the page was closed
+    if (m_history->getStatistics())
+    {
+        statsButton->setChecked(true);
+    }
+
+    // The history pane only gets the changes to the sample history
+    m_historyModel = std::make_unique<HistoryListModel>(m_history, HISTORY_PAGE_SIZE);
+    historyView->setModel(m_historyModel.get());
+    connect(historyView->selectionModel(),
+            SIGNAL(currentRowChanged(const QModelIndex&, const QModelIndex&)),
+            this, SLOT(historyRowChanged(const QModelIndex&)));
+
+    // Keep tracking instances that were keyed before the page was closed
+    if (m_history->getInstanceStore())
+    {
+        keyButton->setChecked(true);
+    }
+
     // Create a topic monitor to receive the data samples
     m_topicMonitor = std::make_unique <TopicMonitor>(topicName);
     m_topicReplayer = std::make_unique<TopicReplayer>(topicName);
 
-    connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(refreshPage()));
-    m_refreshTimer.start(REFRESH_TIMEOUT);
+    // Refresh when the samples change, rather than polling the history
+    if (CommonData::m_changeNotifier)
+    {
+        connect(CommonData::m_changeNotifier.get(), SIGNAL(topicChanged(const QString&)),
+                this, SLOT(topicChanged(const QString&)));
+    }
+
+    // The plot buttons depend on the member selection
+    connect(topicTableView->selectionModel(),
+            SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),
+            this, SLOT(refreshPage()));
+    refreshPage();
+
+    // The health panel is polled, so a topic that stops is noticed
+    connect(&m_healthTimer, SIGNAL(timeout()), this, SLOT(refreshHealth()));
+    m_healthTimer.start(HEALTH_INTERVAL);
+    refreshHealth();
 
 } // End TablePage::TablePage
 
@@ -57,7 +107,7 @@ TablePage::~TablePage()
 {
     m_topicReplayer.release();  //Leak on purpose since DDS shutdown isn't quite right
     m_topicMonitor.release();  //Leak on purpose since DDS shutdown isn't quite right
-    CommonData::flushSamples(m_topicName);
+    m_history->clear();
 }
 
 
@@ -71,8 +121,9 @@ void TablePage::on_clearSamplesButton_clicked()
     }
 
     std::shared_ptr<OpenDynamicData> blankSample = CreateOpenDynamicData(topicInfo->typeCode, QosDictionary::getEncodingKind(), topicInfo->extensibility);
-    CommonData::clearSamples(m_topicName);
+    m_history->clear();
     m_tableModel->setSample(blankSample);
+    m_topicMonitor->getHealth()->reset();
 
     refreshPage();
 }
@@ -171,30 +222,19 @@ void TablePage::on_filterButton_clicked()
     }
 
 
-    if (!filter.isEmpty())
+    // The monitor compiles the filter once and rejects invalid ones
+    QString errorMessage;
+    if (!m_topicMonitor->setFilter(filter, &errorMessage))
     {
-        // Let OpenDDS validate the filter. An exception is thrown with details.
-        // This will only check the SQL syntax.
-        try
-        {
-            OpenDDS::DCPS::FilterEvaluator filterTest(filter.toUtf8().data(), false);
-        }
-        catch (const std::exception& e)
-        {
-            QString errorMessage = e.what();
-            QMessageBox::warning(
-                this,
-                "Invalid Filter",
-                "An invalid filter was created:\n" + errorMessage);
+        QMessageBox::warning(
+            this,
+            "Invalid Filter",
+            "An invalid filter was created:\n" + errorMessage);
 
-            return;
-        }
+        return;
     }
 
-    m_refreshTimer.stop();
-    CommonData::flushSamples(m_topicName);
-    m_topicMonitor->setFilter(filter);
-    m_refreshTimer.start(REFRESH_TIMEOUT);
+    m_history->clear();
 
 
     // We're getting data now, so show the correct freeze button state
@@ -207,17 +247,10 @@ void TablePage::on_filterButton_clicked()
 //------------------------------------------------------------------------------
 void TablePage::on_useLatestButton_clicked()
 {
-    // Use the latest sample if the button is checked
-    if (useLatestButton->isChecked() && historyTable->rowCount() > 1)
+    // Go back to the newest page, which selects the latest sample
+    if (useLatestButton->isChecked() && m_historyModel->anchor() != 0)
     {
-        QTableWidgetItem* item = historyTable->item(0, 0);
-        if (item)
-        {
-            historyTable->clearSelection();
-            historyTable->setCurrentItem(item);
-            item->setSelected(true);
-            setSample(item->text());
-        }
+        m_historyModel->setAnchor(0);
     }
 
     refreshPage();
@@ -281,6 +314,180 @@ void TablePage::on_iniButton_clicked()
 } // End TablePage::on_iniButton_clicked
 
 
+//------------------------------------------------------------------------------
+void TablePage::on_historyDepthButton_clicked()
+{
+    bool ok = false;
+    const int maxSamples = QInputDialog::getInt(
+        this,
+        "History Depth",
+        "Maximum number of samples to keep:",
+        static_cast<int>(m_history->maxSamples()),
+        1,
+        10000000,
+        1,
+        &ok);
+
+    if (!ok)
+    {
+        return;
+    }
+
+    const double window = QInputDialog::getDouble(
+        this,
+        "History Depth",
+        "Only keep samples received within this many seconds (0 = no limit):",
+        m_history->maxAge() / 1e9,
+        0,
+        86400,
+        3,
+        &ok);
+
+    if (!ok)
+    {
+        return;
+    }
+
+    m_history->setDepth(static_cast<size_t>(maxSamples),
+                        static_cast<int64_t>(window * 1e9));
+
+} // End TablePage::on_historyDepthButton_clicked
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_statsButton_toggled(bool checked)
+{
+    if (!checked)
+    {
+        m_history->setStatistics(nullptr);
+        m_tableModel->setStatistics(nullptr);
+        resetStatsButton->setEnabled(false);
+        return;
+    }
+
+    std::shared_ptr<FieldStatistics> statistics = m_history->getStatistics();
+    if (!statistics)
+    {
+        std::shared_ptr<TopicInfo> topicInfo = CommonData::getTopicInfo(m_topicName);
+        if (!topicInfo || !topicInfo->typeCode)
+        {
+            statsButton->setChecked(false);
+            return;
+        }
+
+        statistics = std::make_shared<FieldStatistics>(topicInfo->typeCode);
+        m_history->setStatistics(statistics);
+    }
+
+    m_tableModel->setStatistics(statistics);
+    resetStatsButton->setEnabled(true);
+
+} // End TablePage::on_statsButton_toggled
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_resetStatsButton_clicked()
+{
+    const std::shared_ptr<FieldStatistics> statistics = m_history->getStatistics();
+    if (statistics)
+    {
+        statistics->reset();
+        m_tableModel->refreshStatistics();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_keyButton_toggled(bool checked)
+{
+    if (!checked)
+    {
+        m_history->setInstanceStore(nullptr);
+        showInstances(nullptr);
+        return;
+    }
+
+    std::shared_ptr<InstanceStore> instances = m_history->getInstanceStore();
+    if (!instances)
+    {
+        QItemSelectionModel* selectionModel = topicTableView->selectionModel();
+        QModelIndexList indexList = selectionModel->selectedIndexes();
+        QStringList keyNames;
+
+        // The type code doesn't say which members are keys, so the user picks them
+        for (int i = 0; i < indexList.size(); i++)
+        {
+            if (indexList.at(i).column() == TopicTableModel::NAME_COLUMN)
+            {
+                keyNames << indexList.at(i).data(Qt::DisplayRole).toString();
+            }
+        }
+
+        const std::vector<MemberPath> keyPaths =
+            CommonData::resolveMembers(m_topicName, keyNames);
+        bool valid = !keyPaths.empty();
+        for (const MemberPath& keyPath : keyPaths)
+        {
+            valid = valid && keyPath.isValid();
+        }
+
+        if (!valid)
+        {
+            QMessageBox::information(
+                this,
+                "Track Instances",
+                "Select the key members of this topic first.");
+
+            keyButton->setChecked(false);
+            return;
+        }
+
+        instances = std::make_shared<InstanceStore>(keyPaths, CommonData::m_historyBudget);
+        m_history->setInstanceStore(instances);
+    }
+
+    showInstances(instances);
+    historyTabWidget->setCurrentWidget(keysTab);
+
+} // End TablePage::on_keyButton_toggled
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_olderButton_clicked()
+{
+    const uint64_t oldest = m_historyModel->sequence(m_historyModel->rowCount() - 1);
+    if (oldest <= 1)
+    {
+        return;
+    }
+
+    // Page back from the oldest sample shown
+    useLatestButton->setChecked(false);
+    m_historyModel->setAnchor(oldest - 1);
+    refreshPage();
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_newerButton_clicked()
+{
+    uint64_t anchor = m_historyModel->anchor();
+    if (anchor == 0)
+    {
+        return;
+    }
+
+    anchor += HISTORY_PAGE_SIZE;
+    if (anchor >= m_history->latestSequence())
+    {
+        anchor = 0;
+    }
+
+    m_historyModel->setAnchor(anchor);
+    refreshPage();
+}
+
+
 //------------------------------------------------------------------------------
 void TablePage::on_revertButton_clicked()
 {
@@ -304,19 +511,31 @@ void TablePage::on_publishButton_clicked()
 
 
 //------------------------------------------------------------------------------
-void TablePage::on_historyTable_itemSelectionChanged()
+void TablePage::historyRowChanged(const QModelIndex& current)
 {
-    QList<QTableWidgetItem*> items = historyTable->selectedItems();
-    for (int i = 0; i < items.count(); i++)
+    if (!current.isValid())
     {
-        QTableWidgetItem* selectedItem = items.at(i);
-        if (selectedItem->row() != 0)
-        {
-            useLatestButton->setChecked(false);
-        }
+        return;
+    }
 
-        setSample(selectedItem->text());
+    if (current.row() != 0)
+    {
+        useLatestButton->setChecked(false);
     }
+
+    setSample(m_historyModel->sequence(current.row()));
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::instanceRowChanged(const QModelIndex& current)
+{
+    if (!current.isValid() || !m_instanceModel)
+    {
+        return;
+    }
+
+    setSample(m_instanceModel->latest(current.row()));
 }
 
 
@@ -475,6 +694,67 @@ void TablePage::on_attachPlotButton_clicked()
 } // End TablePage::on_attachPlotButton_clicked
 
 
+//------------------------------------------------------------------------------
+void TablePage::on_waterfallButton_clicked()
+{
+    QItemSelectionModel* selectionModel = topicTableView->selectionModel();
+    QModelIndexList indexList = selectionModel->selectedIndexes();
+    QString variableName;
+
+    // Use the first selected member
+    for (int i = 0; i < indexList.size(); i++)
+    {
+        if (indexList.at(i).column() == TopicTableModel::NAME_COLUMN)
+        {
+            variableName = indexList.at(i).data(Qt::DisplayRole).toString();
+            break;
+        }
+    }
+
+    if (variableName.isEmpty())
+    {
+        return;
+    }
+
+    // The table lists array elements, which stand for their whole array
+    static const QRegularExpression elementIndex("\\[\\d+\\]$");
+    variableName.remove(elementIndex);
+
+    if (!WaterfallPage::isNumericArray(CommonData::resolveMember(m_topicName, variableName)))
+    {
+        QMessageBox::warning(
+            this,
+            "No Array Selected",
+            "Select an element of an array or sequence of numbers.");
+
+        return;
+    }
+
+    QDialog *waterfallDialog = new QDialog(this);
+    QVBoxLayout *layout = new QVBoxLayout(waterfallDialog);
+    WaterfallPage *waterfallPage =
+        new WaterfallPage(m_topicName, variableName, waterfallDialog);
+
+    waterfallDialog->setAttribute(Qt::WA_DeleteOnClose);
+    waterfallDialog->setObjectName("waterfallDialog");
+    waterfallDialog->setWindowFlags(
+        Qt::CustomizeWindowHint |
+        Qt::WindowTitleHint |
+        Qt::Window |
+        Qt::WindowCloseButtonHint);
+
+    layout->addWidget(waterfallPage);
+    waterfallDialog->setWindowTitle(
+        "DDS Waterfall " + variableName + " [" + m_topicName + "]");
+    waterfallDialog->setWindowIcon(QIcon(":/images/monitor.png"));
+    waterfallDialog->setSizeGripEnabled(true);
+    waterfallDialog->setLayout(layout);
+    waterfallDialog->resize(700, 500);
+    waterfallDialog->show();
+
+} // End TablePage::on_waterfallButton_clicked
+
+
 //------------------------------------------------------------------------------
 void TablePage::on_recordButton_clicked()
 {
@@ -553,48 +833,71 @@ void TablePage::refreshPage()
     {
         newPlotButton->setEnabled(false);
         attachPlotButton->setEnabled(false);
+        waterfallButton->setEnabled(false);
         recordButton->setEnabled(false);
     }
     else
     {
         newPlotButton->setEnabled(true);
         attachPlotButton->setEnabled(true);
+        waterfallButton->setEnabled(true);
         recordButton->setEnabled(true);
     }
 
 
-    // Don't repopulate the history widget is nothing changed
-    QStringList sampleNames = CommonData::getSampleList(m_topicName);
-    if (m_historyList == sampleNames)
+    // Show how much memory the history of this topic is using
+    QString sizeText = QString::number(m_history->size()) + " samples\n" +
+        QLocale::system().formattedDataSize(static_cast<qint64>(m_history->byteSize()));
+    if (CommonData::m_historyBudget && CommonData::m_historyBudget->limit() > 0)
     {
-        return;
+        sizeText += "\nTotal " + QLocale::system().formattedDataSize(
+            static_cast<qint64>(CommonData::m_historyBudget->usedBytes())) + " / " +
+            QLocale::system().formattedDataSize(
+            static_cast<qint64>(CommonData::m_historyBudget->limit()));
+    }
+    const std::shared_ptr<SpillStore> spill = m_history->getSpillStore();
+    if (spill && spill->size() > 0)
+    {
+        sizeText += "\n" + QString::number(spill->size()) + " on disk (" +
+            QLocale::system().formattedDataSize(static_cast<qint64>(spill->byteSize())) + ")";
     }
+    historySizeLabel->setText(sizeText);
+
+
+    // The statistics keep running while the page is frozen
+    m_tableModel->refreshStatistics();
+
+    // Only the samples stored or evicted since the last refresh are applied
+    m_historyModel->refresh();
+    newerButton->setEnabled(m_historyModel->anchor() != 0);
+    olderButton->setEnabled(m_historyModel->rowCount() >= HISTORY_PAGE_SIZE);
 
-    m_historyList = sampleNames;
-    historyTable->clearContents();
-    historyTable->setRowCount(sampleNames.size());
-    for (int i = 0; i < sampleNames.size(); i++)
+    if (m_instanceModel)
     {
-        QTableWidgetItem* item = new QTableWidgetItem;
-        item->setText(sampleNames.at(i));
-        historyTable->setItem(i, 0, item);
+        m_instanceModel->refresh();
+    }
 
-        if (item->text() == m_selectedSample && !useLatestButton->isChecked())
+    // On the Keys tab, the latest sample is the newest of the selected instance
+    if (m_instanceModel && historyTabWidget->currentWidget() == keysTab)
+    {
+        const QModelIndex current = instanceView->currentIndex();
+        if (useLatestButton->isChecked() && current.isValid())
         {
-            item->setSelected(true);
+            setSample(m_instanceModel->latest(current.row()));
         }
     }
 
     // Use the latest sample if the button is checked
-    if (useLatestButton->isChecked() && historyTable->rowCount() > 0)
+    else if (useLatestButton->isChecked() && m_historyModel->rowCount() > 0)
     {
-        QTableWidgetItem* item = historyTable->item(0, 0);
-        if (item)
+        const QModelIndex latest = m_historyModel->index(0);
+        if (historyView->currentIndex() != latest)
+        {
+            historyView->setCurrentIndex(latest);
+        }
+        else
         {
-            historyTable->clearSelection();
-            historyTable->setCurrentItem(item);
-            item->setSelected(true);
-            setSample(item->text());
+            setSample(m_historyModel->sequence(0));
         }
     }
 
@@ -602,21 +905,159 @@ void TablePage::refreshPage()
 
 
 //------------------------------------------------------------------------------
-void TablePage::setSample(const QString& sampleName)
+void TablePage::topicChanged(const QString& topicName)
+{
+    if (topicName == m_topicName)
+    {
+        refreshPage();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::refreshHealth()
 {
-    if (sampleName.isEmpty())
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    TopicHealth::Snapshot health;
+    m_topicMonitor->getHealth()->getSnapshot(now, health);
+
+    QString text = QString::number(health.rate, 'f', 1) + " Hz\n";
+    auto appendPercentiles = [&text](const QString& title,
+                                     const LatencyHistogram::Snapshot& histogram)
+    {
+        text += title + "\n";
+        for (const double percentile : { 50.0, 99.0, 99.9 })
+        {
+            text += " p" + QString::number(percentile) + " " +
+                formatDuration(LatencyHistogram::percentile(histogram, percentile)) + "\n";
+        }
+    };
+
+    appendPercentiles("Interval", health.interval);
+    appendPercentiles("Latency", health.latency);
+
+    // Samples the pipeline had no room for point at a slow consumer
+    text += QString::number(m_topicMonitor->getDroppedCount()) + " dropped";
+    healthLabel->setText(text);
+
+    refreshWriters();
+
+} // End TablePage::refreshHealth
+
+
+//------------------------------------------------------------------------------
+void TablePage::refreshWriters()
+{
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Row 0 is all writers, and writer ids start at 1, so a writer's row is
+    // its id
+    const QList<WriterInfo> writers = m_history->getWriters();
+    for (const WriterInfo& writer : writers)
+    {
+        const int row = static_cast<int>(writer.id);
+        if (row >= writerComboBox->count())
+        {
+            writerComboBox->addItem(QString(), writer.id);
+        }
+
+        // A writer that missed several of its own intervals is shown silent
+        const int64_t silence = now - writer.lastSeen;
+        QString text = "Writer " + QString::number(writer.id) + ": ";
+        if (writer.interval > 0 && silence < SILENT_INTERVALS * writer.interval)
+        {
+            text += QString::number(1e9 / writer.interval, 'f', 1) + " Hz";
+        }
+        else
+        {
+            text += "silent " + formatDuration(silence);
+        }
+
+        writerComboBox->setItemText(row, text);
+        writerComboBox->setItemData(row,
+            writer.name + "\n" + QString::number(writer.count) + " samples",
+            Qt::ToolTipRole);
+    }
+
+} // End TablePage::refreshWriters
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_writerComboBox_currentIndexChanged(int index)
+{
+    const uint32_t writer = index > 0 ? static_cast<uint32_t>(index) : 0;
+    if (writer == m_historyModel->writer())
     {
         return;
     }
 
-    const int index = historyTable->currentRow();
-    if (index < 0)
+    m_historyModel->setWriter(writer);
+    refreshPage();
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::showInstances(const std::shared_ptr<InstanceStore>& instances)
+{
+    // The view doesn't delete the selection model of the old model
+    QItemSelectionModel* oldSelection = instanceView->selectionModel();
+    if (instances)
+    {
+        std::unique_ptr<InstanceListModel> model =
+            std::make_unique<InstanceListModel>(instances);
+        instanceView->setModel(model.get());
+        m_instanceModel = std::move(model);
+        connect(instanceView->selectionModel(),
+                SIGNAL(currentRowChanged(const QModelIndex&, const QModelIndex&)),
+                this, SLOT(instanceRowChanged(const QModelIndex&)));
+    }
+    else
+    {
+        instanceView->setModel(nullptr);
+        m_instanceModel.reset();
+    }
+
+    delete oldSelection;
+}
+
+
+//------------------------------------------------------------------------------
+QString TablePage::formatDuration(const int64_t nanoseconds)
+{
+    if (nanoseconds < 0)
+    {
+        return "-";
+    }
+    if (nanoseconds < 1000)
+    {
+        return QString::number(nanoseconds) + " ns";
+    }
+    if (nanoseconds < 1000000)
+    {
+        return QString::number(nanoseconds / 1e3, 'f', 1) + " us";
+    }
+    if (nanoseconds < 1000000000)
+    {
+        return QString::number(nanoseconds / 1e6, 'f', 1) + " ms";
+    }
+
+    return QString::number(nanoseconds / 1e9, 'f', 2) + " s";
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::setSample(const uint64_t& sequence)
+{
+    if (sequence == 0 || sequence == m_selectedSequence)
     {
         return;
     }
 
-    m_selectedSample = sampleName;
-    auto sample = CommonData::copySample(m_topicName, index);
+    m_selectedSequence = sequence;
+    auto sample = m_history->getSampleBySequence(sequence);
     if (sample != nullptr)
     {
         m_tableModel->setSample(sample);
@@ -628,6 +1069,20 @@ void TablePage::setSample(const QString& sampleName)
 }
 
 
+//------------------------------------------------------------------------------
+void TablePage::setSample(const std::shared_ptr<const SampleRecord>& record)
+{
+    if (!record || !record->sample || record->info.sequence == m_selectedSequence)
+    {
+        return;
+    }
+
+    m_selectedSequence = record->info.sequence;
+    m_tableModel->setSample(record->sample);
+    revertButton->setEnabled(false);
+}
+
+
 /**
  * @}
  */
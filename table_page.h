@@ -4,13 +4,18 @@
 #include "first_define.h"
 #include "ui_table_page.h"
 
-#include <QTableWidgetItem>
 #include <QStringList>
 #include <QString>
 #include <QTimer>
 
+#include <cstdint>
 #include <memory>
 
+class HistoryListModel;
+class InstanceListModel;
+class InstanceStore;
+struct SampleRecord;
+class TopicHistory;
 class TopicTableModel;
 class TopicReplayer;
 class TopicMonitor;
@@ -68,6 +73,44 @@ private slots:
      */
     void on_iniButton_clicked();
 
+    /**
+     * @brief Set the number of samples and time window kept for this topic.
+     */
+    void on_historyDepthButton_clicked();
+
+    /**
+     * @brief Turn the running statistics of this topic on or off.
+     * @param[in] checked True to collect and show the statistics.
+     */
+    void on_statsButton_toggled(bool checked);
+
+    /**
+     * @brief Restart the running statistics of this topic.
+     */
+    void on_resetStatsButton_clicked();
+
+    /**
+     * @brief Turn keyed instance tracking of this topic on or off.
+     * @param[in] checked True to key the instances by the selected members.
+     */
+    void on_keyButton_toggled(bool checked);
+
+    /**
+     * @brief Show the page of samples before the oldest one shown.
+     */
+    void on_olderButton_clicked();
+
+    /**
+     * @brief Show the page of samples after the newest one shown.
+     */
+    void on_newerButton_clicked();
+
+    /**
+     * @brief Only list the samples of the selected writer.
+     * @param[in] index The selected combo box row. 0 is all writers.
+     */
+    void on_writerComboBox_currentIndexChanged(int index);
+
     /**
      * @brief Revert any edit operations to the original sample.
      */
@@ -80,8 +123,15 @@ private slots:
 
     /**
      * @brief Switch which data sample is view on this page.
+     * @param[in] current The selected history row.
+     */
+    void historyRowChanged(const QModelIndex& current);
+
+    /**
+     * @brief Show the newest sample of the selected instance.
+     * @param[in] current The selected instance row.
      */
-    void on_historyTable_itemSelectionChanged();
+    void instanceRowChanged(const QModelIndex& current);
 
     /**
      * @brief Create a new plot from the selected variables.
@@ -93,6 +143,11 @@ private slots:
      */
     void on_attachPlotButton_clicked();
 
+    /**
+     * @brief Show the array of the selected element as a waterfall.
+     */
+    void on_waterfallButton_clicked();
+
     /**
      * @brief Start recording the selected variables to a file.
      */
@@ -111,20 +166,52 @@ private slots:
 
     /**
      * @brief Update the history table with the latest data from DDS.
-     * @remarks This is called from the m_refreshTimer timer.
      */
     void refreshPage();
 
+    /**
+     * @brief Refresh the page when the samples of this topic changed.
+     * @param[in] topicName The name of the changed topic.
+     */
+    void topicChanged(const QString& topicName);
+
+    /**
+     * @brief Update the health panel with the receive timing of this topic.
+     */
+    void refreshHealth();
+
+    /**
+     * @brief Update the writer selector with the writers of this topic.
+     */
+    void refreshWriters();
+
 private:
 
     /**
      * @brief Set the data sample used by this page.
-     * @param[in] The name of the data sample (timestamp).
+     * @param[in] sequence The sequence number of the data sample.
+     */
+    void setSample(const uint64_t& sequence);
+
+    /**
+     * @brief Set the data sample used by this page from a stored record.
+     * @remarks Used for instance samples, which may have left the history.
+     * @param[in] record The stored sample.
+     */
+    void setSample(const std::shared_ptr<const SampleRecord>& record);
+
+    /**
+     * @brief Show the instances of an instance store in the Keys tab.
+     * @param[in] instances The instance store or nullptr to show none.
      */
-    void setSample(const QString& sampleName);
+    void showInstances(const std::shared_ptr<InstanceStore>& instances);
 
-    /// The number of MS to wait until updating the history widget.
-    static const int REFRESH_TIMEOUT = 250;
+    /**
+     * @brief Format a duration for the health panel.
+     * @param[in] nanoseconds The duration or -1 if there is none.
+     * @return The duration in the largest fitting unit.
+     */
+    static QString formatDuration(const int64_t nanoseconds);
 
     /// Data model for the topic used on this page.
     std::unique_ptr<TopicTableModel> m_tableModel;
@@ -138,14 +225,29 @@ private:
     /// The name of the topic used on this page.
     QString m_topicName;
 
-    /// The name of the selected sample.
-    QString m_selectedSample;
+    /// The sample history of the topic used on this page.
+    std::shared_ptr<TopicHistory> m_history;
+
+    /// List model for the sample history pane.
+    std::unique_ptr<HistoryListModel> m_historyModel;
+
+    /// List model for the keyed instances pane.
+    std::unique_ptr<InstanceListModel> m_instanceModel;
+
+    /// The sequence number of the selected sample.
+    uint64_t m_selectedSequence;
+
+    /// Updates the health panel, which also has to show a stalled topic.
+    QTimer m_healthTimer;
+
+    /// The number of samples shown on a history page.
+    static const int HISTORY_PAGE_SIZE = 500;
 
-    /// Refresh timer for all tables.
-    QTimer m_refreshTimer;
+    /// The health panel update interval in ms.
+    static const int HEALTH_INTERVAL = 1000;
 
-    /// Stores the history sample names.
-    QStringList m_historyList;
+    /// A writer is silent after this many of its usual intervals.
+    static const int SILENT_INTERVALS = 3;
 
 }; // End TablePage
 
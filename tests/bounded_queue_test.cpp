@@ -0,0 +1,140 @@
+#include "bounded_queue.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The capacity is rounded up and a full queue refuses items.
+ */
+static void testCapacity()
+{
+    BoundedQueue<int> queue(5);
+    CHECK(queue.capacity() == 8);
+
+    for (int i = 0; i < 8; i++)
+    {
+        int item = i;
+        CHECK(queue.push(item));
+    }
+
+    int extra = 8;
+    CHECK(!queue.push(extra));
+    CHECK(queue.size() == 8);
+
+    // Items come out in order and the queue wraps around
+    for (int lap = 0; lap < 3; lap++)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            int item = -1;
+            CHECK(queue.pop(item) && item == lap * 8 + i);
+            int next = (lap + 1) * 8 + i;
+            CHECK(queue.push(next));
+        }
+    }
+
+    int item = 0;
+    while (queue.pop(item)) {}
+    CHECK(queue.size() == 0);
+    CHECK(!queue.pop(item));
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief A refused item is left alone, so the caller can still use it.
+ */
+static void testRefusedItem()
+{
+    BoundedQueue<std::unique_ptr<int>> queue(2);
+    for (int i = 0; i < 2; i++)
+    {
+        std::unique_ptr<int> item(new int(i));
+        CHECK(queue.push(item) && !item);
+    }
+
+    std::unique_ptr<int> refused(new int(2));
+    CHECK(!queue.push(refused) && refused && *refused == 2);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Every item pushed by several producers is popped exactly once.
+ */
+static void testConcurrent()
+{
+    const int producers = 4;
+    const int perProducer = 100000;
+    BoundedQueue<int> queue(1024);
+    std::vector<std::atomic<int>> seen(producers * perProducer);
+    std::atomic<int> popped(0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&queue, p]()
+        {
+            for (int i = 0; i < perProducer; i++)
+            {
+                int item = p * perProducer + i;
+                while (!queue.push(item))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int c = 0; c < 2; c++)
+    {
+        threads.emplace_back([&queue, &seen, &popped]()
+        {
+            int item = 0;
+            while (popped < producers * perProducer)
+            {
+                if (queue.pop(item))
+                {
+                    seen[item]++;
+                    popped++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    int missing = 0;
+    for (const std::atomic<int>& count : seen)
+    {
+        missing += (count != 1) ? 1 : 0;
+    }
+    CHECK(missing == 0);
+}
+
+
+//------------------------------------------------------------------------------
+int main()
+{
+    testCapacity();
+    testRefusedItem();
+    testConcurrent();
+    return testResult();
+}
+
+
+/**
+ * @}
+ */
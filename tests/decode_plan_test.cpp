@@ -0,0 +1,391 @@
+#include "decode_plan.h"
+#include "open_dynamic_data.h"
+#include "test_check.h"
+
+#include <tao/AnyTypeCode/Null_RefCount_Policy.h>
+#include <tao/AnyTypeCode/Sequence_TypeCode_Static.h>
+#include <tao/AnyTypeCode/Struct_TypeCode_Static.h>
+#include <tao/AnyTypeCode/TypeCode_Constants.h>
+#include <tao/AnyTypeCode/TypeCode_Struct_Field.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//------------------------------------------------------------------------------
+// Type codes laid out the way tao_idl generates them
+//------------------------------------------------------------------------------
+typedef TAO::TypeCode::Struct_Field<const char*, CORBA::TypeCode_ptr const*> Field;
+typedef TAO::TypeCode::Struct<const char*,
+                              CORBA::TypeCode_ptr const*,
+                              const Field*,
+                              TAO::Null_RefCount_Policy> StructTypeCode;
+typedef TAO::TypeCode::Sequence<CORBA::TypeCode_ptr const*,
+                                TAO::Null_RefCount_Policy> SequenceTypeCode;
+
+// sequence<short>
+static SequenceTypeCode shortSeqTypeCode(CORBA::tk_sequence, &CORBA::_tc_short, 0);
+static CORBA::TypeCode_ptr const shortSeqTc = &shortSeqTypeCode;
+
+// struct Reading { octet flag; double value; long count; string name; sequence<short> history; };
+static const Field readingFields[] =
+{
+    { "flag", &CORBA::_tc_octet },
+    { "value", &CORBA::_tc_double },
+    { "count", &CORBA::_tc_long },
+    { "name", &CORBA::_tc_string },
+    { "history", &shortSeqTc }
+};
+static StructTypeCode readingTypeCode(CORBA::tk_struct, "IDL:Reading:1.0", "Reading", readingFields, 5);
+
+// struct Point { long x; short y; };
+static const Field pointFields[] =
+{
+    { "x", &CORBA::_tc_long },
+    { "y", &CORBA::_tc_short }
+};
+static StructTypeCode pointTypeCode(CORBA::tk_struct, "IDL:Point:1.0", "Point", pointFields, 2);
+static CORBA::TypeCode_ptr const pointTc = &pointTypeCode;
+
+// sequence<Point>
+static SequenceTypeCode pointSeqTypeCode(CORBA::tk_sequence, &pointTc, 0);
+static CORBA::TypeCode_ptr const pointSeqTc = &pointSeqTypeCode;
+
+// struct Path { Point origin; sequence<Point> points; };
+static const Field pathFields[] =
+{
+    { "origin", &pointTc },
+    { "points", &pointSeqTc }
+};
+static StructTypeCode pathTypeCode(CORBA::tk_struct, "IDL:Path:1.0", "Path", pathFields, 2);
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Builds a little endian payload byte by byte.
+ * @details The padding is spelled out by the tests, so a wrong alignment rule
+ *          in the decode plan shows up as a wrong value.
+ */
+class Payload
+{
+public:
+
+    /**
+     * @brief Append an unsigned value of the given size.
+     * @param[in] value The value.
+     * @param[in] size The size in bytes.
+     */
+    void put(const uint64_t value, const size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            m_bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    /**
+     * @brief Append a double.
+     * @param[in] value The value.
+     */
+    void putDouble(const double value)
+    {
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        put(bits, sizeof(bits));
+    }
+
+    /**
+     * @brief Append a string with its length and terminator.
+     * @param[in] value The string.
+     */
+    void putString(const std::string& value)
+    {
+        put(value.size() + 1, 4);
+        m_bytes.insert(m_bytes.end(), value.begin(), value.end());
+        m_bytes.push_back('\0');
+    }
+
+    /**
+     * @brief Append padding bytes.
+     * @param[in] count The number of bytes.
+     */
+    void pad(const size_t count)
+    {
+        m_bytes.insert(m_bytes.end(), count, '\0');
+    }
+
+    /**
+     * @brief Get the payload size so far.
+     * @return The size in bytes.
+     */
+    size_t size() const
+    {
+        return m_bytes.size();
+    }
+
+    /**
+     * @brief Decode the payload into a new sample.
+     * @param[in] typeCode The type of the sample.
+     * @param[in] kind The encoding kind.
+     * @param[in] extensibility The extensibility of the type.
+     * @param[out] sample The decoded sample.
+     * @return The result of DecodePlan::execute.
+     */
+    bool decode(const CORBA::TypeCode* typeCode,
+                const OpenDDS::DCPS::Encoding::Kind kind,
+                const OpenDDS::DCPS::Extensibility extensibility,
+                std::shared_ptr<OpenDynamicData>& sample)
+    {
+        const DecodePlan plan(typeCode, kind, extensibility);
+        sample = CreateOpenDynamicData(typeCode, kind, extensibility);
+
+        ACE_Message_Block block(m_bytes.data(), m_bytes.size());
+        block.wr_ptr(m_bytes.size());
+        OpenDDS::DCPS::Serializer stream(&block, kind, OpenDDS::DCPS::ENDIAN_LITTLE);
+        return plan.isValid() && plan.execute(stream, *sample);
+    }
+
+private:
+
+    /// The payload bytes.
+    std::vector<char> m_bytes;
+};
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Check the members of a decoded Reading sample.
+ * @param[in] sample The decoded sample.
+ */
+static void checkReading(const std::shared_ptr<OpenDynamicData>& sample)
+{
+    CHECK(sample->getMember("flag")->getValue<CORBA::Octet>() == 7);
+    CHECK(sample->getMember("value")->getValue<CORBA::Double>() == 2.5);
+    CHECK(sample->getMember("count")->getValue<CORBA::Long>() == -42);
+    CHECK(std::string(sample->getMember("name")->getStringValue()) == "hello");
+
+    const std::shared_ptr<OpenDynamicData> history = sample->getMember("history");
+    CHECK(history && history->getLength() == 3);
+    CHECK(sample->getMember("history[0]")->getValue<CORBA::Short>() == 1);
+    CHECK(sample->getMember("history[1]")->getValue<CORBA::Short>() == -2);
+    CHECK(sample->getMember("history[2]")->getValue<CORBA::Short>() == 3);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Append the short sequence of a Reading.
+ * @param[out] payload The payload to append to.
+ */
+static void putHistory(Payload& payload)
+{
+    payload.put(3, 4);
+    payload.put(1, 2);
+    payload.put(static_cast<uint16_t>(-2), 2);
+    payload.put(3, 2);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief XCDR1 aligns doubles to 8 bytes.
+ */
+static void testXcdr1()
+{
+    Payload payload;
+    payload.put(7, 1);               // flag at 0
+    payload.pad(7);
+    payload.putDouble(2.5);          // value at 8
+    payload.put(static_cast<uint32_t>(-42), 4); // count at 16
+    payload.putString("hello");      // name at 20, ends at 30
+    payload.pad(2);
+    putHistory(payload);             // history at 32
+
+    std::shared_ptr<OpenDynamicData> sample;
+    CHECK(payload.decode(&readingTypeCode,
+                         OpenDDS::DCPS::Encoding::KIND_XCDR1,
+                         OpenDDS::DCPS::Extensibility::FINAL,
+                         sample));
+    checkReading(sample);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief XCDR2 aligns doubles to 4 bytes and final types have no delimiter.
+ */
+static void testXcdr2Final()
+{
+    Payload payload;
+    payload.put(7, 1);               // flag at 0
+    payload.pad(3);
+    payload.putDouble(2.5);          // value at 4
+    payload.put(static_cast<uint32_t>(-42), 4); // count at 12
+    payload.putString("hello");      // name at 16, ends at 26
+    payload.pad(2);
+    putHistory(payload);             // history at 28
+
+    std::shared_ptr<OpenDynamicData> sample;
+    CHECK(payload.decode(&readingTypeCode,
+                         OpenDDS::DCPS::Encoding::KIND_XCDR2,
+                         OpenDDS::DCPS::Extensibility::FINAL,
+                         sample));
+    checkReading(sample);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief XCDR2 appendable types start with a delimiter header.
+ */
+static void testXcdr2Appendable()
+{
+    Payload payload;
+    payload.put(36, 4);              // delimiter header
+    payload.put(7, 1);               // flag at 4
+    payload.pad(3);
+    payload.putDouble(2.5);          // value at 8
+    payload.put(static_cast<uint32_t>(-42), 4); // count at 16
+    payload.putString("hello");      // name at 20, ends at 30
+    payload.pad(2);
+    putHistory(payload);             // history at 32
+
+    std::shared_ptr<OpenDynamicData> sample;
+    CHECK(payload.decode(&readingTypeCode,
+                         OpenDDS::DCPS::Encoding::KIND_XCDR2,
+                         OpenDDS::DCPS::Extensibility::APPENDABLE,
+                         sample));
+    checkReading(sample);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief XCDR2 nested structs and sequences of structs carry delimiter headers.
+ */
+static void testXcdr2Nested()
+{
+    Payload payload;
+    payload.put(6, 4);               // origin delimiter header
+    payload.put(10, 4);              // origin.x at 4
+    payload.put(20, 2);              // origin.y at 8
+    payload.pad(2);
+    payload.put(24, 4);              // points delimiter header at 12
+    payload.put(2, 4);               // points length at 16
+    payload.put(6, 4);               // points[0] delimiter header at 20
+    payload.put(1, 4);               // points[0].x at 24
+    payload.put(2, 2);               // points[0].y at 28
+    payload.pad(2);
+    payload.put(6, 4);               // points[1] delimiter header at 32
+    payload.put(3, 4);               // points[1].x at 36
+    payload.put(4, 2);               // points[1].y at 40
+
+    std::shared_ptr<OpenDynamicData> sample;
+    CHECK(payload.decode(&pathTypeCode,
+                         OpenDDS::DCPS::Encoding::KIND_XCDR2,
+                         OpenDDS::DCPS::Extensibility::FINAL,
+                         sample));
+
+    CHECK(sample->getMember("origin.x")->getValue<CORBA::Long>() == 10);
+    CHECK(sample->getMember("origin.y")->getValue<CORBA::Short>() == 20);
+    CHECK(sample->getMember("points")->getLength() == 2);
+    CHECK(sample->getMember("points[0].x")->getValue<CORBA::Long>() == 1);
+    CHECK(sample->getMember("points[0].y")->getValue<CORBA::Short>() == 2);
+    CHECK(sample->getMember("points[1].x")->getValue<CORBA::Long>() == 3);
+    CHECK(sample->getMember("points[1].y")->getValue<CORBA::Short>() == 4);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief A sequence or string length beyond the payload is rejected before
+ *        allocating.
+ */
+static void testSequenceBound()
+{
+    Payload payload;
+    payload.put(7, 1);
+    payload.pad(3);
+    payload.putDouble(2.5);
+    payload.put(1, 4);
+    payload.putString("x");
+    payload.pad(2);
+    payload.put(0x40000000, 4);      // 1 Gi shorts
+    payload.put(1, 2);
+
+    std::shared_ptr<OpenDynamicData> sample;
+    CHECK(!payload.decode(&readingTypeCode,
+                          OpenDDS::DCPS::Encoding::KIND_XCDR2,
+                          OpenDDS::DCPS::Extensibility::FINAL,
+                          sample));
+    CHECK(sample->getMember("history")->getLength() == 0);
+
+    // Each point takes at least 10 bytes, so 4 of them can't fit in 20
+    Payload points;
+    points.put(6, 4);
+    points.put(0, 4);
+    points.put(0, 2);
+    points.pad(2);
+    points.put(24, 4);
+    points.put(4, 4);
+    points.pad(20);
+
+    CHECK(!points.decode(&pathTypeCode,
+                         OpenDDS::DCPS::Encoding::KIND_XCDR2,
+                         OpenDDS::DCPS::Extensibility::FINAL,
+                         sample));
+
+    // A string claiming 4 GiB fails before the arena string is resized
+    Payload name;
+    name.put(7, 1);
+    name.pad(3);
+    name.putDouble(2.5);
+    name.put(1, 4);
+    name.put(0xFFFFFFFF, 4);
+    name.pad(8);
+
+    CHECK(!name.decode(&readingTypeCode,
+                       OpenDDS::DCPS::Encoding::KIND_XCDR2,
+                       OpenDDS::DCPS::Extensibility::FINAL,
+                       sample));
+    CHECK(sample->getMember("name")->getStringValue()[0] == '\0');
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief A payload cut short fails instead of reading past the end.
+ */
+static void testTruncated()
+{
+    Payload payload;
+    payload.put(7, 1);
+    payload.pad(3);
+    payload.put(0, 4);               // only half of the double
+
+    std::shared_ptr<OpenDynamicData> sample;
+    CHECK(!payload.decode(&readingTypeCode,
+                          OpenDDS::DCPS::Encoding::KIND_XCDR2,
+                          OpenDDS::DCPS::Extensibility::FINAL,
+                          sample));
+}
+
+
+//------------------------------------------------------------------------------
+int main()
+{
+    testXcdr1();
+    testXcdr2Final();
+    testXcdr2Appendable();
+    testXcdr2Nested();
+    testSequenceBound();
+    testTruncated();
+    return testResult();
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,248 @@
+#include "plot_series.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Get the y value of the test signal.
+ * @param[in] x The x value.
+ * @return A sine wave with a single spike at x = 2503.
+ */
+static double signal(const int x)
+{
+    return x == 2503 ? 100.0 : std::sin(x * 0.01);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Check that the served points stay inside the window and in order.
+ * @param[in] series The series.
+ * @param[in] xMin The lowest x value shown.
+ * @param[in] xMax The highest x value shown.
+ */
+static void checkServed(const PlotSeries& series, const double xMin, const double xMax)
+{
+    for (size_t i = 0; i < series.size(); i++)
+    {
+        CHECK(series.sample(i).x() >= xMin && series.sample(i).x() <= xMax);
+        CHECK(i == 0 || series.sample(i).x() >= series.sample(i - 1).x());
+    }
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief A window with few points per column is served raw.
+ */
+static void testRaw()
+{
+    PlotSeries series(1000);
+    series.setResolution(100);
+    for (int x = 0; x < 300; x++)
+    {
+        series.append(x, signal(x));
+    }
+    series.setWindow(100, 199);
+
+    CHECK(!series.isDecimated());
+    CHECK(series.size() == 100);
+    CHECK(series.sample(0).x() == 100);
+    CHECK(series.sample(99).x() == 199);
+    CHECK(series.sample(42).y() == signal(142));
+    checkServed(series, 100, 199);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief A dense window is cut to 4 points per column, extremes included.
+ */
+static void testDecimated()
+{
+    const int columns = 100;
+    PlotSeries series(20000);
+    series.setResolution(columns);
+    for (int x = 0; x < 5000; x++)
+    {
+        series.append(x, signal(x));
+    }
+    series.setWindow(0, 4999);
+
+    CHECK(series.isDecimated());
+    CHECK(series.size() <= 4 * static_cast<size_t>(columns + 1));
+    checkServed(series, 0, 4999);
+
+    double low = series.sample(0).y();
+    double high = low;
+    for (size_t i = 0; i < series.size(); i++)
+    {
+        low = std::min(low, series.sample(i).y());
+        high = std::max(high, series.sample(i).y());
+    }
+    CHECK(high == 100.0);
+    CHECK(low <= -0.99);
+
+    // The first and last points are the raw ones
+    CHECK(series.sample(0).x() == 0 && series.sample(0).y() == signal(0));
+    CHECK(series.sample(series.size() - 1).x() == 4999);
+    CHECK(series.sample(series.size() - 1).y() == signal(4999));
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Following live data gives the same points as binning from scratch,
+ *        and the columns left of the newest one are reported unchanged.
+ */
+static void testIncremental()
+{
+    const int columns = 100;
+    PlotSeries live(20000);
+    live.setResolution(columns);
+
+    int x = 0;
+    for (int tick = 0; tick < 10; tick++)
+    {
+        const size_t before = live.size();
+        for (int i = 0; i < 600; i++, x++)
+        {
+            live.append(x, signal(x));
+        }
+        live.setWindow(0, 5999);
+
+        if (tick > 1)
+        {
+            CHECK(live.isDecimated());
+            CHECK(live.stableCount() > 0 && live.stableCount() <= before);
+        }
+    }
+
+    PlotSeries fresh(20000);
+    fresh.setResolution(columns);
+    for (int i = 0; i < x; i++)
+    {
+        fresh.append(i, signal(i));
+    }
+    fresh.setWindow(0, 5999);
+
+    CHECK(live.size() == fresh.size());
+    for (size_t i = 0; i < std::min(live.size(), fresh.size()); i++)
+    {
+        CHECK(live.sample(i) == fresh.sample(i));
+    }
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The bounds cover the served points with the bias applied.
+ */
+static void testBounds()
+{
+    PlotSeries series(1000);
+    series.setResolution(100);
+    for (int x = 0; x < 10; x++)
+    {
+        series.append(x, x);
+    }
+    series.setWindow(2, 5);
+    series.setBias(2.0, 1.0);
+
+    const QRectF bounds = series.boundingRect();
+    CHECK(bounds.x() == 2 && bounds.width() == 3);
+    CHECK(bounds.y() == 5 && bounds.height() == 6);
+
+    series.clear();
+    CHECK(series.size() == 0);
+    CHECK(series.boundingRect().width() < 0);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The summary levels reach back much further than the raw points, in
+ *        the same fixed memory.
+ */
+static void testPyramidReach()
+{
+    PlotSeries series(1000);
+    for (int x = 0; x < 100000; x++)
+    {
+        series.append(x, x);
+    }
+
+    CHECK(series.count() == 1000);
+    CHECK(series.latest().x() == 99999);
+
+    // The coarsest summaries span 65536 points, so none were dropped yet
+    CHECK(series.oldest().x() == 0);
+
+    // Raw points give their own value, summaries their mean
+    CHECK(series.valueAt(99500) == 99500);
+    for (const int x : { 0, 1000, 50000, 98000 })
+    {
+        CHECK(std::fabs(series.valueAt(x) - x) < 65536);
+    }
+    CHECK(std::fabs(series.valueAt(98000) - 98000) < 256);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief A window beyond the raw points is served from the summaries, with
+ *        the extremes of every summary.
+ */
+static void testPyramidWindow()
+{
+    const int columns = 100;
+    PlotSeries series(1000);
+    series.setResolution(columns);
+    for (int x = 0; x < 100000; x++)
+    {
+        series.append(x, x % 7 == 3 ? 10.0 : 0.0);
+    }
+    series.setWindow(10000, 60000);
+
+    CHECK(series.isDecimated());
+    CHECK(series.size() > 0);
+    CHECK(series.size() <= 4 * static_cast<size_t>(columns + 2));
+    checkServed(series, 10000, 60000);
+
+    double low = series.sample(0).y();
+    double high = low;
+    for (size_t i = 0; i < series.size(); i++)
+    {
+        low = std::min(low, series.sample(i).y());
+        high = std::max(high, series.sample(i).y());
+    }
+    CHECK(low == 0.0);
+    CHECK(high == 10.0);
+
+    // Zooming back in to the raw points serves them as they are
+    series.setWindow(99900, 99999);
+    CHECK(!series.isDecimated());
+    CHECK(series.size() == 100);
+    CHECK(series.sample(3).y() == (99903 % 7 == 3 ? 10.0 : 0.0));
+}
+
+
+//------------------------------------------------------------------------------
+int main()
+{
+    testRaw();
+    testDecimated();
+    testIncremental();
+    testBounds();
+    testPyramidReach();
+    testPyramidWindow();
+    return testResult();
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,119 @@
+#include "spsc_ring.h"
+#include "test_check.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The capacity is rounded up and a full ring drops new items.
+ */
+static void testCapacity()
+{
+    SpscRing<int> ring(3);
+    for (int i = 0; i < 4; i++)
+    {
+        int* slot = ring.claim();
+        CHECK(slot != nullptr);
+        *slot = i;
+        ring.publish();
+    }
+
+    CHECK(ring.claim() == nullptr);
+    CHECK(ring.droppedCount() == 1);
+
+    // The oldest items are kept
+    std::vector<int> items;
+    CHECK(ring.drain(items) == 4);
+    CHECK(items == std::vector<int>({ 0, 1, 2, 3 }));
+    CHECK(ring.front() == nullptr);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief A claimed slot isn't visible until it's published, and released
+ *        slots keep their contents for reuse.
+ */
+static void testReuse()
+{
+    SpscRing<std::vector<float>> ring(1);
+    std::vector<float>* slot = ring.claim();
+    CHECK(slot != nullptr);
+    slot->assign(100, 1.0f);
+    CHECK(ring.front() == nullptr);
+
+    ring.publish();
+    std::vector<float>* buffered = ring.front();
+    CHECK(buffered != nullptr && buffered->size() == 100);
+    buffered->clear();
+    ring.release();
+
+    slot = ring.claim();
+    CHECK(slot != nullptr && slot->capacity() >= 100);
+}
+
+
+//------------------------------------------------------------------------------
+/**
+ * @brief Items pass from one thread to another in order.
+ */
+static void testConcurrent()
+{
+    const uint64_t total = 1000000;
+    SpscRing<uint64_t> ring(1024);
+
+    std::thread producer([&ring, total]()
+    {
+        for (uint64_t i = 0; i < total; )
+        {
+            uint64_t* slot = ring.claim();
+            if (slot)
+            {
+                *slot = i++;
+                ring.publish();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected = 0;
+    bool ordered = true;
+    std::vector<uint64_t> items;
+    while (expected < total)
+    {
+        items.clear();
+        if (ring.drain(items) == 0)
+        {
+            std::this_thread::yield();
+        }
+        for (const uint64_t item : items)
+        {
+            ordered = ordered && item == expected;
+            expected++;
+        }
+    }
+
+    producer.join();
+    CHECK(ordered);
+}
+
+
+//------------------------------------------------------------------------------
+int main()
+{
+    testCapacity();
+    testReuse();
+    testConcurrent();
+    return testResult();
+}
+
+
+/**
+ * @}
+ */
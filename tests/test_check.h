@@ -0,0 +1,46 @@
+#ifndef __TEST_CHECK_H__
+#define __TEST_CHECK_H__
+
+#include <iostream>
+
+
+/// The number of failed checks in this test program.
+static int testFailures = 0;
+
+
+/**
+ * @brief Report a failed check without stopping the test program.
+ * @param[in] condition The condition that has to hold.
+ */
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::cerr << __FILE__ << ":" << __LINE__ \
+                      << ": Check failed: " << #condition << std::endl; \
+            ++testFailures; \
+        } \
+    } while (false)
+
+
+/**
+ * @brief Get the exit code of the test program.
+ * @return 0 if every check passed; 1 otherwise.
+ */
+inline int testResult()
+{
+    if (testFailures > 0)
+    {
+        std::cerr << testFailures << " check(s) failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,202 @@
+#include "topic_health.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+//------------------------------------------------------------------------------
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+
+//------------------------------------------------------------------------------
+void LatencyHistogram::record(const int64_t value)
+{
+    const uint64_t duration = value > 0 ? static_cast<uint64_t>(value) : 0;
+    m_counts[bucketIndex(duration)].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+//------------------------------------------------------------------------------
+void LatencyHistogram::reset()
+{
+    for (std::atomic<uint64_t>& count : m_counts)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void LatencyHistogram::getSnapshot(Snapshot& snapshot) const
+{
+    snapshot.resize(BUCKET_COUNT);
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        snapshot[i] = m_counts[i].load(std::memory_order_relaxed);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t LatencyHistogram::total(const Snapshot& snapshot)
+{
+    uint64_t sum = 0;
+    for (const uint64_t count : snapshot)
+    {
+        sum += count;
+    }
+    return sum;
+}
+
+
+//------------------------------------------------------------------------------
+int64_t LatencyHistogram::percentile(const Snapshot& snapshot, const double percentile)
+{
+    const uint64_t count = total(snapshot);
+    if (count == 0)
+    {
+        return -1;
+    }
+
+    // The rank of the wanted value, counting from 1
+    const double fraction = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+    const uint64_t rank = std::max<uint64_t>(
+        static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count))), 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < snapshot.size(); i++)
+    {
+        seen += snapshot[i];
+        if (seen >= rank)
+        {
+            return bucketValue(static_cast<int>(i));
+        }
+    }
+
+    return bucketValue(BUCKET_COUNT - 1);
+
+} // End LatencyHistogram::percentile
+
+
+//------------------------------------------------------------------------------
+int LatencyHistogram::bucketIndex(const uint64_t value)
+{
+    if (value < static_cast<uint64_t>(SUB_BUCKETS))
+    {
+        return static_cast<int>(value);
+    }
+
+    // Find the leading bit
+    int leadingBit = 0;
+    for (uint64_t rest = value >> 1; rest != 0; rest >>= 1)
+    {
+        leadingBit++;
+    }
+
+    if (leadingBit > MAX_BIT)
+    {
+        return BUCKET_COUNT - 1;
+    }
+
+    // Keep the bits just below the leading one
+    const int shift = leadingBit - SUB_BUCKET_BITS + 1;
+    const int subBucket = static_cast<int>(value >> shift);
+    return SUB_BUCKETS + (shift - 1) * (SUB_BUCKETS / 2) + (subBucket - SUB_BUCKETS / 2);
+}
+
+
+//------------------------------------------------------------------------------
+int64_t LatencyHistogram::bucketValue(const int index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    const int linear = index - SUB_BUCKETS;
+    const int shift = linear / (SUB_BUCKETS / 2) + 1;
+    const int64_t subBucket = linear % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+    return (subBucket << shift) + ((int64_t(1) << shift) / 2);
+}
+
+
+//------------------------------------------------------------------------------
+TopicHealth::TopicHealth()
+{
+    reset();
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHealth::record(const int64_t& sourceTime, const int64_t& receiveTime)
+{
+    const int64_t lastReceive = m_lastReceive.exchange(receiveTime, std::memory_order_relaxed);
+    if (lastReceive > 0)
+    {
+        m_interval.record(receiveTime - lastReceive);
+    }
+
+    if (sourceTime > 0)
+    {
+        m_latency.record(receiveTime - sourceTime);
+    }
+
+    // The first sample of a new second claims the slot of an old one. A
+    // sample counted while another thread restarts the slot may be lost,
+    // which doesn't matter for a rate.
+    const int64_t second = receiveTime / 1000000000;
+    const size_t slot = static_cast<size_t>(second % (RATE_WINDOW + 1));
+    int64_t slotSecond = m_rateSeconds[slot].load(std::memory_order_relaxed);
+    if (slotSecond != second &&
+        m_rateSeconds[slot].compare_exchange_strong(slotSecond, second, std::memory_order_relaxed))
+    {
+        m_rateCounts[slot].store(0, std::memory_order_relaxed);
+    }
+    m_rateCounts[slot].fetch_add(1, std::memory_order_relaxed);
+
+} // End TopicHealth::record
+
+
+//------------------------------------------------------------------------------
+void TopicHealth::reset()
+{
+    m_interval.reset();
+    m_latency.reset();
+    m_lastReceive.store(0, std::memory_order_relaxed);
+    for (int i = 0; i <= RATE_WINDOW; i++)
+    {
+        m_rateSeconds[i].store(-1, std::memory_order_relaxed);
+        m_rateCounts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHealth::getSnapshot(const int64_t& now, Snapshot& snapshot) const
+{
+    m_interval.getSnapshot(snapshot.interval);
+    m_latency.getSnapshot(snapshot.latency);
+
+    // Only count the complete seconds before the current one
+    const int64_t second = now / 1000000000;
+    uint64_t received = 0;
+    for (int i = 0; i <= RATE_WINDOW; i++)
+    {
+        const int64_t slotSecond = m_rateSeconds[i].load(std::memory_order_relaxed);
+        if (slotSecond >= second - RATE_WINDOW && slotSecond < second)
+        {
+            received += m_rateCounts[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    snapshot.rate = static_cast<double>(received) / RATE_WINDOW;
+
+} // End TopicHealth::getSnapshot
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,183 @@
+#ifndef __TOPIC_HEALTH_H__
+#define __TOPIC_HEALTH_H__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * @brief Log-linear histogram of nanosecond durations.
+ *
+ * @details Values below SUB_BUCKETS get a bucket each. Above that, every
+ *          power of two is split into SUB_BUCKETS / 2 linear buckets, so a
+ *          recorded value is off by less than 2 / SUB_BUCKETS of itself
+ *          (about 3%) at any scale, like an HDR histogram. Values from 0 up
+ *          to about half an hour are covered; larger values go in the last
+ *          bucket.
+ *
+ *          Recording is a single relaxed atomic increment, so any number of
+ *          threads can record without locking. A snapshot copies the counts
+ *          and is used to compute the percentiles.
+ */
+class LatencyHistogram
+{
+public:
+
+    /// A copy of the bucket counts.
+    typedef std::vector<uint64_t> Snapshot;
+
+    /**
+     * @brief Constructor for the histogram.
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief Count a duration.
+     * @remarks Lock free. Negative durations are counted as 0.
+     * @param[in] value The duration in nanoseconds.
+     */
+    void record(const int64_t value);
+
+    /**
+     * @brief Forget all counted durations.
+     */
+    void reset();
+
+    /**
+     * @brief Copy the bucket counts.
+     * @param[out] snapshot Replaced with the current bucket counts.
+     */
+    void getSnapshot(Snapshot& snapshot) const;
+
+    /**
+     * @brief Get the total count of a snapshot.
+     * @param[in] snapshot The bucket counts.
+     * @return The number of counted durations.
+     */
+    static uint64_t total(const Snapshot& snapshot);
+
+    /**
+     * @brief Get a percentile of a snapshot.
+     * @param[in] snapshot The bucket counts.
+     * @param[in] percentile The percentile from 0 to 100.
+     * @return The duration in nanoseconds or -1 if the snapshot is empty.
+     */
+    static int64_t percentile(const Snapshot& snapshot, const double percentile);
+
+    /// The number of bits resolved below the leading bit.
+    static const int SUB_BUCKET_BITS = 6;
+
+    /// The number of exactly counted small values.
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    /// The highest leading bit of a counted value.
+    static const int MAX_BIT = 40;
+
+    /// The total number of buckets.
+    static const int BUCKET_COUNT =
+        SUB_BUCKETS + (MAX_BIT - SUB_BUCKET_BITS + 1) * (SUB_BUCKETS / 2);
+
+private:
+
+    /**
+     * @brief Find the bucket for a duration.
+     * @param[in] value The duration in nanoseconds, not negative.
+     * @return The bucket index.
+     */
+    static int bucketIndex(const uint64_t value);
+
+    /**
+     * @brief Get the middle of the durations counted in a bucket.
+     * @param[in] index The bucket index.
+     * @return The duration in nanoseconds.
+     */
+    static int64_t bucketValue(const int index);
+
+    /// The count of each bucket.
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_counts;
+
+}; // End class LatencyHistogram
+
+
+/**
+ * @brief Receive timing of a single topic.
+ *
+ * @details Keeps histograms of the time between received samples and of the
+ *          time from the source timestamp to the receive time, plus a per
+ *          second receive count for a rolling rate. Everything is updated
+ *          with atomics on the receive thread, so nothing waits for the GUI
+ *          thread that reads it.
+ */
+class TopicHealth
+{
+public:
+
+    /**
+     * @brief A copy of the timing of a topic.
+     */
+    struct Snapshot
+    {
+        /// The receive rate over the last RATE_WINDOW seconds in Hz.
+        double rate = 0;
+
+        /// The times between received samples.
+        LatencyHistogram::Snapshot interval;
+
+        /// The times from the source timestamp to the receive time.
+        LatencyHistogram::Snapshot latency;
+    };
+
+    /**
+     * @brief Constructor for the topic timing.
+     */
+    TopicHealth();
+
+    /**
+     * @brief Count a received sample.
+     * @remarks Lock free.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receiveTime The receive timestamp in nanoseconds.
+     */
+    void record(const int64_t& sourceTime, const int64_t& receiveTime);
+
+    /**
+     * @brief Forget all counted samples.
+     */
+    void reset();
+
+    /**
+     * @brief Copy the current timing.
+     * @param[in] now The current time in nanoseconds, for the rolling rate.
+     * @param[out] snapshot Replaced with the current timing.
+     */
+    void getSnapshot(const int64_t& now, Snapshot& snapshot) const;
+
+    /// The number of complete seconds in the rolling rate.
+    static const int RATE_WINDOW = 5;
+
+private:
+
+    /// The times between received samples.
+    LatencyHistogram m_interval;
+
+    /// The times from the source timestamp to the receive time.
+    LatencyHistogram m_latency;
+
+    /// The receive time of the last sample or 0 before the first.
+    std::atomic<int64_t> m_lastReceive;
+
+    /// The second each rate slot is counting.
+    std::array<std::atomic<int64_t>, RATE_WINDOW + 1> m_rateSeconds;
+
+    /// The number of samples received in each rate slot.
+    std::array<std::atomic<uint64_t>, RATE_WINDOW + 1> m_rateCounts;
+
+}; // End class TopicHealth
+
+#endif
+
+/**
+ * @}
+ */
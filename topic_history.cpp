@@ -0,0 +1,900 @@
+#include "topic_history.h"
+#include "change_notifier.h"
+#include "history_budget.h"
+#include "instance_store.h"
+#include "open_dynamic_data.h"
+#include "plot_feed.h"
+#include "sample_columns.h"
+#include "sample_pool.h"
+#include "spill_store.h"
+#include "waterfall_feed.h"
+
+#include <algorithm>
+#include <chrono>
+
+
+//------------------------------------------------------------------------------
+static int64_t steadyNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+//------------------------------------------------------------------------------
+TopicHistory::TopicHistory(const QString& topicName,
+                           const size_t maxSamples,
+                           const int64_t maxAge,
+                           const std::shared_ptr<HistoryBudget>& budget) :
+                           m_name(topicName),
+                           m_ring(std::make_shared<Ring>(std::max<size_t>(maxSamples, 1))),
+                           m_latestSequence(0),
+                           m_oldestSequence(1),
+                           m_maxAge(std::max<int64_t>(maxAge, 0)),
+                           m_bytes(0),
+                           m_lastAccess(steadyNow()),
+                           m_budget(budget),
+                           m_changeCount(0),
+                           m_notifyPending(false)
+{}
+
+
+//------------------------------------------------------------------------------
+TopicHistory::~TopicHistory()
+{
+    if (m_budget)
+    {
+        m_budget->credit(m_bytes);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+const QString& TopicHistory::name() const
+{
+    return m_name;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicHistory::store(const int64_t& sourceTime,
+                             const int64_t& receiveTime,
+                             const std::shared_ptr<OpenDynamicData>& sample,
+                             const uint32_t writer)
+{
+    // Measure before the sample is published and readers can decode it.
+    // Whatever it grows by later is charged as it happens.
+    std::shared_ptr<SampleRecord> record = std::make_shared<SampleRecord>();
+    record->info.sourceTime = sourceTime;
+    record->info.receiveTime = receiveTime;
+    record->info.byteSize = sizeof(SampleRecord) + (sample ? sample->getByteSize() : 0);
+    record->info.writer = writer;
+    record->sample = sample;
+    if (sample)
+    {
+        const std::weak_ptr<TopicHistory> self = shared_from_this();
+        sample->setCharge([self](const size_t bytes)
+        {
+            const std::shared_ptr<TopicHistory> history = self.lock();
+            if (history)
+            {
+                history->chargeGrowth(bytes);
+            }
+        });
+    }
+
+    std::vector<std::shared_ptr<const SampleRecord>> evicted;
+    std::shared_ptr<const SampleRecord> fed;
+    std::shared_ptr<const std::vector<std::shared_ptr<PlotFeed>>> plotFeeds;
+    std::shared_ptr<const std::vector<std::shared_ptr<WaterfallFeed>>> waterfallFeeds;
+    std::unique_lock<std::mutex> feedLocker(m_feedMutex, std::defer_lock);
+    uint64_t sequence = 0;
+    bool overBudget = false;
+    {
+        std::lock_guard<std::mutex> locker(m_writeMutex);
+        Ring& ring = *m_ring;
+        sequence = m_latestSequence.load(std::memory_order_relaxed) + 1;
+        record->info.sequence = sequence;
+
+        // Make room in the ring
+        while (sequence - m_oldestSequence.load(std::memory_order_relaxed) >= ring.size())
+        {
+            evictOldest(evicted);
+        }
+
+        // Drop the samples that fell out of the time window
+        const int64_t maxAge = m_maxAge.load(std::memory_order_relaxed);
+        if (maxAge > 0)
+        {
+            while (m_oldestSequence.load(std::memory_order_relaxed) < sequence)
+            {
+                const std::shared_ptr<const SampleRecord> oldest =
+                    load(ring, m_oldestSequence.load(std::memory_order_relaxed));
+                if (oldest && receiveTime - oldest->info.receiveTime <= maxAge)
+                {
+                    break;
+                }
+                evictOldest(evicted);
+            }
+        }
+
+        // Index the sample under its writer, as deep as the ring
+        if (writer > 0)
+        {
+            std::lock_guard<std::mutex> writerLocker(m_writerMutex);
+            if (writer <= m_writers.size())
+            {
+                WriterEntry& entry = m_writers[writer - 1];
+                if (entry.info.count > 0)
+                {
+                    const double interval =
+                        static_cast<double>(receiveTime - entry.info.lastSeen);
+                    entry.info.interval = entry.info.interval > 0 ?
+                        entry.info.interval + (interval - entry.info.interval) * INTERVAL_SMOOTHING :
+                        interval;
+                }
+                entry.info.count++;
+                entry.info.lastSeen = receiveTime;
+
+                entry.samples.push_back(record->info);
+                while (entry.samples.size() > ring.size())
+                {
+                    entry.samples.pop_front();
+                }
+            }
+        }
+
+        // Publish the record before the sequence that makes it visible
+        const uint64_t byteSize = record->info.byteSize;
+        const std::shared_ptr<const SampleRecord> published(std::move(record));
+        std::atomic_store(&ring[sequence % ring.size()], published);
+        m_latestSequence.store(sequence, std::memory_order_release);
+
+        // Keyed under the write lock, so the newest sample of an instance
+        // is always the last one stored
+        const std::shared_ptr<InstanceStore> instances = getInstanceStore();
+        if (instances)
+        {
+            instances->store(published);
+        }
+
+        // Plots get every stored value, not just the newest at their tick.
+        // The feed lock is taken before the write lock goes, so the next
+        // writer can't push its sample first.
+        if (published->sample && (m_plotFeeds || m_waterfallFeeds))
+        {
+            fed = published;
+            plotFeeds = m_plotFeeds;
+            waterfallFeeds = m_waterfallFeeds;
+            feedLocker.lock();
+        }
+
+        m_bytes.fetch_add(byteSize, std::memory_order_relaxed);
+        overBudget = m_budget && m_budget->charge(byteSize);
+    }
+
+    if (feedLocker.owns_lock())
+    {
+        if (plotFeeds)
+        {
+            for (const std::shared_ptr<PlotFeed>& feed : *plotFeeds)
+            {
+                feed->push(fed->info, *fed->sample);
+            }
+        }
+        if (waterfallFeeds)
+        {
+            for (const std::shared_ptr<WaterfallFeed>& feed : *waterfallFeeds)
+            {
+                feed->push(fed->info, *fed->sample);
+            }
+        }
+        feedLocker.unlock();
+    }
+
+    recycle(evicted, true);
+    changed();
+
+    if (overBudget)
+    {
+        m_budget->enforce();
+    }
+
+    return sequence;
+
+} // End TopicHistory::store
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::clear()
+{
+    std::vector<std::shared_ptr<const SampleRecord>> evicted;
+    {
+        std::lock_guard<std::mutex> locker(m_writeMutex);
+        while (m_oldestSequence.load(std::memory_order_relaxed) <=
+               m_latestSequence.load(std::memory_order_relaxed))
+        {
+            evictOldest(evicted);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> writerLocker(m_writerMutex);
+        for (WriterEntry& entry : m_writers)
+        {
+            entry.samples.clear();
+        }
+    }
+
+    const std::shared_ptr<SpillStore> spill = getSpillStore();
+    if (spill)
+    {
+        spill->clear(latestSequence());
+    }
+
+    const std::shared_ptr<InstanceStore> instances = getInstanceStore();
+    if (instances)
+    {
+        instances->clear();
+    }
+
+    recycle(evicted, false);
+    changed();
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::setDepth(const size_t maxSamples, const int64_t maxAge)
+{
+    const size_t capacity = std::max<size_t>(maxSamples, 1);
+
+    std::vector<std::shared_ptr<const SampleRecord>> evicted;
+    {
+        std::lock_guard<std::mutex> locker(m_writeMutex);
+        m_maxAge.store(std::max<int64_t>(maxAge, 0), std::memory_order_relaxed);
+
+        const Ring& ring = *m_ring;
+        if (capacity != ring.size())
+        {
+            const uint64_t latest = m_latestSequence.load(std::memory_order_relaxed);
+            while (latest + 1 - m_oldestSequence.load(std::memory_order_relaxed) > capacity)
+            {
+                evictOldest(evicted);
+            }
+
+            // Readers still holding the old ring keep seeing valid records
+            std::shared_ptr<Ring> resized = std::make_shared<Ring>(capacity);
+            for (uint64_t sequence = m_oldestSequence.load(std::memory_order_relaxed);
+                 sequence <= latest;
+                 sequence++)
+            {
+                (*resized)[sequence % capacity] = ring[sequence % ring.size()];
+            }
+
+            std::atomic_store(&m_ring, resized);
+        }
+    }
+
+    if (!evicted.empty())
+    {
+        recycle(evicted, true);
+        changed();
+    }
+
+} // End TopicHistory::setDepth
+
+
+//------------------------------------------------------------------------------
+size_t TopicHistory::maxSamples() const
+{
+    return std::atomic_load(&m_ring)->size();
+}
+
+
+//------------------------------------------------------------------------------
+int64_t TopicHistory::maxAge() const
+{
+    return m_maxAge.load(std::memory_order_relaxed);
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicHistory::evictBytes(const uint64_t bytes)
+{
+    std::vector<std::shared_ptr<const SampleRecord>> evicted;
+    uint64_t freed = 0;
+    {
+        std::lock_guard<std::mutex> locker(m_writeMutex);
+
+        // Always keep the newest sample, so the topic still shows its value
+        while (freed < bytes &&
+               m_oldestSequence.load(std::memory_order_relaxed) <
+               m_latestSequence.load(std::memory_order_relaxed))
+        {
+            freed += evictOldest(evicted);
+        }
+    }
+
+    if (m_budget)
+    {
+        m_budget->addEvicted(evicted.size());
+    }
+
+    if (!evicted.empty())
+    {
+        recycle(evicted, true);
+        changed();
+    }
+
+    return freed;
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicHistory::size() const
+{
+    const uint64_t oldest = m_oldestSequence.load(std::memory_order_acquire);
+    const uint64_t latest = m_latestSequence.load(std::memory_order_acquire);
+    if (latest < oldest)
+    {
+        return 0;
+    }
+
+    const uint64_t count = latest - oldest + 1;
+    return static_cast<size_t>(std::min<uint64_t>(count, maxSamples()));
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicHistory::totalSize() const
+{
+    const std::shared_ptr<SpillStore> spill = getSpillStore();
+    return size() + (spill ? spill->size() : 0);
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicHistory::byteSize() const
+{
+    return m_bytes.load(std::memory_order_relaxed);
+}
+
+
+//------------------------------------------------------------------------------
+int64_t TopicHistory::lastAccess() const
+{
+    return m_lastAccess.load(std::memory_order_relaxed);
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicHistory::latestSequence() const
+{
+    return m_latestSequence.load(std::memory_order_acquire);
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicHistory::oldestSequence() const
+{
+    const uint64_t oldest = m_oldestSequence.load(std::memory_order_acquire);
+    const std::shared_ptr<SpillStore> spill = getSpillStore();
+    const uint64_t spilled = spill ? spill->oldestSequence() : 0;
+    return spilled > 0 ? std::min(spilled, oldest) : oldest;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const SampleRecord> TopicHistory::load(const Ring& ring,
+                                                       const uint64_t& sequence) const
+{
+    if (sequence == 0 || sequence < m_oldestSequence.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<const SampleRecord> record =
+        std::atomic_load(&ring[sequence % ring.size()]);
+
+    // The writer may have lapped us since the sequence was read
+    if (!record || record->info.sequence != sequence)
+    {
+        return nullptr;
+    }
+
+    return record;
+}
+
+
+//------------------------------------------------------------------------------
+bool TopicHistory::get(const size_t& index, SampleRecord& record) const
+{
+    touch();
+
+    const uint64_t latest = latestSequence();
+    if (index >= size() || index >= latest)
+    {
+        return false;
+    }
+
+    const std::shared_ptr<const Ring> ring = std::atomic_load(&m_ring);
+    const std::shared_ptr<const SampleRecord> stored = load(*ring, latest - index);
+    if (!stored)
+    {
+        return false;
+    }
+
+    record = *stored;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> TopicHistory::getSample(const size_t& index) const
+{
+    SampleRecord record;
+    if (!get(index, record))
+    {
+        return nullptr;
+    }
+
+    return record.sample;
+}
+
+
+//------------------------------------------------------------------------------
+QList<SampleInfo> TopicHistory::getSampleInfo() const
+{
+    touch();
+
+    QList<SampleInfo> infoList;
+
+    const std::shared_ptr<const Ring> ring = std::atomic_load(&m_ring);
+    const uint64_t latest = latestSequence();
+    const size_t count = size();
+    infoList.reserve(static_cast<int>(count));
+    for (size_t i = 0; i < count && i < latest; i++)
+    {
+        const std::shared_ptr<const SampleRecord> record = load(*ring, latest - i);
+        if (!record)
+        {
+            break;
+        }
+        infoList.append(record->info);
+    }
+
+    return infoList;
+}
+
+
+//------------------------------------------------------------------------------
+QList<SampleRecord> TopicHistory::getSamplesSince(const uint64_t& sequence) const
+{
+    touch();
+
+    QList<SampleRecord> records;
+
+    const std::shared_ptr<const Ring> ring = std::atomic_load(&m_ring);
+    const uint64_t latest = latestSequence();
+    const uint64_t oldest = latest - std::min<uint64_t>(latest, size()) + 1;
+    for (uint64_t current = std::max(oldest, sequence + 1); current <= latest; current++)
+    {
+        // Skip samples that were evicted while we were reading
+        const std::shared_ptr<const SampleRecord> record = load(*ring, current);
+        if (record)
+        {
+            records.append(*record);
+        }
+    }
+
+    return records;
+}
+
+
+//------------------------------------------------------------------------------
+SampleColumns TopicHistory::readColumns(const std::vector<MemberPath>& memberPaths,
+                                        const uint64_t& firstSequence,
+                                        const uint64_t& lastSequence) const
+{
+    touch();
+
+    SampleColumns columns(memberPaths);
+
+    const std::shared_ptr<const Ring> ring = std::atomic_load(&m_ring);
+    const uint64_t latest = latestSequence();
+    const uint64_t oldest = latest - std::min<uint64_t>(latest, size()) + 1;
+    const uint64_t first = std::max(oldest, firstSequence);
+    const uint64_t last = std::min(latest, lastSequence);
+    if (first > last)
+    {
+        return columns;
+    }
+
+    columns.reserve(static_cast<size_t>(last - first + 1));
+    for (uint64_t current = first; current <= last; current++)
+    {
+        // Skip samples that were evicted while we were reading
+        const std::shared_ptr<const SampleRecord> record = load(*ring, current);
+        if (record)
+        {
+            columns.append(record);
+        }
+    }
+
+    return columns;
+
+} // End TopicHistory::readColumns
+
+
+//------------------------------------------------------------------------------
+QList<SampleInfo> TopicHistory::getSampleInfo(const uint64_t& sequence,
+                                              const size_t& count) const
+{
+    touch();
+
+    QList<SampleInfo> infoList;
+
+    // The newest samples are still in memory
+    const std::shared_ptr<const Ring> ring = std::atomic_load(&m_ring);
+    uint64_t current = std::min(sequence, latestSequence());
+    while (current > 0 && static_cast<size_t>(infoList.size()) < count)
+    {
+        const std::shared_ptr<const SampleRecord> record = load(*ring, current);
+        if (!record)
+        {
+            break;
+        }
+        infoList.append(record->info);
+        current--;
+    }
+
+    // Page in the older ones from disk
+    const std::shared_ptr<SpillStore> spill = getSpillStore();
+    const size_t found = static_cast<size_t>(infoList.size());
+    if (spill && current > 0 && found < count)
+    {
+        infoList.append(spill->getSampleInfo(current, count - found));
+    }
+
+    return infoList;
+
+} // End TopicHistory::getSampleInfo
+
+
+//------------------------------------------------------------------------------
+QList<SampleInfo> TopicHistory::getSampleInfo(const uint64_t& sequence,
+                                              const size_t& count,
+                                              const uint32_t writer) const
+{
+    if (writer == 0)
+    {
+        return getSampleInfo(sequence, count);
+    }
+
+    touch();
+
+    QList<SampleInfo> infoList;
+    const uint64_t oldest = oldestSequence();
+
+    {
+        std::lock_guard<std::mutex> locker(m_writerMutex);
+        if (writer > m_writers.size())
+        {
+            return infoList;
+        }
+
+        // Older entries of the writer may have been evicted since
+        const std::deque<SampleInfo>& samples = m_writers[writer - 1].samples;
+        for (auto info = samples.rbegin();
+             info != samples.rend() && static_cast<size_t>(infoList.size()) < count;
+             ++info)
+        {
+            if (info->sequence < oldest)
+            {
+                break;
+            }
+            if (info->sequence <= sequence)
+            {
+                infoList.append(*info);
+            }
+        }
+    }
+
+    // Page in the older ones from disk, like the unfiltered list
+    const std::shared_ptr<SpillStore> spill = getSpillStore();
+    const uint64_t current = std::min(sequence, oldest - 1);
+    const size_t found = static_cast<size_t>(infoList.size());
+    if (spill && current > 0 && found < count)
+    {
+        infoList.append(spill->getSampleInfo(current, count - found, writer));
+    }
+
+    return infoList;
+
+} // End TopicHistory::getSampleInfo
+
+
+//------------------------------------------------------------------------------
+uint32_t TopicHistory::addWriter(const QString& name)
+{
+    std::lock_guard<std::mutex> locker(m_writerMutex);
+    for (const WriterEntry& entry : m_writers)
+    {
+        if (entry.info.name == name)
+        {
+            return entry.info.id;
+        }
+    }
+
+    WriterEntry entry;
+    entry.info.id = static_cast<uint32_t>(m_writers.size() + 1);
+    entry.info.name = name;
+    entry.info.count = 0;
+    entry.info.lastSeen = 0;
+    entry.info.interval = 0;
+    m_writers.push_back(std::move(entry));
+    return m_writers.back().info.id;
+
+} // End TopicHistory::addWriter
+
+
+//------------------------------------------------------------------------------
+QList<WriterInfo> TopicHistory::getWriters() const
+{
+    QList<WriterInfo> writers;
+
+    std::lock_guard<std::mutex> locker(m_writerMutex);
+    for (const WriterEntry& entry : m_writers)
+    {
+        writers.append(entry.info);
+    }
+
+    return writers;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> TopicHistory::getSampleBySequence(const uint64_t& sequence) const
+{
+    touch();
+
+    const std::shared_ptr<const Ring> ring = std::atomic_load(&m_ring);
+    const std::shared_ptr<const SampleRecord> record = load(*ring, sequence);
+    if (record)
+    {
+        return record->sample;
+    }
+
+    const std::shared_ptr<SpillStore> spill = getSpillStore();
+    return spill ? spill->getSample(sequence) : nullptr;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::setSpillStore(const std::shared_ptr<SpillStore>& spill)
+{
+    std::atomic_store(&m_spill, spill);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<SpillStore> TopicHistory::getSpillStore() const
+{
+    return std::atomic_load(&m_spill);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::setStatistics(const std::shared_ptr<FieldStatistics>& statistics)
+{
+    std::atomic_store(&m_statistics, statistics);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<FieldStatistics> TopicHistory::getStatistics() const
+{
+    return std::atomic_load(&m_statistics);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::setInstanceStore(const std::shared_ptr<InstanceStore>& instances)
+{
+    std::atomic_store(&m_instances, instances);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<InstanceStore> TopicHistory::getInstanceStore() const
+{
+    return std::atomic_load(&m_instances);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::addPlotFeed(const std::shared_ptr<PlotFeed>& feed)
+{
+    std::lock_guard<std::mutex> locker(m_writeMutex);
+    auto feeds = m_plotFeeds ?
+        std::make_shared<std::vector<std::shared_ptr<PlotFeed>>>(*m_plotFeeds) :
+        std::make_shared<std::vector<std::shared_ptr<PlotFeed>>>();
+    feeds->push_back(feed);
+    m_plotFeeds = feeds;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::removePlotFeed(const std::shared_ptr<PlotFeed>& feed)
+{
+    std::lock_guard<std::mutex> locker(m_writeMutex);
+    if (!m_plotFeeds)
+    {
+        return;
+    }
+
+    auto feeds = std::make_shared<std::vector<std::shared_ptr<PlotFeed>>>(*m_plotFeeds);
+    feeds->erase(std::remove(feeds->begin(), feeds->end(), feed), feeds->end());
+    m_plotFeeds = feeds->empty() ? nullptr : feeds;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::addWaterfallFeed(const std::shared_ptr<WaterfallFeed>& feed)
+{
+    std::lock_guard<std::mutex> locker(m_writeMutex);
+    auto feeds = m_waterfallFeeds ?
+        std::make_shared<std::vector<std::shared_ptr<WaterfallFeed>>>(*m_waterfallFeeds) :
+        std::make_shared<std::vector<std::shared_ptr<WaterfallFeed>>>();
+    feeds->push_back(feed);
+    m_waterfallFeeds = feeds;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::removeWaterfallFeed(const std::shared_ptr<WaterfallFeed>& feed)
+{
+    std::lock_guard<std::mutex> locker(m_writeMutex);
+    if (!m_waterfallFeeds)
+    {
+        return;
+    }
+
+    auto feeds = std::make_shared<std::vector<std::shared_ptr<WaterfallFeed>>>(*m_waterfallFeeds);
+    feeds->erase(std::remove(feeds->begin(), feeds->end(), feed), feeds->end());
+    m_waterfallFeeds = feeds->empty() ? nullptr : feeds;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicHistory::changeCount() const
+{
+    return m_changeCount.load(std::memory_order_acquire);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::setNotifier(const std::shared_ptr<ChangeNotifier>& notifier)
+{
+    std::atomic_store(&m_notifier, notifier);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::acknowledge()
+{
+    m_notifyPending.store(false, std::memory_order_release);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::setSamplePool(const std::shared_ptr<SamplePool>& pool)
+{
+    std::atomic_store(&m_pool, pool);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<SamplePool> TopicHistory::getSamplePool() const
+{
+    return std::atomic_load(&m_pool);
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicHistory::evictOldest(std::vector<std::shared_ptr<const SampleRecord>>& evicted)
+{
+    Ring& ring = *m_ring;
+    const uint64_t sequence = m_oldestSequence.load(std::memory_order_relaxed);
+
+    // Hide the sample from readers before its slot is emptied
+    m_oldestSequence.store(sequence + 1, std::memory_order_release);
+    std::shared_ptr<const SampleRecord> record = std::atomic_exchange(
+        &ring[sequence % ring.size()], std::shared_ptr<const SampleRecord>());
+
+    if (!record || record->info.sequence != sequence)
+    {
+        return 0;
+    }
+
+    // Stop charging the sample and give back what it grew by as well
+    uint64_t byteSize = record->info.byteSize;
+    if (record->sample)
+    {
+        byteSize += record->sample->setCharge(nullptr);
+    }
+
+    m_bytes.fetch_sub(byteSize, std::memory_order_relaxed);
+    if (m_budget)
+    {
+        m_budget->credit(byteSize);
+    }
+
+    evicted.push_back(std::move(record));
+    return byteSize;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::recycle(std::vector<std::shared_ptr<const SampleRecord>>& evicted,
+                           const bool spill)
+{
+    // Samples go back to their pool once the last reader lets go of them
+    const std::shared_ptr<SpillStore> spillStore = spill ? getSpillStore() : nullptr;
+    if (spillStore)
+    {
+        for (const std::shared_ptr<const SampleRecord>& record : evicted)
+        {
+            spillStore->spill(record);
+        }
+    }
+
+    evicted.clear();
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::chargeGrowth(const size_t bytes)
+{
+    // Over budget is left to the next store, since this runs on the reader
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (m_budget)
+    {
+        m_budget->charge(bytes);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::touch() const
+{
+    m_lastAccess.store(steadyNow(), std::memory_order_relaxed);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicHistory::changed()
+{
+    m_changeCount.fetch_add(1, std::memory_order_release);
+
+    // Only the first change since the last report needs to be posted
+    if (m_notifyPending.exchange(true, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    const std::shared_ptr<ChangeNotifier> notifier = std::atomic_load(&m_notifier);
+    if (notifier)
+    {
+        notifier->post(shared_from_this());
+    }
+    else
+    {
+        m_notifyPending.store(false, std::memory_order_release);
+    }
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,559 @@
+#ifndef __TOPIC_HISTORY_H__
+#define __TOPIC_HISTORY_H__
+
+#include <QList>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ChangeNotifier;
+class HistoryBudget;
+class InstanceStore;
+class OpenDynamicData;
+class PlotFeed;
+class MemberPath;
+class SampleColumns;
+class FieldStatistics;
+class SamplePool;
+class SpillStore;
+class WaterfallFeed;
+
+
+/**
+ * @brief Bookkeeping stored with each data sample.
+ */
+struct SampleInfo
+{
+    /// The per-topic sequence number. Starts at 1 and never repeats.
+    uint64_t sequence;
+
+    /// The source timestamp in nanoseconds since the epoch.
+    int64_t sourceTime;
+
+    /// The local receive timestamp in nanoseconds since the epoch.
+    int64_t receiveTime;
+
+    /// The number of bytes held by the sample when it was stored.
+    size_t byteSize;
+
+    /// The writer of the sample from TopicHistory::addWriter(), or 0 if
+    /// the writer isn't known.
+    uint32_t writer;
+};
+
+
+/**
+ * @brief What is known about a single writer of a topic.
+ */
+struct WriterInfo
+{
+    /// The writer id used in SampleInfo::writer.
+    uint32_t id;
+
+    /// The publication GUID of the writer.
+    QString name;
+
+    /// The number of samples received from the writer.
+    uint64_t count;
+
+    /// The receive time of the newest sample in nanoseconds.
+    int64_t lastSeen;
+
+    /// The smoothed time between samples in nanoseconds, or 0 before the
+    /// second sample.
+    double interval;
+};
+
+
+/**
+ * @brief A stored data sample along with its bookkeeping.
+ */
+struct SampleRecord
+{
+    /// The sequence number and timestamps of the sample.
+    SampleInfo info;
+
+    /// The data sample.
+    std::shared_ptr<OpenDynamicData> sample;
+};
+
+
+/**
+ * @brief The sample history of a single topic.
+ *
+ * @details Samples are kept in a ring of slots indexed by sequence number.
+ *          The writer publishes each record into its slot with an atomic
+ *          shared_ptr store and then advances the latest sequence. Readers
+ *          never take the write mutex. They load the ring and the slot and
+ *          check that it still holds the sequence they asked for, so a slot
+ *          overwritten in the meantime is simply reported as gone. A record
+ *          stays valid for as long as a reader holds on to it.
+ *
+ *          The atomic shared_ptr functions are not lock-free: libstdc++
+ *          guards them with a small pool of spinlocks picked by address. A
+ *          reader therefore only ever waits for another pointer copy to
+ *          finish, never for a store or an eviction.
+ *
+ *          The depth is a sample count (the ring size) and optionally a time
+ *          window. Every stored byte is charged to the shared HistoryBudget,
+ *          which evicts the oldest samples of the least recently viewed
+ *          topics when the process goes over its limit.
+ *
+ *          With a SpillStore attached, evicted samples are queued for the
+ *          spill writer instead of being dropped, and the sequence based
+ *          readers fall through to disk for samples no longer in memory.
+ *
+ *          Samples from known writers are also indexed per writer, in a
+ *          bounded queue of sample info as deep as the ring. Reading the
+ *          history of one writer only walks its own queue.
+ *
+ *          Plots attach a PlotFeed per variable. Each stored sample pushes
+ *          the plotted member to the feeds, so a graph sees every value
+ *          rather than the newest one at its refresh tick. The pushes run
+ *          after the write lock is released, under a feed lock taken before
+ *          it, so the feeds keep a single producer in sequence order.
+ *          Waterfall views attach a WaterfallFeed the same way, which takes
+ *          a whole array member per sample.
+ *
+ *          Every change bumps an atomic counter. With a ChangeNotifier
+ *          attached, the first change after the last report also posts the
+ *          history, so the GUI learns about it without polling.
+ *
+ *          Writes (store, clear, eviction and resizing) are serialized by a
+ *          mutex that readers never touch. Look the history up once with
+ *          CommonData::getHistory() and keep the handle, since that lookup
+ *          takes the lock of the history map.
+ */
+class TopicHistory : public std::enable_shared_from_this<TopicHistory>
+{
+public:
+
+    /**
+     * @brief Constructor for the topic history.
+     * @param[in] topicName The name of the topic.
+     * @param[in] maxSamples The maximum number of samples to keep.
+     * @param[in] maxAge Drop samples received longer ago than this many
+     *            nanoseconds before the newest. 0 keeps them by count only.
+     * @param[in] budget The shared memory budget or nullptr for none.
+     */
+    TopicHistory(const QString& topicName,
+                 const size_t maxSamples,
+                 const int64_t maxAge,
+                 const std::shared_ptr<HistoryBudget>& budget);
+
+    /**
+     * @brief Destructor for the topic history.
+     */
+    ~TopicHistory();
+
+    /**
+     * @brief Get the name of the topic.
+     * @return The topic name.
+     */
+    const QString& name() const;
+
+    /**
+     * @brief Store a new sample, evicting the oldest ones beyond the depth.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receiveTime The receive timestamp in nanoseconds.
+     * @param[in] sample The data sample.
+     * @param[in] writer The writer from addWriter(), or 0 if unknown.
+     * @return The sequence number assigned to the sample.
+     */
+    uint64_t store(const int64_t& sourceTime,
+                   const int64_t& receiveTime,
+                   const std::shared_ptr<OpenDynamicData>& sample,
+                   const uint32_t writer = 0);
+
+    /**
+     * @brief Get the id of a writer, adding it if it's new.
+     * @remarks Thread safe.
+     * @param[in] name The publication GUID of the writer.
+     * @return The writer id. Ids start at 1.
+     */
+    uint32_t addWriter(const QString& name);
+
+    /**
+     * @brief Get the writers that published samples on this topic.
+     * @return The writers, ordered by id.
+     */
+    QList<WriterInfo> getWriters() const;
+
+    /**
+     * @brief Remove all samples. Sequence numbers keep counting up.
+     */
+    void clear();
+
+    /**
+     * @brief Change the history depth.
+     * @remarks The newest samples are kept when the depth shrinks.
+     * @param[in] maxSamples The maximum number of samples to keep.
+     * @param[in] maxAge The time window in nanoseconds or 0 for none.
+     */
+    void setDepth(const size_t maxSamples, const int64_t maxAge);
+
+    /**
+     * @brief Get the maximum number of stored samples.
+     * @return The sample count limit.
+     */
+    size_t maxSamples() const;
+
+    /**
+     * @brief Get the time window of the history.
+     * @return The time window in nanoseconds or 0 for none.
+     */
+    int64_t maxAge() const;
+
+    /**
+     * @brief Evict the oldest samples to free memory.
+     * @remarks The newest sample is always kept.
+     * @param[in] bytes The number of bytes to free.
+     * @return The number of bytes actually freed.
+     */
+    uint64_t evictBytes(const uint64_t bytes);
+
+    /**
+     * @brief Get the number of stored samples.
+     * @return The sample count.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the number of stored samples, including spilled ones.
+     * @return The sample count.
+     */
+    size_t totalSize() const;
+
+    /**
+     * @brief Get the number of bytes held by the stored samples.
+     * @return The size in bytes.
+     */
+    uint64_t byteSize() const;
+
+    /**
+     * @brief Get when the history was last read.
+     * @return The steady clock time in nanoseconds.
+     */
+    int64_t lastAccess() const;
+
+    /**
+     * @brief Remember that a reader used the history.
+     * @details The history budget evicts from the least recently used topics
+     *          first. Reads through the history call this themselves. Views
+     *          that are fed through a PlotFeed or WaterfallFeed call it when
+     *          they drain their feed.
+     */
+    void touch() const;
+
+    /**
+     * @brief Get the sequence number of the newest sample.
+     * @return The sequence number or 0 if no sample was stored yet.
+     */
+    uint64_t latestSequence() const;
+
+    /**
+     * @brief Get the sequence number of the oldest stored sample.
+     * @details Spilled samples count as stored.
+     * @return The sequence number. Greater than latestSequence() if the
+     *         history is empty.
+     */
+    uint64_t oldestSequence() const;
+
+    /**
+     * @brief Get a stored sample by position.
+     * @param[in] index The sample index. 0 is the newest.
+     * @param[out] record The stored sample.
+     * @return False if there's no sample at this index.
+     */
+    bool get(const size_t& index, SampleRecord& record) const;
+
+    /**
+     * @brief Get a stored sample by position.
+     * @param[in] index The sample index. 0 is the newest.
+     * @return The sample or nullptr if there's no sample at this index.
+     */
+    std::shared_ptr<OpenDynamicData> getSample(const size_t& index) const;
+
+    /**
+     * @brief Get the bookkeeping of all stored samples.
+     * @return The sample info list. The newest is on the front.
+     */
+    QList<SampleInfo> getSampleInfo() const;
+
+    /**
+     * @brief Get the stored samples after a given sequence number.
+     * @param[in] sequence Only get samples with a higher sequence number.
+     * @return The samples, oldest first.
+     */
+    QList<SampleRecord> getSamplesSince(const uint64_t& sequence) const;
+
+    /**
+     * @brief Read members of a range of stored samples into columns.
+     * @details The history is walked once and every member is read from each
+     *          sample, so many members cost a single pass. Only samples in
+     *          memory are read.
+     * @param[in] memberPaths The members to read, one column each.
+     * @param[in] firstSequence The sequence number of the first sample.
+     * @param[in] lastSequence The sequence number of the last sample.
+     * @return The member columns, oldest sample first.
+     */
+    SampleColumns readColumns(const std::vector<MemberPath>& memberPaths,
+                              const uint64_t& firstSequence,
+                              const uint64_t& lastSequence) const;
+
+    /**
+     * @brief Get the bookkeeping of stored samples, including spilled ones.
+     * @param[in] sequence Start at the newest sample up to this sequence.
+     * @param[in] count The maximum number of samples.
+     * @return The sample info list. The newest is on the front.
+     */
+    QList<SampleInfo> getSampleInfo(const uint64_t& sequence, const size_t& count) const;
+
+    /**
+     * @brief Get the bookkeeping of the stored samples of a single writer,
+     *        including spilled ones.
+     * @param[in] sequence Start at the newest sample up to this sequence.
+     * @param[in] count The maximum number of samples.
+     * @param[in] writer The writer id or 0 for all writers.
+     * @return The sample info list. The newest is on the front.
+     */
+    QList<SampleInfo> getSampleInfo(const uint64_t& sequence,
+                                    const size_t& count,
+                                    const uint32_t writer) const;
+
+    /**
+     * @brief Get a stored sample by sequence number, including spilled ones.
+     * @param[in] sequence The sequence number of the sample.
+     * @return The sample or nullptr if it's no longer stored.
+     */
+    std::shared_ptr<OpenDynamicData> getSampleBySequence(const uint64_t& sequence) const;
+
+    /**
+     * @brief Attach the disk tier for evicted samples.
+     * @param[in] spill The spill store of this topic or nullptr for none.
+     */
+    void setSpillStore(const std::shared_ptr<SpillStore>& spill);
+
+    /**
+     * @brief Get the disk tier for evicted samples.
+     * @return The spill store or nullptr if there is none.
+     */
+    std::shared_ptr<SpillStore> getSpillStore() const;
+
+    /**
+     * @brief Attach the running member statistics of this topic.
+     * @param[in] statistics The statistics to update or nullptr for none.
+     */
+    void setStatistics(const std::shared_ptr<FieldStatistics>& statistics);
+
+    /**
+     * @brief Get the running member statistics of this topic.
+     * @return The statistics or nullptr if they are off.
+     */
+    std::shared_ptr<FieldStatistics> getStatistics() const;
+
+    /**
+     * @brief Attach the newest sample of every keyed instance of this topic.
+     * @param[in] instances The instance store to update or nullptr for none.
+     */
+    void setInstanceStore(const std::shared_ptr<InstanceStore>& instances);
+
+    /**
+     * @brief Get the newest sample of every keyed instance of this topic.
+     * @return The instance store or nullptr if instances aren't tracked.
+     */
+    std::shared_ptr<InstanceStore> getInstanceStore() const;
+
+    /**
+     * @brief Feed the plotted member of every sample stored from now on to a plot.
+     * @param[in] feed The plot feed to push to.
+     */
+    void addPlotFeed(const std::shared_ptr<PlotFeed>& feed);
+
+    /**
+     * @brief Stop feeding a plot.
+     * @param[in] feed The plot feed from addPlotFeed().
+     */
+    void removePlotFeed(const std::shared_ptr<PlotFeed>& feed);
+
+    /**
+     * @brief Feed the array member of every sample stored from now on to a
+     *        waterfall view.
+     * @param[in] feed The waterfall feed to push to.
+     */
+    void addWaterfallFeed(const std::shared_ptr<WaterfallFeed>& feed);
+
+    /**
+     * @brief Stop feeding a waterfall view.
+     * @param[in] feed The waterfall feed from addWaterfallFeed().
+     */
+    void removeWaterfallFeed(const std::shared_ptr<WaterfallFeed>& feed);
+
+    /**
+     * @brief Get the number of changes made to the history.
+     * @details Counts stored samples, evictions, clears and resizes, so
+     *          readers can tell cheaply whether to read again.
+     * @return The change count.
+     */
+    uint64_t changeCount() const;
+
+    /**
+     * @brief Set the notifier that reports changes to the GUI.
+     * @param[in] notifier The change notifier or nullptr for none.
+     */
+    void setNotifier(const std::shared_ptr<ChangeNotifier>& notifier);
+
+    /**
+     * @brief Allow the next change to be posted to the notifier.
+     * @remarks Called by the notifier before it reports the history.
+     */
+    void acknowledge();
+
+    /**
+     * @brief Set the pool the samples of this topic come from.
+     * @param[in] pool The sample pool for this topic.
+     */
+    void setSamplePool(const std::shared_ptr<SamplePool>& pool);
+
+    /**
+     * @brief Get the pool the samples of this topic come from.
+     * @return The sample pool or nullptr if none was set.
+     */
+    std::shared_ptr<SamplePool> getSamplePool() const;
+
+private:
+
+    /// The slots of the history. The slot of a sequence is sequence % size.
+    typedef std::vector<std::shared_ptr<const SampleRecord>> Ring;
+
+    /// A writer and the index of its samples.
+    struct WriterEntry
+    {
+        /// What is known about the writer.
+        WriterInfo info;
+
+        /// The info of the newest samples of the writer, oldest first.
+        std::deque<SampleInfo> samples;
+    };
+
+    /**
+     * @brief Load the record for a sequence number.
+     * @param[in] ring The ring to read from.
+     * @param[in] sequence The sequence number.
+     * @return The record or nullptr if the slot holds another sample.
+     */
+    std::shared_ptr<const SampleRecord> load(const Ring& ring,
+                                             const uint64_t& sequence) const;
+
+    /**
+     * @brief Remove the oldest stored sample.
+     * @remarks Must be called with m_writeMutex held.
+     * @param[out] evicted The removed record is appended here.
+     * @return The number of bytes freed.
+     */
+    uint64_t evictOldest(std::vector<std::shared_ptr<const SampleRecord>>& evicted);
+
+    /**
+     * @brief Hand evicted records to the spill store, or drop them.
+     * @remarks Pooled samples return to their pool when the last reference
+     *          is dropped.
+     * @param[in] evicted The evicted records.
+     * @param[in] spill Whether the records may be spilled to disk.
+     */
+    void recycle(std::vector<std::shared_ptr<const SampleRecord>>& evicted,
+                 const bool spill);
+
+    /**
+     * @brief Charge the growth of a stored sample.
+     * @remarks Called by the sample, from whichever thread decoded it.
+     * @param[in] bytes The number of bytes the sample grew by.
+     */
+    void chargeGrowth(const size_t bytes);
+
+    /**
+     * @brief Count a change and post it to the notifier if not pending.
+     * @remarks Called after the change is visible to readers.
+     */
+    void changed();
+
+    /// The name of the topic.
+    const QString m_name;
+
+    /// The ring of slots. The pointer and the slots are accessed with the
+    /// atomic shared_ptr functions.
+    std::shared_ptr<Ring> m_ring;
+
+    /// The sequence number of the newest sample.
+    std::atomic<uint64_t> m_latestSequence;
+
+    /// The sequence number of the oldest sample still stored.
+    std::atomic<uint64_t> m_oldestSequence;
+
+    /// The time window in nanoseconds or 0 for none.
+    std::atomic<int64_t> m_maxAge;
+
+    /// The number of bytes held by the stored samples.
+    std::atomic<uint64_t> m_bytes;
+
+    /// When a reader last used the history, in steady clock nanoseconds.
+    mutable std::atomic<int64_t> m_lastAccess;
+
+    /// The shared memory budget the stored bytes are charged to.
+    std::shared_ptr<HistoryBudget> m_budget;
+
+    /// The pool the samples come from. Accessed atomically.
+    std::shared_ptr<SamplePool> m_pool;
+
+    /// The disk tier for evicted samples. Accessed atomically.
+    std::shared_ptr<SpillStore> m_spill;
+
+    /// The running member statistics, updated as samples arrive.
+    std::shared_ptr<FieldStatistics> m_statistics;
+
+    /// The newest sample of every keyed instance. Accessed atomically.
+    std::shared_ptr<InstanceStore> m_instances;
+
+    /// The feeds of plotted members. Replaced rather than changed, under
+    /// m_writeMutex, so store() can push to a snapshot after unlocking.
+    std::shared_ptr<const std::vector<std::shared_ptr<PlotFeed>>> m_plotFeeds;
+
+    /// The feeds of array members shown as waterfalls, kept like the plot
+    /// feeds.
+    std::shared_ptr<const std::vector<std::shared_ptr<WaterfallFeed>>> m_waterfallFeeds;
+
+    /// Reports changes to the GUI. Accessed atomically.
+    std::shared_ptr<ChangeNotifier> m_notifier;
+
+    /// The number of changes made to the history.
+    std::atomic<uint64_t> m_changeCount;
+
+    /// True while a change was posted but not yet reported.
+    std::atomic<bool> m_notifyPending;
+
+    /// Serializes the writers.
+    std::mutex m_writeMutex;
+
+    /// Serializes the feed pushes. Taken while m_writeMutex is held.
+    std::mutex m_feedMutex;
+
+    /// The writers of the topic. The entry of a writer id is at id - 1.
+    std::vector<WriterEntry> m_writers;
+
+    /// Protects m_writers.
+    mutable std::mutex m_writerMutex;
+
+    /// The weight of the newest interval in the smoothed writer interval.
+    static constexpr double INTERVAL_SMOOTHING = 0.1;
+
+}; // End class TopicHistory
+
+#endif
+
+/**
+ * @}
+ */
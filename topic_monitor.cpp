@@ -1,11 +1,19 @@
 #include "qos_dictionary.h"
 #include "open_dynamic_data.h"
+#include "decode_plan.h"
+#include "field_statistics.h"
+#include "sample_pipeline.h"
+#include "sample_pool.h"
+#include "spill_store.h"
+#include "topic_health.h"
 #include "topic_monitor.h"
+#include "topic_history.h"
 #include "dynamic_meta_struct.h"
 #include "dds_manager.h"
 #include "dds_data.h"
 #include "qos_dictionary.h"
-#include <QDateTime>
+#include <dds/DCPS/GuidConverter.h>
+#include <chrono>
 #include <iostream>
 
 
@@ -16,7 +24,10 @@ TopicMonitor::TopicMonitor(const QString& topicName) :
                            m_typeCode(nullptr),
                            m_recorder(nullptr),
                            m_topic(nullptr),
-                           m_paused(false)
+                           m_paused(false),
+                           m_workerIndex(0),
+                           m_droppedSamples(0),
+                           m_health(std::make_shared<TopicHealth>())
 {
     // Make sure we have an information object for this topic
     std::shared_ptr<TopicInfo> topicInfo = CommonData::getTopicInfo(topicName);
@@ -41,6 +52,30 @@ TopicMonitor::TopicMonitor(const QString& topicName) :
     //store extensibility
     m_extensibility = topicInfo->extensibility;
 
+    // Compile the type once, so each sample is a flat loop over the plan
+    m_decodePlan = std::make_shared<const DecodePlan>(
+        m_typeCode, QosDictionary::getEncodingKind(), m_extensibility);
+
+    // Evicted samples come back through the pool to be decoded into again
+    m_samplePool = std::make_shared<SamplePool>(
+        m_typeCode, QosDictionary::getEncodingKind(), m_extensibility,
+        CommonData::m_historyBudget);
+    m_history = CommonData::getHistory(m_topicName);
+    m_history->setSamplePool(m_samplePool);
+
+    // Samples evicted from memory go to disk if spilling is enabled
+    if (CommonData::m_spillWriter && !m_history->getSpillStore())
+    {
+        m_history->setSpillStore(CommonData::m_spillWriter->createStore(
+            m_topicName, m_decodePlan, m_samplePool));
+    }
+
+    // Pin the topic to one worker, so its samples stay in order
+    if (CommonData::m_samplePipeline)
+    {
+        m_workerIndex = CommonData::m_samplePipeline->assignWorker();
+    }
+
     OpenDDS::DCPS::Service_Participant* service = TheServiceParticipant;
     DDS::DomainParticipant* domain = CommonData::m_ddsManager->getDomainParticipant();
 
@@ -88,15 +123,55 @@ TopicMonitor::~TopicMonitor()
 
 
 //------------------------------------------------------------------------------
-void TopicMonitor::setFilter(const QString& filter)
+bool TopicMonitor::setFilter(const QString& filter, QString* errorMessage)
 {
+    OpenDDS::DCPS::RcHandle<OpenDDS::DCPS::FilterEvaluator> filterEvaluator;
+    std::shared_ptr<DynamicMetaStruct> metaStruct;
+
+    if (!filter.isEmpty())
+    {
+        // Let OpenDDS parse the filter once. An exception is thrown with details.
+        try
+        {
+            filterEvaluator = OpenDDS::DCPS::make_rch<OpenDDS::DCPS::FilterEvaluator>(
+                filter.toUtf8().data(), false);
+        }
+        catch (const std::exception& e)
+        {
+            if (errorMessage)
+            {
+                *errorMessage = e.what();
+            }
+            return false;
+        }
+
+        // Resolve the member paths up front, so the workers never look one up
+        metaStruct = std::make_shared<DynamicMetaStruct>(m_typeCode);
+        std::string unknownField;
+        if (!metaStruct->bindFields(filter.toUtf8().data(), unknownField))
+        {
+            if (errorMessage)
+            {
+                *errorMessage = "'" + QString::fromStdString(unknownField) +
+                    "' is not a member of " + m_topicName;
+            }
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> locker(m_filterMutex);
     m_filter = filter;
-}
+    m_filterEvaluator = filterEvaluator;
+    m_metaStruct = metaStruct;
+    return true;
+
+} // End TopicMonitor::setFilter
 
 
 //------------------------------------------------------------------------------
 QString TopicMonitor::getFilter() const
 {
+    std::lock_guard<std::mutex> locker(m_filterMutex);
     return m_filter;
 }
 
@@ -166,45 +241,89 @@ void TopicMonitor::on_sample_data_received(OpenDDS::DCPS::Recorder*,
         return;
     }
         
-    OpenDDS::DCPS::Serializer serial(
-        rawSample.sample_.get(), rawSample.encoding_kind_, static_cast<OpenDDS::DCPS::Endianness>(rawSample.header_.byte_order_));
-
     //RJ 2022-01-20 With OpenDDS 3.19.0, the entire message header is read before the sample gets passed to this function.
     //Code that strips off the RTPS header has been removed. 
     //Same with the reset_alignment call in the serializer. That has already happened before the sample is passed to this function.
-    bool pass = true;
-
-    std::shared_ptr<OpenDynamicData> sample = CreateOpenDynamicData(m_typeCode, globalEncoding, m_extensibility);
-    if(globalEncoding !=  OpenDDS::DCPS::Encoding::KIND_XCDR1)
-    {                    
-        std::cout << "Removing delimiter header" << std::endl;
-        uint32_t delim_header=0;
-        if (! (serial >> delim_header)) {
-            std::cerr << "OpenDynamicData::on_sample_data_received "
-                        << "Could not read stream delimiter"
-                        << std::endl;
-            pass = false;
-            return;
-        }
-        //std::cout << "DEBUG on_sample_data_received eating top level struct stream delim. Size returned: " << delim_header <<std::endl;
-    }
 
-    (*(sample.get())) << serial;
+    // Only keep the payload here. It is decoded when a page, the recorder or
+    // the filter first reads a member value.
+    std::shared_ptr<OpenDynamicData> sample = m_samplePool->acquire();
+    if (!m_decodePlan || !sample->setPayload(m_decodePlan,
+                                             *rawSample.sample_,
+                                             rawSample.encoding_kind_,
+                                             static_cast<OpenDDS::DCPS::Endianness>(rawSample.header_.byte_order_)))
+    {
+        std::cerr << "TopicMonitor::on_sample_data_received: "
+                  << "Failed to store sample for "
+                  << m_topicName.toStdString()
+                  << std::endl;
+    }
     //sample->dump();
 
 
+    const int64_t sourceTime =
+        (static_cast<int64_t>(rawSample.source_timestamp_.sec) * 1000000000) +
+        static_cast<int64_t>(rawSample.source_timestamp_.nanosec);
+
+    const int64_t receiveTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Time every sample off the bus, including those the filter rejects
+    m_health->record(sourceTime, receiveTime);
+
+    const uint32_t writer = writerId(rawSample.header_.publication_id_);
+
+    // Filter and store on a worker thread, so this transport thread is free
+    // for the next sample
+    if (CommonData::m_samplePipeline)
+    {
+        SampleJob job;
+        job.monitor = OpenDDS::DCPS::rchandle_from(this);
+        job.sample = std::move(sample);
+        job.sourceTime = sourceTime;
+        job.receiveTime = receiveTime;
+        job.writer = writer;
+        CommonData::m_samplePipeline->push(m_workerIndex, std::move(job));
+        return;
+    }
+
+    processSample(std::move(sample), sourceTime, receiveTime, writer);
+
+} // End TopicMonitor::on_sample_data_received
+
+
+//------------------------------------------------------------------------------
+void TopicMonitor::processSample(std::shared_ptr<OpenDynamicData> sample,
+                                 const int64_t& sourceTime,
+                                 const int64_t& receiveTime,
+                                 const uint32_t writer)
+{
+    if (!sample)
+    {
+        return;
+    }
+
     // If a filter was specified, make sure the sample passes
-    if (!m_filter.isEmpty())
+    OpenDDS::DCPS::RcHandle<OpenDDS::DCPS::FilterEvaluator> filterEvaluator;
+    std::shared_ptr<DynamicMetaStruct> metaStruct;
+    {
+        std::lock_guard<std::mutex> locker(m_filterMutex);
+        filterEvaluator = m_filterEvaluator;
+        metaStruct = m_metaStruct;
+    }
+
+    if (filterEvaluator)
     {
-        pass = false;
+        // Fields at a fixed offset are read straight from the payload, so a
+        // rejected sample is usually never decoded. DynamicMetaStruct reads
+        // the sample itself, so the evaluator gets an empty block.
+        bool pass = false;
+        ACE_Message_Block unusedBlock(static_cast<size_t>(0));
+        metaStruct->setSample(sample);
         try
         {
-            OpenDDS::DCPS::FilterEvaluator filterTest(m_filter.toUtf8().data(), false);
-            DynamicMetaStruct metaInfo(sample);
- 
             const DDS::StringSeq noParams;
-            pass = filterTest.eval(rawSample.sample_.get(), false, false, metaInfo, noParams, m_extensibility);
-            
+            pass = filterEvaluator->eval(&unusedBlock, false, false, *metaStruct, noParams, m_extensibility);
         }
         catch (const std::exception& e)
         {
@@ -212,6 +331,10 @@ void TopicMonitor::on_sample_data_received(OpenDDS::DCPS::Recorder*,
             pass = false;
         }
 
+        // Don't hold on to the sample, or the pool can't recycle it
+        metaStruct->setSample(nullptr);
+
+        // A filtered out sample goes back to the pool as it's dropped here
         if (!pass)
         {
             return;
@@ -220,14 +343,57 @@ void TopicMonitor::on_sample_data_received(OpenDDS::DCPS::Recorder*,
     } // End filter check
 
 
-    QDateTime dataTime = QDateTime::fromMSecsSinceEpoch(
-    (static_cast<unsigned long long>(rawSample.source_timestamp_.sec) * 1000) +
-    (static_cast<unsigned long long>(rawSample.source_timestamp_.nanosec) * 1e-6));
+    // Statistics need every member value, so they decode each sample
+    const std::shared_ptr<FieldStatistics> statistics = m_history->getStatistics();
+    if (statistics)
+    {
+        statistics->update(*sample, receiveTime);
+    }
+
+    m_history->store(sourceTime, receiveTime, sample, writer);
+
+} // End TopicMonitor::processSample
 
-    QString sampleName = dataTime.toString("HH:mm:ss.zzz");
-    CommonData::storeSample(m_topicName, sampleName, sample);
 
-} // End TopicMonitor::on_sample_data_received
+//------------------------------------------------------------------------------
+uint32_t TopicMonitor::writerId(const OpenDDS::DCPS::GUID_t& publication)
+{
+    std::lock_guard<std::mutex> locker(m_writerMutex);
+    const auto iter = m_writerIds.find(publication);
+    if (iter != m_writerIds.end())
+    {
+        return iter->second;
+    }
+
+    // Only a new writer needs its GUID formatted
+    const OPENDDS_STRING name = OpenDDS::DCPS::GuidConverter(publication);
+    const uint32_t writer = m_history->addWriter(QString::fromUtf8(name.c_str()));
+    m_writerIds[publication] = writer;
+    return writer;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicMonitor::dropSample(std::shared_ptr<OpenDynamicData> sample)
+{
+    // The sample returns to the pool once the last reference is gone
+    ++m_droppedSamples;
+    sample.reset();
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicMonitor::getDroppedCount() const
+{
+    return m_droppedSamples;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<TopicHealth> TopicMonitor::getHealth() const
+{
+    return m_health;
+}
 
 
 //------------------------------------------------------------------------------
@@ -9,10 +9,23 @@
 #include <dds/DCPS/RecorderImpl.h>
 #include <dds/DdsDcpsCoreC.h>
 #include <dds/DCPS/Serializer.h>
+#include <dds/DCPS/FilterEvaluator.h>
+#include <dds/DCPS/GuidUtils.h>
 
 #include <QString>
 
+#include <atomic>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
+
+class DecodePlan;
+class DynamicMetaStruct;
+class OpenDynamicData;
+class SamplePool;
+class TopicHealth;
+class TopicHistory;
 
 /**
  * @brief Topic monitor for receiving raw DDS data samples.
@@ -30,9 +43,13 @@ public:
 
     /**
      * @brief Apply a filter to this topic.
+     * @details The filter is parsed and its fields are resolved here, so each
+     *          sample only has to evaluate the compiled expression.
      * @param[in] filter The SQL filter string for this topic.
+     * @param[out] errorMessage The reason a filter was rejected, if not null.
+     * @return True if the filter was applied; false if it's invalid.
      */
-    void setFilter(const QString& filter);
+    bool setFilter(const QString& filter, QString* errorMessage = nullptr);
 
     /**
     * @brief Get the current filter for this topic.
@@ -57,6 +74,38 @@ public:
     virtual void on_sample_data_received(OpenDDS::DCPS::Recorder* recorder,
                                          const OpenDDS::DCPS::RawDataSample& rawSample);
 
+    /**
+     * @brief Filter a received sample and store it if it passes.
+     * @remarks Called from a SamplePipeline worker, or from the receive
+     *          thread if there's no pipeline.
+     * @param[in] sample The sample with its retained payload.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receiveTime The receive timestamp in nanoseconds.
+     * @param[in] writer The writer id of the sample in the topic history.
+     */
+    void processSample(std::shared_ptr<OpenDynamicData> sample,
+                       const int64_t& sourceTime,
+                       const int64_t& receiveTime,
+                       const uint32_t writer);
+
+    /**
+     * @brief Discard a sample the pipeline had no room for.
+     * @param[in] sample The dropped sample.
+     */
+    void dropSample(std::shared_ptr<OpenDynamicData> sample);
+
+    /**
+     * @brief Get the number of samples of this topic dropped by the pipeline.
+     * @return The drop count.
+     */
+    uint64_t getDroppedCount() const;
+
+    /**
+     * @brief Get the receive timing of this topic.
+     * @return The rate, interval and latency statistics.
+     */
+    std::shared_ptr<TopicHealth> getHealth() const;
+
     /**
      * @brief Callback for a newly discovered publisher for this topic.
      * @param[in] recorder The recorder object with the newly discovered match.
@@ -82,6 +131,13 @@ public:
 
 private:
 
+    /**
+     * @brief Get the history writer id of a publication.
+     * @param[in] publication The publication GUID of a sample.
+     * @return The writer id.
+     */
+    uint32_t writerId(const OpenDDS::DCPS::GUID_t& publication);
+
     /// Stores the name of the topic.
     QString m_topicName;
 
@@ -103,6 +159,39 @@ private:
     /// The topic extensibility
     OpenDDS::DCPS::Extensibility m_extensibility;
 
+    /// The compiled decode program for this topic type.
+    std::shared_ptr<const DecodePlan> m_decodePlan;
+
+    /// Recycles the samples evicted from the history of this topic.
+    std::shared_ptr<SamplePool> m_samplePool;
+
+    /// The sample history of this topic, fetched once at construction.
+    std::shared_ptr<TopicHistory> m_history;
+
+    /// The compiled filter expression or null if there's no filter.
+    OpenDDS::DCPS::RcHandle<OpenDDS::DCPS::FilterEvaluator> m_filterEvaluator;
+
+    /// Reads the filter fields from samples through resolved member paths.
+    std::shared_ptr<DynamicMetaStruct> m_metaStruct;
+
+    /// Protects the filter members, which are set from the GUI thread.
+    mutable std::mutex m_filterMutex;
+
+    /// The pipeline worker this topic is pinned to.
+    size_t m_workerIndex;
+
+    /// The number of samples dropped by the pipeline.
+    std::atomic<uint64_t> m_droppedSamples;
+
+    /// The receive timing of every sample, before filtering.
+    std::shared_ptr<TopicHealth> m_health;
+
+    /// The history writer id of each publication seen so far.
+    std::map<OpenDDS::DCPS::GUID_t, uint32_t, OpenDDS::DCPS::GUID_tKeyLessThan> m_writerIds;
+
+    /// Protects m_writerIds.
+    std::mutex m_writerMutex;
+
 }; // End TopicMonitor
 
 #endif
@@ -111,7 +111,10 @@ void TopicReplayer::publishSample(const std::shared_ptr<OpenDynamicData> sample)
     //Serialize the Encapsulation Header
     pass &= (serial << encap);
 
-    if(globalEncoding !=  OpenDDS::DCPS::Encoding::KIND_XCDR1)
+    // Only appendable and mutable types carry a delimiter header in XCDR2.
+    // Final types used to get one too, which their own writers never send.
+    if((globalEncoding !=  OpenDDS::DCPS::Encoding::KIND_XCDR1) &&
+       (m_extensibility != OpenDDS::DCPS::Extensibility::FINAL))
     {
         CORBA::ULong delim_header= num_data_bytes; //sample->getEncapsulationLength();
         //std::cout << "DEBUG TopicReplayer::publishSample encapsulation length " << delim_header << std::endl;
@@ -17,9 +17,11 @@ TopicTableModel::TopicTableModel(
     QAbstractTableModel(parent),
     m_tableView(parent),
     m_sample(nullptr),
-    m_topicName(topicName)
+    m_topicName(topicName),
+    m_typeCode(nullptr)
 {
-    m_columnHeaders /*<< ""*/ << "Name" << "Type" << "Value";
+    m_columnHeaders /*<< ""*/ << "Name" << "Type" << "Value"
+                    << "Min" << "Max" << "Mean" << "Std Dev" << "Rate (Hz)";
     m_tableView->setItemDelegate(new LineEditDelegate(this));
 
     // Create a blank sample, so the user can publish an initial instance
@@ -64,6 +66,20 @@ void TopicTableModel::setSample(std::shared_ptr<OpenDynamicData> sample)
         return;
     }
 
+    // The rows only have to be rebuilt if the members changed
+    std::vector<size_t> shape;
+    sample->getSequenceLengths(shape);
+    const bool sameShape = !m_data.empty() &&
+                           sample->getTypeCode() == m_typeCode &&
+                           shape == m_shape;
+
+    m_sample = sample;
+    if (sameShape)
+    {
+        updateValues();
+        return;
+    }
+
     emit layoutAboutToBeChanged();
 
     while (!m_data.empty())
@@ -72,7 +88,8 @@ void TopicTableModel::setSample(std::shared_ptr<OpenDynamicData> sample)
        m_data.pop_back();
     }
 
-    m_sample = sample;
+    m_typeCode = m_sample->getTypeCode();
+    m_shape.swap(shape);
     parseData(m_sample);
 
     emit layoutChanged();
@@ -123,7 +140,8 @@ int TopicTableModel::rowCount(const QModelIndex &) const
 //------------------------------------------------------------------------------
 int TopicTableModel::columnCount(const QModelIndex &) const
 {
-    return MAX_eColumnIds_VALUE;
+    // The statistics columns are only there while statistics are shown
+    return m_statistics ? MAX_eColumnIds_VALUE : VALUE_COLUMN + 1;
 }
 
 
@@ -141,7 +159,7 @@ QVariant TopicTableModel::headerData(int section,
     {
         return QString::number(section);
     }
-    else if (orientation == Qt::Horizontal && section < m_columnHeaders.count())
+    else if (orientation == Qt::Horizontal && section < columnCount())
     {
         return m_columnHeaders.at(section);
     }
@@ -229,6 +247,24 @@ QVariant TopicTableModel::data(const QModelIndex &index, int role) const
             default: return "?";
         }
     }
+    else if (role == Qt::DisplayRole && column >= MIN_COLUMN && column <= RATE_COLUMN)
+    {
+        const int statIndex = m_data.at(row)->statIndex;
+        if (!m_statistics || statIndex < 0 || m_snapshot.count == 0 ||
+            statIndex >= static_cast<int>(m_snapshot.mean.size()))
+        {
+            return QVariant();
+        }
+
+        switch (column)
+        {
+            case MIN_COLUMN: return m_snapshot.min[statIndex];
+            case MAX_COLUMN: return m_snapshot.max[statIndex];
+            case MEAN_COLUMN: return m_snapshot.mean[statIndex];
+            case STDDEV_COLUMN: return m_snapshot.stddev[statIndex];
+            default: return m_snapshot.rate;
+        }
+    }
 
     return QVariant();
 
@@ -286,6 +322,60 @@ void TopicTableModel::revertChanges()
 }
 
 
+//------------------------------------------------------------------------------
+void TopicTableModel::setStatistics(const std::shared_ptr<FieldStatistics>& statistics)
+{
+    if (statistics == m_statistics)
+    {
+        return;
+    }
+
+    if (m_statistics)
+    {
+        beginRemoveColumns(QModelIndex(), MIN_COLUMN, RATE_COLUMN);
+        m_statistics = nullptr;
+        endRemoveColumns();
+    }
+
+    m_snapshot = FieldStatistics::Snapshot();
+    for (DataRow* dataRow : m_data)
+    {
+        const std::string fullName = dataRow->name.toStdString();
+        dataRow->statIndex = statistics ? statistics->indexOf(fullName) : -1;
+    }
+
+    if (statistics)
+    {
+        beginInsertColumns(QModelIndex(), MIN_COLUMN, RATE_COLUMN);
+        m_statistics = statistics;
+        endInsertColumns();
+        refreshStatistics();
+    }
+
+} // End TopicTableModel::setStatistics
+
+
+//------------------------------------------------------------------------------
+void TopicTableModel::refreshStatistics()
+{
+    if (!m_statistics || m_data.empty())
+    {
+        return;
+    }
+
+    // Nothing to repaint if no samples were added or reset since last time
+    const uint64_t lastCount = m_snapshot.count;
+    m_statistics->getSnapshot(m_snapshot);
+    if (m_snapshot.count == lastCount)
+    {
+        return;
+    }
+
+    emit dataChanged(index(0, MIN_COLUMN),
+                     index(static_cast<int>(m_data.size()) - 1, RATE_COLUMN));
+}
+
+
 //------------------------------------------------------------------------------
 void TopicTableModel::parseData(const std::shared_ptr<OpenDynamicData> data)
 {
@@ -306,122 +396,27 @@ void TopicTableModel::parseData(const std::shared_ptr<OpenDynamicData> data)
         }
 
 
+        const std::string fullName = child->getFullName();
         DataRow* dataRow = new DataRow;
         dataRow->type = child->getKind();
         dataRow->isOptional = false;
-        dataRow->name = child->getFullName().c_str();
+        dataRow->name = fullName.c_str();
+        dataRow->path = MemberPath(m_typeCode, fullName);
         dataRow->isKey = false; // TODO?
+        dataRow->value = readValue(*dataRow);
+        dataRow->statIndex = m_statistics ? m_statistics->indexOf(fullName) : -1;
 
 
         // Update the current editor delegate
         const int thisRow = static_cast<int>(m_data.size());
-        if (m_tableView->itemDelegateForRow(thisRow))
+        QAbstractItemDelegate* oldDelegate = m_tableView->itemDelegateForRow(thisRow);
+        if (dataRow->type == CORBA::tk_enum)
         {
-            delete m_tableView->itemDelegateForRow(thisRow);
-        }
-        m_tableView->setItemDelegateForRow(thisRow, new LineEditDelegate(this));
+            delete oldDelegate;
 
-
-        // Store the value into a QVariant
-        // The tmpValue may seem redundant, but it's very helpful for debug
-        switch (dataRow->type)
-        {
-        case CORBA::tk_long:
-        {
-            int32_t tmpValue = child->getValue<int32_t>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_short:
-        {
-            int16_t tmpValue = child->getValue<int16_t>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_ushort:
-        {
-            uint16_t tmpValue = child->getValue<uint16_t>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_ulong:
-        {
-            uint32_t tmpValue = child->getValue<uint32_t>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_float:
-        {
-            float tmpValue = child->getValue<float>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_double:
-        {
-            double tmpValue = child->getValue<double>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_boolean:
-        {
-            uint32_t tmpValue = child->getValue<uint32_t>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_char:
-        {
-            char tmpValue = child->getValue<char>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_wchar:
-        {
-            dataRow->value = ""; // FIXME?
-            break;
-        }
-        case CORBA::tk_octet:
-        {
-            uint8_t tmpValue = child->getValue<uint8_t>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_longlong:
-        {
-            qint64 tmpValue = child->getValue<qint64>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_ulonglong:
-        {
-            quint64 tmpValue = child->getValue<quint64>();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_string:
-        {
-            const char* tmpValue = child->getStringValue();
-            dataRow->value = tmpValue;
-            break;
-        }
-        case CORBA::tk_enum:
-        {
-            // Make sure the int value is valid
-            const CORBA::ULong enumValue = child->getValue<CORBA::ULong>();
+            // Install the new delegate
             const CORBA::TypeCode* enumTypeCode = child->getTypeCode();
             const CORBA::ULong enumMemberCount = enumTypeCode->member_count();
-            if (enumValue >= enumMemberCount)
-            {
-                dataRow->value = "INVALID";
-                break;
-            }
-
-            // Remove the old delegate
-            if (m_tableView->itemDelegateForRow(thisRow))
-            {
-                delete m_tableView->itemDelegateForRow(thisRow);
-            }
-
-            // Install the new delegate
             ComboDelegate *enumDelegate = new ComboDelegate(this);
             for (CORBA::ULong enumIndex = 0; enumIndex < enumMemberCount; enumIndex++)
             {
@@ -433,15 +428,13 @@ void TopicTableModel::parseData(const std::shared_ptr<OpenDynamicData> data)
             }
 
             m_tableView->setItemDelegateForRow(thisRow, enumDelegate);
-            dataRow->value = enumTypeCode->member_name(enumValue);
-
-            break;
-        } // End enum block
-        default:
-            dataRow->value = "NULL";
-            break;
-
-        } // End child type switch
+        }
+        else if (!dynamic_cast<LineEditDelegate*>(oldDelegate))
+        {
+            // A line editor from an earlier shape can be kept
+            delete oldDelegate;
+            m_tableView->setItemDelegateForRow(thisRow, new LineEditDelegate(this));
+        }
 
         m_data.push_back(dataRow);
 
@@ -450,6 +443,149 @@ void TopicTableModel::parseData(const std::shared_ptr<OpenDynamicData> data)
 } // End TopicTableModel::parseData
 
 
+//------------------------------------------------------------------------------
+void TopicTableModel::updateValues()
+{
+    const int rowCount = static_cast<int>(m_data.size());
+    int firstChanged = -1;
+
+    for (int row = 0; row <= rowCount; row++)
+    {
+        bool changed = false;
+        if (row < rowCount)
+        {
+            DataRow* dataRow = m_data.at(row);
+            QVariant newValue = readValue(*dataRow);
+            if (dataRow->edited || dataRow->value != newValue)
+            {
+                dataRow->value = newValue;
+                dataRow->edited = false;
+                changed = true;
+            }
+        }
+
+        // Report each run of changed rows with a single signal
+        if (changed && firstChanged < 0)
+        {
+            firstChanged = row;
+        }
+        else if (!changed && firstChanged >= 0)
+        {
+            emit dataChanged(index(firstChanged, VALUE_COLUMN),
+                             index(row - 1, VALUE_COLUMN));
+            firstChanged = -1;
+        }
+    }
+
+} // End TopicTableModel::updateValues
+
+
+//------------------------------------------------------------------------------
+QVariant TopicTableModel::readValue(const DataRow& dataRow) const
+{
+    const MemberPath& path = dataRow.path;
+
+    // Store the value into a QVariant
+    // The tmpValue may seem redundant, but it's very helpful for debug
+    switch (dataRow.type)
+    {
+    case CORBA::tk_long:
+    {
+        int32_t tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_short:
+    {
+        int16_t tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_ushort:
+    {
+        uint16_t tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_ulong:
+    {
+        uint32_t tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_float:
+    {
+        float tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_double:
+    {
+        double tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_boolean:
+    {
+        uint32_t tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_char:
+    {
+        char tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_wchar:
+    {
+        return ""; // FIXME?
+    }
+    case CORBA::tk_octet:
+    {
+        uint8_t tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_longlong:
+    {
+        qint64 tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_ulonglong:
+    {
+        quint64 tmpValue = 0;
+        m_sample->getValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_string:
+    {
+        const char* tmpValue = "";
+        m_sample->getStringValue(path, tmpValue);
+        return tmpValue;
+    }
+    case CORBA::tk_enum:
+    {
+        // Make sure the int value is valid
+        CORBA::ULong enumValue = 0;
+        m_sample->getValue(path, enumValue);
+        const CORBA::TypeCode* enumTypeCode = path.getTypeCode();
+        if (!enumTypeCode || enumValue >= enumTypeCode->member_count())
+        {
+            return "INVALID";
+        }
+
+        return enumTypeCode->member_name(enumValue);
+    }
+    default:
+        return "NULL";
+
+    } // End row type switch
+
+} // End TopicTableModel::readValue
+
+
 //------------------------------------------------------------------------------
 bool TopicTableModel::populateSample(std::shared_ptr<OpenDynamicData> const sample,
                                      DataRow* const dataInfo)
@@ -628,7 +764,8 @@ bool TopicTableModel::populateSample(std::shared_ptr<OpenDynamicData> const samp
 TopicTableModel::DataRow::DataRow() : type(CORBA::tk_null),
                                       isKey(false),
                                       isOptional(false),
-                                      edited(false)
+                                      edited(false),
+                                      statIndex(-1)
 {}
 
 
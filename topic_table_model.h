@@ -2,6 +2,8 @@
 #define DDS_DATA_SAMPLE_TABLE_MODEL_H
 
 #include "first_define.h"
+#include "field_statistics.h"
+#include "member_path.h"
 
 #include <tao/Typecode_typesC.h>
 
@@ -11,12 +13,23 @@
 #include <QTableView>
 
 #include <memory>
+#include <vector>
 
 class OpenDynamicData;
 
 
 /**
  * @brief Table model for DDS topic samples
+ *
+ * @details The rows only depend on the topic type and the sequence lengths of
+ *          the sample. While those stay the same, a new sample is applied by
+ *          reading each row through its resolved member path, and only the
+ *          rows whose values changed are reported with dataChanged(). The
+ *          rows and their editor delegates are only rebuilt when the shape
+ *          of the sample changes.
+ *
+ *          With FieldStatistics attached, the running statistics of each
+ *          numeric member are shown in extra columns.
  */
 class TopicTableModel : public QAbstractTableModel
 {
@@ -117,6 +130,18 @@ public:
      */
     void revertChanges();
 
+    /**
+     * @brief Show the running statistics of the topic in extra columns.
+     * @param[in] statistics The statistics to show or nullptr to hide the
+     *            columns.
+     */
+    void setStatistics(const std::shared_ptr<FieldStatistics>& statistics);
+
+    /**
+     * @brief Update the statistics columns with the latest statistics.
+     */
+    void refreshStatistics();
+
     /// Table column IDs for this data model
     enum eColumnIds
     {
@@ -124,6 +149,11 @@ public:
         NAME_COLUMN,
         TYPE_COLUMN,
         VALUE_COLUMN,
+        MIN_COLUMN,
+        MAX_COLUMN,
+        MEAN_COLUMN,
+        STDDEV_COLUMN,
+        RATE_COLUMN,
         MAX_eColumnIds_VALUE
     };
 
@@ -161,11 +191,13 @@ private:
         bool setValue(const QVariant& newValue);
 
         QString name; ///< The topic member name.
+        MemberPath path; ///< The resolved topic member path.
         QVariant value; ///< The topic member value.
         CORBA::TCKind type; ///< The topic member type.
         bool isKey; ///< The topic member key flag.
         bool isOptional; ///< The topic member is optional flag.
         bool edited; ///< The topic member edited flag.
+        int statIndex; ///< The statistics index or -1 for none.
     };
 
     /**
@@ -175,6 +207,20 @@ private:
      */
     void parseData(const std::shared_ptr<OpenDynamicData> data);
 
+    /**
+     * @brief Copy the values of the current sample into the existing rows.
+     * @remarks The sample must have the same shape as the rows. Rows that
+     *          changed are reported with dataChanged().
+     */
+    void updateValues();
+
+    /**
+     * @brief Read the value of a row from the current sample.
+     * @param[in] dataRow The row to read.
+     * @return The value for display in the table.
+     */
+    QVariant readValue(const DataRow& dataRow) const;
+
     /**
      * @brief Populate a DDS sample member.
      * @param[out] sample Populate this DDS sample.
@@ -199,6 +245,18 @@ private:
     /// The name of the topic for this data model
     QString m_topicName;
 
+    /// The type code the rows were built for.
+    const CORBA::TypeCode* m_typeCode;
+
+    /// The sequence lengths the rows were built for.
+    std::vector<size_t> m_shape;
+
+    /// The running statistics shown or nullptr if they're hidden.
+    std::shared_ptr<FieldStatistics> m_statistics;
+
+    /// The statistics shown in the statistics columns.
+    FieldStatistics::Snapshot m_snapshot;
+
 };
 
 #endif
@@ -0,0 +1,68 @@
+#include "waterfall_feed.h"
+#include "open_dynamic_data.h"
+#include "topic_history.h"
+
+#include <utility>
+
+
+//------------------------------------------------------------------------------
+WaterfallFeed::WaterfallFeed(const MemberPath& memberPath, const size_t capacity) :
+                             m_memberPath(memberPath),
+                             m_rows(capacity)
+{}
+
+
+//------------------------------------------------------------------------------
+const MemberPath& WaterfallFeed::memberPath() const
+{
+    return m_memberPath;
+}
+
+
+//------------------------------------------------------------------------------
+void WaterfallFeed::push(const SampleInfo& info, const OpenDynamicData& sample)
+{
+    WaterfallRow* row = m_rows.claim();
+    if (!row)
+    {
+        return;
+    }
+
+    // The row is only published once it's filled
+    if (!sample.getValues(m_memberPath, row->values))
+    {
+        return;
+    }
+
+    row->time = info.sourceTime > 0 ? info.sourceTime : info.receiveTime;
+    m_rows.publish();
+
+} // End WaterfallFeed::push
+
+
+//------------------------------------------------------------------------------
+bool WaterfallFeed::pop(WaterfallRow& row)
+{
+    WaterfallRow* buffered = m_rows.front();
+    if (!buffered)
+    {
+        return false;
+    }
+
+    row.time = buffered->time;
+    row.values.swap(buffered->values);
+    m_rows.release();
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t WaterfallFeed::droppedCount() const
+{
+    return m_rows.droppedCount();
+}
+
+
+/**
+ * @}
+ */
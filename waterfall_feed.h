@@ -0,0 +1,97 @@
+#ifndef __WATERFALL_FEED_H__
+#define __WATERFALL_FEED_H__
+
+#include "member_path.h"
+#include "spsc_ring.h"
+
+#include <cstdint>
+#include <vector>
+
+class OpenDynamicData;
+struct SampleInfo;
+
+
+/**
+ * @brief The elements of an array member from a single sample.
+ */
+struct WaterfallRow
+{
+    /// The source timestamp in nanoseconds since the epoch, or the receive
+    /// timestamp if the sample has no source timestamp.
+    int64_t time;
+
+    /// The element values.
+    std::vector<float> values;
+};
+
+
+/**
+ * @brief Hands the array member of every stored sample to a waterfall view.
+ *
+ * @details A single producer, single consumer ring of rows, like PlotFeed.
+ *          TopicHistory converts the array member of each stored sample
+ *          straight from the decoded storage into the next free row under
+ *          its feed lock. The view swaps the rows out on its refresh tick,
+ *          so the row buffers are reused instead of reallocated. If the view
+ *          falls a full ring behind, the newest rows are dropped and counted.
+ */
+class WaterfallFeed
+{
+public:
+
+    /**
+     * @brief Constructor for the waterfall feed.
+     * @param[in] memberPath The array or sequence member, resolved for the
+     *            topic type.
+     * @param[in] capacity The number of rows buffered. Rounded up to a power
+     *            of two.
+     */
+    WaterfallFeed(const MemberPath& memberPath, const size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Get the array member.
+     * @return The resolved member path.
+     */
+    const MemberPath& memberPath() const;
+
+    /**
+     * @brief Read the array member of a stored sample and buffer it.
+     * @remarks Producer side. Called by TopicHistory with its feed lock held.
+     * @param[in] info The bookkeeping of the stored sample.
+     * @param[in] sample The stored sample.
+     */
+    void push(const SampleInfo& info, const OpenDynamicData& sample);
+
+    /**
+     * @brief Take the oldest buffered row.
+     * @remarks Consumer side. Only called from the GUI thread. The buffer of
+     *          the passed in row is handed back to the ring for reuse.
+     * @param[in,out] row Swapped with the oldest buffered row.
+     * @return False if no row is buffered.
+     */
+    bool pop(WaterfallRow& row);
+
+    /**
+     * @brief Get the number of rows dropped because the ring was full.
+     * @return The dropped row count.
+     */
+    uint64_t droppedCount() const;
+
+    /// The default number of rows buffered.
+    static const size_t DEFAULT_CAPACITY = 256;
+
+private:
+
+    /// The array member.
+    const MemberPath m_memberPath;
+
+    /// The ring of rows.
+    SpscRing<WaterfallRow> m_rows;
+
+}; // End class WaterfallFeed
+
+#endif
+
+/**
+ * @}
+ */
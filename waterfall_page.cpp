@@ -0,0 +1,309 @@
+#include "waterfall_page.h"
+#include "dds_data.h"
+#include "open_dynamic_data.h"
+#include "topic_history.h"
+
+#include <QColor>
+#include <QDateTime>
+#include <QPainter>
+#include <QRectF>
+
+#include <algorithm>
+#include <limits>
+
+
+//------------------------------------------------------------------------------
+static std::vector<QRgb> buildPalette()
+{
+    // Black through blue, cyan and yellow to red
+    static const int stops[][3] = {
+        { 0, 0, 0 }, { 0, 0, 255 }, { 0, 255, 255 }, { 255, 255, 0 }, { 255, 0, 0 } };
+    const int segments = 4;
+
+    std::vector<QRgb> palette(256);
+    for (int i = 0; i < 256; i++)
+    {
+        const double position = i * segments / 255.0;
+        const int stop = std::min(static_cast<int>(position), segments - 1);
+        const double fraction = position - stop;
+        const int* from = stops[stop];
+        const int* to = stops[stop + 1];
+        palette[i] = qRgb(qRound(from[0] + (to[0] - from[0]) * fraction),
+                          qRound(from[1] + (to[1] - from[1]) * fraction),
+                          qRound(from[2] + (to[2] - from[2]) * fraction));
+    }
+
+    return palette;
+}
+
+
+//------------------------------------------------------------------------------
+WaterfallPage::WaterfallPage(const QString& topicName,
+                             const QString& variableName,
+                             QWidget* parent) :
+    QWidget(parent),
+    m_topicName(topicName),
+    m_variableName(variableName),
+    m_palette(buildPalette()),
+    m_top(0),
+    m_rowCount(0),
+    m_low(std::numeric_limits<float>::infinity()),
+    m_high(-std::numeric_limits<float>::infinity()),
+    m_newestTime(0),
+    m_refreshTimer(this)
+{
+    setMinimumSize(200, 150);
+    setToolTip("Newest samples on top. Double click to reset the color range.");
+
+    m_memberPath = CommonData::resolveMember(topicName, variableName);
+    m_history = CommonData::getHistory(topicName);
+    if (m_history && isNumericArray(m_memberPath))
+    {
+        m_feed = std::make_shared<WaterfallFeed>(m_memberPath);
+        m_history->addWaterfallFeed(m_feed);
+    }
+
+    connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+    m_refreshTimer.start(REFRESH_INTERVAL);
+
+} // End WaterfallPage::WaterfallPage
+
+
+//------------------------------------------------------------------------------
+WaterfallPage::~WaterfallPage()
+{
+    m_refreshTimer.stop();
+
+    // Stop the producer before the feed goes away
+    if (m_history && m_feed)
+    {
+        m_history->removeWaterfallFeed(m_feed);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool WaterfallPage::isNumericArray(const MemberPath& path)
+{
+    const SampleLayout::Node* node = path.getNode();
+    return node &&
+           (node->kind == CORBA::tk_array || node->kind == CORBA::tk_sequence) &&
+           !node->members.empty() &&
+           OpenDynamicData::isPrimitiveKind(node->members[0].kind);
+}
+
+
+//------------------------------------------------------------------------------
+void WaterfallPage::paintEvent(QPaintEvent*)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(m_palette[0]));
+    painter.setPen(Qt::white);
+
+    if (m_rowCount == 0)
+    {
+        painter.drawText(rect(), Qt::AlignCenter, m_feed ?
+            "Waiting for " + m_variableName :
+            m_variableName + " is not an array of numbers");
+        return;
+    }
+
+    // The lines from the newest row to the image bottom come first, then the
+    // lines wrapped around to the image top
+    const double rowHeight = static_cast<double>(height()) / ROWS;
+    const int firstRows = std::min(m_rowCount, ROWS - m_top);
+    painter.drawImage(QRectF(0.0, 0.0, width(), firstRows * rowHeight),
+                      m_image,
+                      QRectF(0.0, m_top, m_image.width(), firstRows));
+    if (m_rowCount > firstRows)
+    {
+        const int wrappedRows = m_rowCount - firstRows;
+        painter.drawImage(QRectF(0.0, firstRows * rowHeight, width(), wrappedRows * rowHeight),
+                          m_image,
+                          QRectF(0.0, 0.0, m_image.width(), wrappedRows));
+    }
+
+    // Label the member, the color range and the time of the newest row
+    QString text = m_variableName +
+        "  [" + QString::number(m_low) + ", " + QString::number(m_high) + "]  " +
+        QDateTime::fromMSecsSinceEpoch(m_newestTime / 1000000).toString("hh:mm:ss.zzz");
+    const uint64_t dropped = m_feed ? m_feed->droppedCount() : 0;
+    if (dropped > 0)
+    {
+        text += "  " + QString::number(dropped) + " dropped";
+    }
+
+    const QRect textRect = painter.fontMetrics().boundingRect(text).adjusted(-4, -2, 4, 2);
+    painter.fillRect(textRect.translated(4 - textRect.left(), 4 - textRect.top()),
+                     QColor(0, 0, 0, 160));
+    painter.drawText(rect().adjusted(8, 6, -8, -6), Qt::AlignTop | Qt::AlignLeft, text);
+
+} // End WaterfallPage::paintEvent
+
+
+//------------------------------------------------------------------------------
+void WaterfallPage::mouseDoubleClickEvent(QMouseEvent*)
+{
+    // The next row sets the image width again, in case the length changed
+    m_image = QImage();
+    m_top = 0;
+    m_rowCount = 0;
+    m_low = std::numeric_limits<float>::infinity();
+    m_high = -std::numeric_limits<float>::infinity();
+    update();
+}
+
+
+//------------------------------------------------------------------------------
+void WaterfallPage::refresh()
+{
+    if (!m_feed)
+    {
+        return;
+    }
+
+    // Keep the topic off the front of the eviction order while it's shown
+    m_history->touch();
+
+    bool added = false;
+    bool widened = false;
+    while (m_feed->pop(m_row))
+    {
+        widened = appendRow(m_row.values) || widened;
+        m_newestTime = m_row.time;
+        added = true;
+    }
+
+    // The stored rows were colored for the old range
+    if (widened)
+    {
+        for (int i = 0; i < m_rowCount; i++)
+        {
+            encodeLine((m_top + i) % ROWS);
+        }
+    }
+
+    if (added)
+    {
+        update();
+    }
+
+} // End WaterfallPage::refresh
+
+
+//------------------------------------------------------------------------------
+bool WaterfallPage::appendRow(const std::vector<float>& values)
+{
+    const int length = static_cast<int>(values.size());
+
+    // The first row with elements sets the image width
+    if (m_image.isNull())
+    {
+        if (length == 0)
+        {
+            return false;
+        }
+
+        const int imageWidth = std::min(length, MAX_WIDTH);
+        m_image = QImage(imageWidth, ROWS, QImage::Format_RGB32);
+        m_image.fill(m_palette[0]);
+        m_values.assign(static_cast<size_t>(imageWidth) * ROWS, 0.0f);
+        m_indexes.resize(imageWidth);
+    }
+
+    const int imageWidth = m_image.width();
+    m_top = (m_top + ROWS - 1) % ROWS;
+    m_rowCount = std::min(m_rowCount + 1, ROWS);
+    float* line = &m_values[static_cast<size_t>(m_top) * imageWidth];
+
+    if (length == imageWidth)
+    {
+        std::copy(values.begin(), values.end(), line);
+    }
+    else if (length == 0)
+    {
+        std::fill(line, line + imageWidth, std::numeric_limits<float>::quiet_NaN());
+    }
+    else
+    {
+        // Each column shows the highest of its elements, or the nearest
+        // element if there are fewer elements than columns
+        for (int column = 0; column < imageWidth; column++)
+        {
+            const int begin = static_cast<int>(static_cast<int64_t>(column) * length / imageWidth);
+            const int end = std::max(begin + 1,
+                static_cast<int>(static_cast<int64_t>(column + 1) * length / imageWidth));
+
+            float highest = values[begin];
+            for (int i = begin + 1; i < end; i++)
+            {
+                highest = values[i] > highest ? values[i] : highest;
+            }
+            line[column] = highest;
+        }
+    }
+
+    // NaN fails both comparisons, so it never moves the range
+    float low = std::numeric_limits<float>::infinity();
+    float high = -std::numeric_limits<float>::infinity();
+    for (int i = 0; i < imageWidth; i++)
+    {
+        low = line[i] < low ? line[i] : low;
+        high = line[i] > high ? line[i] : high;
+    }
+
+    if (low > high || (low >= m_low && high <= m_high))
+    {
+        encodeLine(m_top);
+        return false;
+    }
+
+    // Leave some headroom, so a slowly growing signal doesn't recolor all
+    // rows on every sample
+    if (m_low > m_high)
+    {
+        m_low = low;
+        m_high = high;
+    }
+    else
+    {
+        const float headroom = (std::max(high, m_high) - std::min(low, m_low)) / 8.0f;
+        m_low = low < m_low ? low - headroom : m_low;
+        m_high = high > m_high ? high + headroom : m_high;
+    }
+
+    return true;
+
+} // End WaterfallPage::appendRow
+
+
+//------------------------------------------------------------------------------
+void WaterfallPage::encodeLine(const int line)
+{
+    const int imageWidth = m_image.width();
+    const float* values = &m_values[static_cast<size_t>(line) * imageWidth];
+    const float scale = m_high > m_low ? 255.0f / (m_high - m_low) : 0.0f;
+    const float low = m_low;
+    uint8_t* indexes = m_indexes.data();
+
+    // The clamp is branch free, so the compiler can vectorize the loop.
+    // NaN fails both comparisons and gets the lowest color.
+    for (int i = 0; i < imageWidth; i++)
+    {
+        float index = (values[i] - low) * scale;
+        index = index > 0.0f ? index : 0.0f;
+        index = index < 255.0f ? index : 255.0f;
+        indexes[i] = static_cast<uint8_t>(index);
+    }
+
+    QRgb* pixels = reinterpret_cast<QRgb*>(m_image.scanLine(line));
+    for (int i = 0; i < imageWidth; i++)
+    {
+        pixels[i] = m_palette[indexes[i]];
+    }
+}
+
+
+/**
+ * @}
+ */
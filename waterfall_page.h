@@ -0,0 +1,166 @@
+#ifndef __WATERFALL_PAGE_H__
+#define __WATERFALL_PAGE_H__
+
+#include "first_define.h"
+#include "member_path.h"
+#include "waterfall_feed.h"
+
+#include <QImage>
+#include <QRgb>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class QMouseEvent;
+class QPaintEvent;
+class TopicHistory;
+
+
+/**
+ * @brief Shows an array member of a topic as a scrolling intensity raster.
+ *
+ * @details Each sample adds one row, with one column per array element and
+ *          the newest row on top. The rows are kept in a circular buffer of
+ *          raw values and a matching RGB image, so adding a row only touches
+ *          one image line and the image is drawn in two parts without being
+ *          moved. Arrays wider than the image are reduced to the maximum of
+ *          each column, so narrow peaks stay visible.
+ *
+ *          The color range grows with the values seen. When it does, the
+ *          stored rows are colored again from their raw values. A double
+ *          click clears the rows and the range.
+ */
+class WaterfallPage : public QWidget
+{
+    Q_OBJECT;
+
+public:
+
+    /**
+     * @brief Constructor for WaterfallPage.
+     * @param[in] topicName The DDS topic name.
+     * @param[in] variableName The full name of the array or sequence member.
+     * @param[in] parent The parent of this Qt object.
+     */
+    WaterfallPage(const QString& topicName,
+                  const QString& variableName,
+                  QWidget* parent = 0);
+
+    /**
+     * @brief Destructor for WaterfallPage.
+     */
+    ~WaterfallPage();
+
+    /**
+     * @brief Get whether a member can be shown as a waterfall.
+     * @param[in] path The resolved member path.
+     * @return True if the member is an array or sequence of numbers.
+     */
+    static bool isNumericArray(const MemberPath& path);
+
+protected:
+
+    /**
+     * @brief Draw the rows, newest on top.
+     * @remarks Reimplemented from QWidget.
+     * @param[in] event The paint event.
+     */
+    void paintEvent(QPaintEvent* event) override;
+
+    /**
+     * @brief Clear the rows and the color range.
+     * @remarks Reimplemented from QWidget.
+     * @param[in] event The mouse event.
+     */
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+
+private slots:
+
+    /**
+     * @brief Add the rows buffered since the last tick and redraw.
+     */
+    void refresh();
+
+private:
+
+    /**
+     * @brief Store a row of values as the newest row.
+     * @param[in] values The array elements of one sample.
+     * @return True if the row widened the color range.
+     */
+    bool appendRow(const std::vector<float>& values);
+
+    /**
+     * @brief Color an image line from its stored values.
+     * @param[in] line The image line.
+     */
+    void encodeLine(const int line);
+
+    /// The number of rows shown.
+    static const int ROWS = 512;
+
+    /// The maximum number of image columns.
+    static const int MAX_WIDTH = 4096;
+
+    /// The refresh interval in ms.
+    static const int REFRESH_INTERVAL = 50;
+
+    /// The DDS topic name.
+    QString m_topicName;
+
+    /// The full name of the array member.
+    QString m_variableName;
+
+    /// The resolved path of the array member.
+    MemberPath m_memberPath;
+
+    /// The sample history of the topic.
+    std::shared_ptr<TopicHistory> m_history;
+
+    /// Receives the array member of every stored sample.
+    std::shared_ptr<WaterfallFeed> m_feed;
+
+    /// The row taken from the feed, reused across ticks.
+    WaterfallRow m_row;
+
+    /// The raw values of each image line.
+    std::vector<float> m_values;
+
+    /// The palette index of each column of the line being colored.
+    std::vector<uint8_t> m_indexes;
+
+    /// The colored rows.
+    QImage m_image;
+
+    /// The colors from the lowest to the highest value.
+    std::vector<QRgb> m_palette;
+
+    /// The image line of the newest row.
+    int m_top;
+
+    /// The number of rows stored.
+    int m_rowCount;
+
+    /// The value shown in the lowest color.
+    float m_low;
+
+    /// The value shown in the highest color.
+    float m_high;
+
+    /// The timestamp of the newest row in nanoseconds since the epoch.
+    int64_t m_newestTime;
+
+    /// Adds the buffered rows when this timer expires.
+    QTimer m_refreshTimer;
+
+}; // End WaterfallPage
+
+#endif
+
+/**
+ * @}
+ */